@@ -13,8 +13,8 @@ layout(location = 2) out vec2 outUV;
 layout(location = 3) out vec3 outColor;
 layout(location = 4) out vec4 outTangent;
 
-layout (set = 0, binding = 1) uniform modelMatUB{
-    mat4 modelMats[100];
+layout (set = 0, binding = 1) readonly buffer modelMatSB{
+    mat4 modelMats[];
 };
 
 struct Camera{
@@ -0,0 +1,41 @@
+#include "bench.h"
+#include "common/assetManager.h"
+#include "scene/scene.h"
+
+namespace
+{
+using namespace aph::bench;
+}  // namespace
+
+APH_BENCHMARK(Asset_LoadImage)
+{
+    const std::pair<const char*, std::filesystem::path> images[] = {
+        { "container.jpg (jpg, rgb)", aph::AssetManager::GetTextureDir() / "container.jpg" },
+        { "container2.png (png, rgba)", aph::AssetManager::GetTextureDir() / "container2.png" },
+        { "FlightHelmet_baseColor.png (2k)",
+          aph::AssetManager::GetModelDir() / "FlightHelmet/glTF/FlightHelmet_baseColor.png" },
+    };
+    for(const auto& [name, path] : images)
+    {
+        std::string pathString = path.string();
+        measure(name, 1, [&]() { doNotOptimize(aph::utils::loadImageFromFile(pathString)); });
+    }
+}
+
+// Parsing, vertex and index conversion and texture decoding of a whole model, into a fresh scene every time.
+APH_BENCHMARK(Asset_ImportGltf)
+{
+    const std::pair<const char*, std::filesystem::path> models[] = {
+        { "DamagedHelmet", aph::AssetManager::GetModelDir() / "DamagedHelmet.glb" },
+        { "FlightHelmet", aph::AssetManager::GetModelDir() / "FlightHelmet/glTF/FlightHelmet.gltf" },
+        { "Sponza", aph::AssetManager::GetModelDir() / "Sponza/glTF/Sponza.gltf" },
+    };
+    for(const auto& [name, path] : models)
+    {
+        std::string pathString = path.string();
+        measure(name, 1, [&]() {
+            auto scene = aph::Scene::Create(aph::SceneType::DEFAULT);
+            doNotOptimize(scene->createMeshesFromFile(pathString));
+        });
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include "common/common.h"
+
+namespace aph::bench
+{
+using BenchmarkFunc = void (*)();
+
+struct Benchmark
+{
+    const char*   name = {};
+    BenchmarkFunc func = {};
+};
+
+std::vector<Benchmark>& getRegistry();
+
+struct Registrar
+{
+    Registrar(const char* name, BenchmarkFunc func) { getRegistry().push_back({ name, func }); }
+};
+
+using Clock = std::chrono::steady_clock;
+
+inline double elapsedSeconds(Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration<double>(end - start).count();
+}
+
+// p in [0, 1], sorts the samples in place.
+inline double percentile(std::vector<double>& samples, double p)
+{
+    if(samples.empty())
+        return 0.0;
+    auto idx = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + idx, samples.end());
+    return samples[idx];
+}
+
+inline double median(std::vector<double> samples)
+{
+    if(samples.empty())
+        return 0.0;
+    std::sort(samples.begin(), samples.end());
+    size_t half = samples.size() / 2;
+    return samples.size() % 2 ? samples[half] : (samples[half - 1] + samples[half]) * 0.5;
+}
+
+// Applies to every measure() call, set from the command line.
+struct Settings
+{
+    uint32_t warmup      = 2;
+    uint32_t repetitions = 15;
+};
+
+Settings& getSettings();
+
+// Nanoseconds per item over the repetitions of one measure() call.
+struct Measurement
+{
+    std::string benchmark   = {};
+    std::string name        = {};
+    uint64_t    items       = {};
+    uint32_t    repetitions = {};
+    double      medianNs    = {};
+    // Median absolute deviation from the median, robust against the odd preempted repetition.
+    double      madNs       = {};
+    double      minNs       = {};
+};
+
+std::vector<Measurement>& getMeasurements();
+
+// Runs func, which processes items items per call, for the warmup and then the timed repetitions. Prints and records
+// the per-item median and MAD. Anything func should not be charged for has to be set up outside of it.
+template <typename F>
+Measurement measure(std::string name, uint64_t items, F&& func)
+{
+    const Settings& settings = getSettings();
+    for(uint32_t i = 0; i < settings.warmup; ++i)
+        func();
+
+    std::vector<double> samples(std::max(settings.repetitions, 1U));
+    for(double& sample : samples)
+    {
+        auto start = Clock::now();
+        func();
+        sample = elapsedSeconds(start, Clock::now()) * 1e9 / static_cast<double>(items);
+    }
+
+    Measurement measurement{
+        .name        = std::move(name),
+        .items       = items,
+        .repetitions = static_cast<uint32_t>(samples.size()),
+        .medianNs    = median(samples),
+        .minNs       = *std::min_element(samples.begin(), samples.end()),
+    };
+    for(double& sample : samples)
+        sample = std::abs(sample - measurement.medianNs);
+    measurement.madNs = median(samples);
+
+    std::printf("  %-36s %12.2f ns/item  MAD %10.2f (%5.1f%%)  min %12.2f\n", measurement.name.c_str(),
+                measurement.medianNs, measurement.madNs, 100.0 * measurement.madNs / measurement.medianNs,
+                measurement.minNs);
+    getMeasurements().push_back(measurement);
+    return measurement;
+}
+
+// Keeps the compiler from dropping a computation whose result is otherwise unused.
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+}  // namespace aph::bench
+
+#define APH_BENCHMARK(NAME) \
+    static void                    NAME(); \
+    static aph::bench::Registrar NAME##_registrar(#NAME, NAME); \
+    static void                    NAME()
+
+#endif  // BENCH_H_
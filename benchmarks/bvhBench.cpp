@@ -0,0 +1,102 @@
+#include "bench.h"
+#include "scene/bvh.h"
+
+#include <random>
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t PROXY_COUNT = 100000;
+
+// Small boxes spread over a 1 km cube, a large open scene.
+std::vector<aph::AABB> createBoxes(uint32_t count)
+{
+    std::mt19937                          rng(42);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.5f, 5.0f);
+    std::vector<aph::AABB>                boxes(count);
+    for(auto& box : boxes)
+    {
+        glm::vec3 center{ position(rng), position(rng), position(rng) };
+        glm::vec3 extent{ size(rng), size(rng), size(rng) };
+        box = { center - extent, center + extent };
+    }
+    return boxes;
+}
+}  // namespace
+
+APH_BENCHMARK(BVH_Build)
+{
+    auto     boxes = createBoxes(PROXY_COUNT);
+    aph::BVH bvh;
+    for(const auto& box : boxes)
+    {
+        bvh.createProxy(box, nullptr);
+    }
+    measure("rebuild, 100k proxies", PROXY_COUNT, [&]() { bvh.rebuild(); });
+    std::printf("  SAH cost after build %.2f\n", bvh.getCost());
+}
+
+APH_BENCHMARK(BVH_Refit)
+{
+    auto                           boxes = createBoxes(PROXY_COUNT);
+    aph::BVH                       bvh;
+    std::vector<aph::BVH::ProxyId> proxies;
+    for(const auto& box : boxes)
+    {
+        proxies.push_back(bvh.createProxy(box, nullptr));
+    }
+    bvh.rebuild();
+
+    // A small share of the scene animating every frame, back and forth so the tree does not degrade over the run.
+    constexpr uint32_t MOVED = PROXY_COUNT / 100;
+    float              sign  = 1.0f;
+    measure("1% moved, 100k proxies", MOVED, [&]() {
+        sign = -sign;
+        for(uint32_t i = 0; i < PROXY_COUNT; i += PROXY_COUNT / MOVED)
+        {
+            boxes[i] = { boxes[i].min + glm::vec3(sign), boxes[i].max + glm::vec3(sign) };
+            bvh.moveProxy(proxies[i], boxes[i]);
+        }
+        bvh.refit();
+    });
+}
+
+APH_BENCHMARK(BVH_Query)
+{
+    auto     boxes = createBoxes(PROXY_COUNT);
+    aph::BVH bvh;
+    for(const auto& box : boxes)
+    {
+        bvh.createProxy(box, nullptr);
+    }
+    bvh.rebuild();
+
+    // A camera in the middle of the scene with a 200 m far plane.
+    glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f) *
+                         glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    aph::Frustum frustum = aph::Frustum::FromMatrix(viewProj);
+
+    measure("frustum, brute force", PROXY_COUNT, [&]() {
+        uint32_t visible = 0;
+        for(const auto& box : boxes)
+            visible += frustum.test(box) != aph::Containment::OUTSIDE;
+        doNotOptimize(visible);
+    });
+    measure("frustum, bvh", PROXY_COUNT, [&]() {
+        uint32_t visible = 0;
+        bvh.queryFrustum(frustum, [&](aph::Object*) { ++visible; });
+        doNotOptimize(visible);
+    });
+
+    aph::Ray ray{ glm::vec3(-600.0f, 1.0f, 2.0f), glm::normalize(glm::vec3(1.0f, 0.01f, 0.02f)) };
+    measure("closest ray hit, bvh", 1, [&]() {
+        float closest = -1.0f;
+        bvh.raycast(ray, 2000.0f, [&](aph::Object*, float distance) {
+            closest = distance;
+            return distance;
+        });
+        doNotOptimize(closest);
+    });
+}
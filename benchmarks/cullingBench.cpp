@@ -0,0 +1,107 @@
+#include "bench.h"
+#include "scene/culling.h"
+#include "scene/occlusion.h"
+
+#include <random>
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t BOX_COUNT = 100000;
+}  // namespace
+
+// Subset bounds of a large scene against a camera standing inside it, one box at a time against the SIMD batches.
+APH_BENCHMARK(Culling_Frustum)
+{
+    std::mt19937                          rng(42);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.5f, 5.0f);
+    std::vector<aph::AABB>                boxes(BOX_COUNT);
+    aph::FrustumCuller                    culler;
+    for(auto& box : boxes)
+    {
+        glm::vec3 center{ position(rng), position(rng), position(rng) };
+        glm::vec3 extent{ size(rng), size(rng), size(rng) };
+        box = { center - extent, center + extent };
+        culler.add(box);
+    }
+
+    glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f) *
+                         glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    aph::Frustum frustum = aph::Frustum::FromMatrix(viewProj);
+
+    measure("scalar, 100k boxes", BOX_COUNT, [&]() {
+        std::vector<uint32_t> visible;
+        for(uint32_t idx = 0; idx < BOX_COUNT; ++idx)
+        {
+            if(frustum.test(boxes[idx]) != aph::Containment::OUTSIDE)
+                visible.push_back(idx);
+        }
+        doNotOptimize(visible.data());
+    });
+    measure("simd batches, 100k boxes", BOX_COUNT, [&]() { doNotOptimize(culler.cull(frustum).data()); });
+    std::printf("  %zu of %u boxes visible\n", culler.getVisible().size(), BOX_COUNT);
+}
+
+// Rows of wall segments in front of a camera, an interior where most of the scene is hidden, and boxes scattered
+// behind and between them.
+APH_BENCHMARK(Culling_Occlusion)
+{
+    constexpr uint32_t WALL_ROWS = 8, WALLS_PER_ROW = 8;
+    aph::OcclusionCuller culler;
+    for(uint32_t row = 0; row < WALL_ROWS; ++row)
+    {
+        for(uint32_t wall = 0; wall < WALLS_PER_ROW; ++wall)
+        {
+            // A subdivided quad, 32 triangles.
+            std::vector<glm::vec3> positions;
+            std::vector<uint32_t>  indices;
+            for(uint32_t y = 0; y <= 4; ++y)
+            {
+                for(uint32_t x = 0; x <= 4; ++x)
+                {
+                    positions.push_back({ x * 2.5f, y * 2.5f, 0.0f });
+                    if(x < 4 && y < 4)
+                    {
+                        uint32_t corner = y * 5 + x;
+                        for(uint32_t offset : { 0, 1, 6, 0, 6, 5 })
+                            indices.push_back(corner + offset);
+                    }
+                }
+            }
+            uint32_t occluder = culler.addOccluder(std::move(positions), std::move(indices));
+            glm::vec3 offset{ (wall - WALLS_PER_ROW / 2.0f) * 11.0f + row * 3.0f, -5.0f, -10.0f - row * 20.0f };
+            culler.setOccluderTransform(occluder, glm::translate(glm::mat4(1.0f), offset));
+        }
+    }
+
+    std::mt19937                          rng(42);
+    std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> depth(-200.0f, -5.0f);
+    std::vector<aph::AABB>                boxes(BOX_COUNT / 10);
+    for(auto& box : boxes)
+    {
+        glm::vec3 center{ position(rng), position(rng) * 0.1f, depth(rng) };
+        box = { center - glm::vec3(1.0f), center + glm::vec3(1.0f) };
+    }
+
+    glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f) *
+                         glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    measure("rasterize 64 occluders, 256x128", 1, [&]() { culler.render(viewProj); });
+    culler.setResolution(512, 256);
+    measure("rasterize 64 occluders, 512x256", 1, [&]() { culler.render(viewProj); });
+    culler.setResolution(aph::OcclusionCuller::DEFAULT_WIDTH, aph::OcclusionCuller::DEFAULT_HEIGHT);
+    culler.render(viewProj);
+
+    uint32_t hidden = 0;
+    measure("test boxes against the pyramid", boxes.size(), [&]() {
+        hidden = 0;
+        for(const auto& box : boxes)
+            hidden += !culler.isVisible(box);
+        doNotOptimize(hidden);
+    });
+    std::printf("  %u of %zu boxes hidden, %u triangles rasterized\n", hidden, boxes.size(),
+                culler.getRasterizedTriangleCount());
+}
@@ -0,0 +1,47 @@
+#include "bench.h"
+#include "common/frameAllocator.h"
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t FRAME_COUNT      = 1000;
+constexpr uint32_t LISTS_PER_FRAME  = 256;
+constexpr uint32_t ENTRIES_PER_LIST = 8;
+constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+
+// Short lists built and thrown away every frame, like the descriptor writes and submit infos of a render loop.
+template <typename FBegin, typename FMake>
+double runFrames(FBegin&& beginFrame, FMake&& makeList)
+{
+    uint64_t sum   = 0;
+    auto     start = Clock::now();
+    for(uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+    {
+        beginFrame(frame % FRAMES_IN_FLIGHT);
+        for(uint32_t list = 0; list < LISTS_PER_FRAME; ++list)
+        {
+            auto entries = makeList();
+            for(uint32_t i = 0; i < ENTRIES_PER_LIST; ++i)
+                entries.push_back(list + i);
+            sum += entries.back();
+        }
+    }
+    double seconds = elapsedSeconds(start, Clock::now());
+    if(sum == 1)
+        std::printf(" ");
+    return seconds * 1e9 / (FRAME_COUNT * LISTS_PER_FRAME);
+}
+}  // namespace
+
+APH_BENCHMARK(FrameAllocator_TransientLists)
+{
+    double heap = runFrames([](uint32_t) {}, []() { return std::vector<uint64_t>(); });
+    std::printf("%-16s %8.1f ns/list\n", "std::vector", heap);
+
+    aph::FrameAllocator allocator(FRAMES_IN_FLIGHT);
+    double              arena = runFrames([&](uint32_t frameIdx) { allocator.beginFrame(frameIdx); },
+                                          [&]() { return std::pmr::vector<uint64_t>(allocator.getResource()); });
+    std::printf("%-16s %8.1f ns/list   peak frame %zu bytes, %llu blocks allocated\n", "FrameAllocator", arena,
+                allocator.getPeakFrameSize(), static_cast<unsigned long long>(allocator.getBlockAllocationCount()));
+}
@@ -0,0 +1,106 @@
+#ifndef BENCH_LEGACY_H_
+#define BENCH_LEGACY_H_
+
+#include "common/common.h"
+
+namespace legacy
+{
+// The mutex/condvar queue and pool the engine shipped before the lock-free rewrites, kept as comparison baselines.
+template <typename T>
+class ThreadSafeQueue
+{
+public:
+    bool Empty()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queue.empty();
+    }
+
+    void Invalidate()
+    {
+        m_valid = false;
+        m_condition.notify_all();
+    }
+
+    void Push(T&& item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queue.push(std::move(item));
+        lock.unlock();
+        m_condition.notify_one();
+    }
+
+    bool Pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this](void) { return !m_queue.empty() || !m_valid; });
+        if(!m_valid)
+            return false;
+        item = std::move(m_queue.front());
+        m_queue.pop();
+        return true;
+    }
+
+private:
+    std::atomic_bool        m_valid{ true };
+    std::queue<T>           m_queue;
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+};
+
+class ThreadPool
+{
+public:
+    ThreadPool(uint32_t threadCount)
+    {
+        for(auto i = 0U; i < threadCount; ++i)
+        {
+            m_threads.emplace([this]() {
+                while(true)
+                {
+                    std::packaged_task<void()> packagedTask;
+                    if(!m_tasks.Pop(packagedTask))
+                        break;
+                    ++m_activeThreads;
+                    packagedTask();
+                    --m_activeThreads;
+                    m_threadsCompleteCondition.notify_all();
+                }
+            });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        m_tasks.Invalidate();
+        while(!m_threads.empty())
+        {
+            m_threads.top().join();
+            m_threads.pop();
+        }
+    }
+
+    std::shared_future<void> AddTask(std::function<void()>&& task)
+    {
+        std::packaged_task<void()> packagedTask(std::move(task));
+        auto                       future = packagedTask.get_future();
+        m_tasks.Push(std::move(packagedTask));
+        return future.share();
+    }
+
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(m_threadsCompleteMutex);
+        m_threadsCompleteCondition.wait(lock, [this]() { return !m_activeThreads && m_tasks.Empty(); });
+    }
+
+private:
+    std::stack<std::thread>                     m_threads;
+    ThreadSafeQueue<std::packaged_task<void()>> m_tasks;
+    std::atomic<uint32_t>                       m_activeThreads{ 0U };
+    std::mutex                                  m_threadsCompleteMutex;
+    std::condition_variable                     m_threadsCompleteCondition;
+};
+}  // namespace legacy
+
+#endif  // BENCH_LEGACY_H_
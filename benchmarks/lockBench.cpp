@@ -0,0 +1,151 @@
+#include "bench.h"
+#include "common/spinlock.h"
+
+#include <shared_mutex>
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t OPS_PER_THREAD = 200000;
+
+// Adapts std::mutex and std::shared_mutex to the engine lock interface.
+struct StdMutex
+{
+    void       Lock() { mutex.lock(); }
+    void       Unlock() { mutex.unlock(); }
+    std::mutex mutex;
+};
+
+struct StdSharedMutex
+{
+    void              Lock() { mutex.lock(); }
+    void              Unlock() { mutex.unlock(); }
+    void              LockShared() { mutex.lock_shared(); }
+    void              UnlockShared() { mutex.unlock_shared(); }
+    std::shared_mutex mutex;
+};
+
+// A few dozen cycles of work under the lock, about what the Vulkan pool bookkeeping costs.
+inline void criticalSection(uint64_t* pData)
+{
+    for(uint32_t i = 0; i < 8; ++i)
+        pData[i] = pData[i] * 31 + i;
+}
+
+template <typename F>
+double runThreads(uint32_t threadCount, F&& func)
+{
+    std::atomic_bool         go{ false };
+    std::vector<std::thread> threads;
+    for(uint32_t t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            while(!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            func(t);
+        });
+    }
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for(auto& thread : threads)
+        thread.join();
+    return elapsedSeconds(start, Clock::now());
+}
+
+template <typename TLock>
+void benchExclusive(const char* name, uint32_t threadCount)
+{
+    TLock    lock;
+    uint64_t data[8] = {};
+    double   seconds = runThreads(threadCount, [&](uint32_t) {
+        for(uint32_t i = 0; i < OPS_PER_THREAD; ++i)
+        {
+            aph::LockGuard<TLock> guard(lock);
+            criticalSection(data);
+        }
+    });
+    std::printf("  %-18s %10.2f ns/op\n", name, seconds * 1e9 / (OPS_PER_THREAD * threadCount));
+
+    if constexpr(APH_LOCK_STATS && std::is_base_of_v<aph::detail::LockProfiler, TLock>)
+    {
+        const auto& stats = lock.GetStats();
+        std::printf("  %-18s acquisitions %llu  spins %llu  parks %llu  avg hold %.1f ns\n", "",
+                    static_cast<unsigned long long>(stats.acquisitions.load()),
+                    static_cast<unsigned long long>(stats.spins.load()),
+                    static_cast<unsigned long long>(stats.parks.load()),
+                    static_cast<double>(stats.holdTimeNs.load()) / std::max<uint64_t>(stats.acquisitions.load(), 1));
+    }
+}
+
+// One writer for every 16 reads.
+template <typename TLock>
+void benchReadMostly(const char* name, uint32_t threadCount)
+{
+    TLock    lock;
+    uint64_t data[8] = {};
+    double   seconds = runThreads(threadCount, [&](uint32_t) {
+        uint64_t sum = 0;
+        for(uint32_t i = 0; i < OPS_PER_THREAD; ++i)
+        {
+            if(i % 16 == 0)
+            {
+                aph::LockGuard<TLock> guard(lock);
+                criticalSection(data);
+            }
+            else
+            {
+                aph::SharedLockGuard<TLock> guard(lock);
+                sum += data[i % 8];
+            }
+        }
+        if(sum == 1)
+            std::printf(" ");
+    });
+    std::printf("  %-18s %10.2f ns/op\n", name, seconds * 1e9 / (OPS_PER_THREAD * threadCount));
+}
+}  // namespace
+
+APH_BENCHMARK(Lock_Exclusive)
+{
+    for(uint32_t threadCount : { 1U, 2U, 4U, 8U })
+    {
+        std::printf("%u threads\n", threadCount);
+        benchExclusive<StdMutex>("std::mutex", threadCount);
+        benchExclusive<aph::SpinLock>("SpinLock", threadCount);
+        benchExclusive<aph::TicketLock>("TicketLock", threadCount);
+        benchExclusive<aph::AdaptiveMutex>("AdaptiveMutex", threadCount);
+        benchExclusive<aph::RWSpinLock>("RWSpinLock", threadCount);
+    }
+}
+
+APH_BENCHMARK(Lock_ReadMostly)
+{
+    for(uint32_t threadCount : { 1U, 2U, 4U, 8U })
+    {
+        std::printf("%u threads\n", threadCount);
+        benchReadMostly<StdSharedMutex>("std::shared_mutex", threadCount);
+        benchReadMostly<aph::RWSpinLock>("RWSpinLock", threadCount);
+    }
+}
+
+APH_BENCHMARK(SpinLock_Contention)
+{
+    // Every thread hammers the same lock around a tiny critical section, the worst case for spinning.
+    constexpr uint32_t OPS = 50000;
+    for(uint32_t threadCount : { 1U, 2U, 4U, 8U })
+    {
+        aph::SpinLock lock;
+        uint64_t      data[8] = {};
+        measure(std::to_string(threadCount) + " threads", OPS * threadCount, [&]() {
+            runThreads(threadCount, [&](uint32_t) {
+                for(uint32_t i = 0; i < OPS; ++i)
+                {
+                    aph::LockGuard<aph::SpinLock> guard(lock);
+                    criticalSection(data);
+                }
+            });
+        });
+        doNotOptimize(data);
+    }
+}
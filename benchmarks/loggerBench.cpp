@@ -0,0 +1,56 @@
+#include "bench.h"
+#include "common/logger.h"
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t MESSAGE_COUNT = 100000;
+
+// Per-call latency on the logging thread, the cost a hot path actually pays.
+template <typename F>
+void runLatency(const char* name, F&& logOne)
+{
+    std::vector<double> latencies(MESSAGE_COUNT);
+    auto                start = Clock::now();
+    for(uint32_t i = 0; i < MESSAGE_COUNT; ++i)
+    {
+        auto callStart = Clock::now();
+        logOne(i);
+        latencies[i] = std::chrono::duration<double, std::nano>(Clock::now() - callStart).count();
+    }
+    double seconds = elapsedSeconds(start, Clock::now());
+    std::printf("%-14s %10.0f msgs/s   call ns: p50 %8.1f  p99 %8.1f  max %10.1f\n", name, MESSAGE_COUNT / seconds,
+                percentile(latencies, 0.5), percentile(latencies, 0.99), percentile(latencies, 1.0));
+}
+}  // namespace
+
+APH_BENCHMARK(Logger_CallLatency)
+{
+    std::ofstream devNull("/dev/null");
+    aph::Logger::_loglevel() = LOG_INFO;
+
+    {
+        aph::Logger logger(devNull, "bench");
+        runLatency("sync", [&](uint32_t i) { logger(LOG_INFO) << "frame " << i << " took " << 16.6f << " ms\n"; });
+    }
+    {
+        aph::AsyncLogger logger(devNull, aph::LogOverflowPolicy::BLOCK);
+        runLatency("async block", [&](uint32_t i) { logger.log(LOG_INFO, "frame {} took {} ms", i, 16.6f); });
+    }
+    {
+        std::ofstream    binaryNull("/dev/null", std::ios::binary);
+        aph::AsyncLogger logger(binaryNull, aph::LogOverflowPolicy::BLOCK, aph::AsyncLogger::DEFAULT_RING_SIZE,
+                                aph::LogOutputFormat::BINARY);
+        runLatency("async binary", [&](uint32_t i) { logger.log(LOG_INFO, "frame {} took {} ms", i, 16.6f); });
+    }
+    // Compiled out entirely when APH_LOG_COMPILE_LEVEL is below LOG_DEBUG, filtered at runtime otherwise.
+    runLatency("debug disabled", [&](uint32_t i) { LOG_ASYNC_DEBUG("frame {} took {} ms", i, 16.6f); });
+    {
+        aph::AsyncLogger logger(devNull, aph::LogOverflowPolicy::DROP);
+        runLatency("async drop", [&](uint32_t i) { logger.log(LOG_INFO, "frame {} took {} ms", i, 16.6f); });
+        logger.flush();
+        std::printf("%-14s %u of %u messages dropped\n", "", static_cast<uint32_t>(logger.getDroppedCount()),
+                    MESSAGE_COUNT);
+    }
+}
@@ -0,0 +1,104 @@
+#include "bench.h"
+
+namespace aph::bench
+{
+std::vector<Benchmark>& getRegistry()
+{
+    static std::vector<Benchmark> registry;
+    return registry;
+}
+
+Settings& getSettings()
+{
+    static Settings settings;
+    return settings;
+}
+
+std::vector<Measurement>& getMeasurements()
+{
+    static std::vector<Measurement> measurements;
+    return measurements;
+}
+}  // namespace aph::bench
+
+namespace
+{
+using namespace aph::bench;
+
+bool writeJson(const char* path)
+{
+    std::ofstream file(path, std::ios::binary);
+    if(!file)
+        return false;
+
+    const Settings& settings = getSettings();
+    file << "{\"warmup\":" << settings.warmup << ",\"repetitions\":" << settings.repetitions << ",\"results\":[";
+    bool first = true;
+    for(const auto& measurement : getMeasurements())
+    {
+        char buffer[160];
+        std::snprintf(buffer, sizeof(buffer), "\"items\":%llu,\"medianNs\":%.3f,\"madNs\":%.3f,\"minNs\":%.3f}",
+                      static_cast<unsigned long long>(measurement.items), measurement.medianNs, measurement.madNs,
+                      measurement.minNs);
+        // Names are identifiers and plain labels, nothing that needs escaping.
+        file << (first ? "" : ",") << "\n{\"benchmark\":\"" << measurement.benchmark << "\",\"name\":\""
+             << measurement.name << "\"," << buffer;
+        first = false;
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+}  // namespace
+
+// usage: engine_bench [--warmup N] [--repetitions N] [--json results.json] [filter...]
+// Runs every registered benchmark whose name contains one of the filters (all of them if none given). Measurements
+// report the median and MAD over the repetitions, --json also writes them to a file.
+int main(int argc, char** argv)
+{
+    std::vector<std::string_view> filters;
+    const char*                   jsonPath = nullptr;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if((arg == "--warmup" || arg == "--repetitions" || arg == "--json") && i + 1 == argc)
+        {
+            std::fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 1;
+        }
+
+        if(arg == "--warmup")
+            getSettings().warmup = std::atoi(argv[++i]);
+        else if(arg == "--repetitions")
+            getSettings().repetitions = std::max(std::atoi(argv[++i]), 1);
+        else if(arg == "--json")
+            jsonPath = argv[++i];
+        else
+            filters.push_back(arg);
+    }
+
+    for(const auto& benchmark : getRegistry())
+    {
+        bool selected = filters.empty();
+        for(auto filter : filters)
+        {
+            selected = selected || std::string_view(benchmark.name).find(filter) != std::string_view::npos;
+        }
+        if(!selected)
+            continue;
+
+        std::cout << "== " << benchmark.name << std::endl;
+        size_t first = getMeasurements().size();
+        benchmark.func();
+        for(size_t i = first; i < getMeasurements().size(); ++i)
+        {
+            getMeasurements()[i].benchmark = benchmark.name;
+        }
+    }
+
+    if(jsonPath && !writeJson(jsonPath))
+    {
+        std::fprintf(stderr, "could not write %s\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "bench.h"
+#include "scene/meshOptimizer.h"
+#include "scene/meshSimplifier.h"
+
+#include <random>
+
+namespace
+{
+using namespace aph::bench;
+
+// Latitude-longitude sphere of 2 * RINGS * SEGMENTS triangles. The texture coordinates wrap around, so the first and
+// last column of vertices share positions along a seam.
+constexpr uint32_t SPHERE_RINGS    = 128;
+constexpr uint32_t SPHERE_SEGMENTS = 256;
+
+void buildSphere(std::vector<aph::Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+    for(uint32_t ring = 0; ring <= SPHERE_RINGS; ++ring)
+    {
+        for(uint32_t segment = 0; segment <= SPHERE_SEGMENTS; ++segment)
+        {
+            glm::vec2 uv{ float(segment) / SPHERE_SEGMENTS, float(ring) / SPHERE_RINGS };
+            float     theta = uv.y * glm::pi<float>(), phi = uv.x * glm::two_pi<float>();
+            glm::vec3 normal{ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+            // The poles and the seam must hit the very same positions.
+            if(ring == 0 || ring == SPHERE_RINGS)
+                normal = { 0.0f, ring == 0 ? 1.0f : -1.0f, 0.0f };
+            if(segment == SPHERE_SEGMENTS)
+                normal = vertices[vertices.size() - SPHERE_SEGMENTS].pos;
+            vertices.push_back(
+                { .pos = normal, .normal = normal, .uv = uv, .color = glm::vec3(1.0f), .tangent = glm::vec4(0.0f) });
+        }
+    }
+    for(uint32_t ring = 0; ring < SPHERE_RINGS; ++ring)
+    {
+        for(uint32_t segment = 0; segment < SPHERE_SEGMENTS; ++segment)
+        {
+            uint32_t corner = ring * (SPHERE_SEGMENTS + 1) + segment;
+            for(uint32_t offset : { 0u, SPHERE_SEGMENTS + 1, 1u, 1u, SPHERE_SEGMENTS + 1, SPHERE_SEGMENTS + 2 })
+                indices.push_back(corner + offset);
+        }
+    }
+}
+}  // namespace
+
+// Level of detail chain of a 64k triangle sphere, each level half the triangles of the full mesh.
+APH_BENCHMARK(Mesh_Simplify)
+{
+    std::vector<aph::Vertex> vertices;
+    std::vector<uint32_t>    indices;
+    buildSphere(vertices, indices);
+    size_t triangles = indices.size() / 3;
+
+    for(uint32_t divisor : { 2, 8, 32 })
+    {
+        aph::SimplifyOptions options{ .targetIndexCount = indices.size() / divisor / 3 * 3,
+                                      .normalWeight     = 0.01f,
+                                      .uvWeight         = 0.01f };
+        std::vector<uint32_t> simplified;
+        float                 error = {};
+        std::string           name  = "64k triangles to 1/" + std::to_string(divisor);
+        measure(name, triangles, [&]() {
+            simplified = aph::simplifyMesh(vertices, indices, options, &error);
+            doNotOptimize(simplified.data());
+        });
+        std::printf("  %zu triangles, error %.5f\n", simplified.size() / 3, error);
+    }
+}
+
+// Import-time reordering of the same sphere with its triangles shuffled, the worst case for the vertex cache.
+APH_BENCHMARK(Mesh_Optimize)
+{
+    std::vector<aph::Vertex> vertices;
+    std::vector<uint32_t>    indices;
+    buildSphere(vertices, indices);
+    size_t triangles = indices.size() / 3;
+
+    std::vector<std::array<uint32_t, 3>> shuffled(triangles);
+    memcpy(shuffled.data(), indices.data(), indices.size() * sizeof(uint32_t));
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+    memcpy(indices.data(), shuffled.data(), indices.size() * sizeof(uint32_t));
+
+    std::vector<uint32_t> cacheOptimized = indices;
+    std::vector<uint32_t> overdrawOptimized;
+    std::vector<uint32_t> remap;
+    measure("weld, 64k triangles", triangles, [&]() { doNotOptimize(aph::generateWeldRemap(vertices, remap)); });
+    measure("vertex cache, 64k triangles", triangles, [&]() {
+        cacheOptimized = indices;
+        aph::optimizeVertexCache(cacheOptimized, vertices.size());
+    });
+    measure("overdraw, 64k triangles", triangles, [&]() {
+        overdrawOptimized = cacheOptimized;
+        aph::optimizeOverdraw(overdrawOptimized, vertices);
+    });
+    std::printf("  ACMR %.3f shuffled, %.3f cache optimized, %.3f overdraw optimized\n",
+                aph::analyzeVertexCache(indices).getAcmr(), aph::analyzeVertexCache(cacheOptimized).getAcmr(),
+                aph::analyzeVertexCache(overdrawOptimized).getAcmr());
+}
@@ -0,0 +1,91 @@
+#include "bench.h"
+#include "common/mpmcQueue.h"
+#include "legacy.h"
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t ITEM_COUNT     = 1 << 20;
+constexpr uint32_t CONSUMER_COUNT = 4;
+constexpr size_t   CAPACITY       = 4096;
+
+// Every producer pushes its share of ITEM_COUNT, CONSUMER_COUNT consumers pop their share and checksum it.
+template <typename TPush, typename TPop>
+double runContention(uint32_t producerCount, TPush&& push, TPop&& pop)
+{
+    const uint32_t perProducer = ITEM_COUNT / producerCount;
+    const uint32_t total       = perProducer * producerCount;
+
+    std::atomic<uint64_t>    checksum{ 0 };
+    std::atomic_bool         go{ false };
+    std::vector<std::thread> threads;
+
+    for(uint32_t c = 0; c < CONSUMER_COUNT; ++c)
+    {
+        uint32_t share = total / CONSUMER_COUNT + (c < total % CONSUMER_COUNT ? 1 : 0);
+        threads.emplace_back([&, share]() {
+            while(!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            uint64_t sum = 0;
+            for(uint32_t i = 0; i < share; ++i)
+                sum += pop();
+            checksum.fetch_add(sum, std::memory_order_relaxed);
+        });
+    }
+    for(uint32_t p = 0; p < producerCount; ++p)
+    {
+        threads.emplace_back([&]() {
+            while(!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            for(uint32_t i = 0; i < perProducer; ++i)
+                push(i);
+        });
+    }
+
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for(auto& thread : threads)
+        thread.join();
+    double seconds = elapsedSeconds(start, Clock::now());
+
+    uint64_t expected = static_cast<uint64_t>(perProducer) * (perProducer - 1) / 2 * producerCount;
+    if(checksum.load() != expected)
+        std::printf("checksum mismatch!\n");
+    return total / seconds;
+}
+}  // namespace
+
+APH_BENCHMARK(MPMCQueue_Contention)
+{
+    std::printf("%u items, %u consumers, capacity %zu\n", ITEM_COUNT, CONSUMER_COUNT, CAPACITY);
+    for(uint32_t producerCount : { 1U, 4U, 16U, 64U })
+    {
+        double legacyRate = 0.0;
+        {
+            legacy::ThreadSafeQueue<uint32_t> queue;
+            legacyRate = runContention(
+                producerCount, [&](uint32_t value) { queue.Push(std::move(value)); },
+                [&]() {
+                    uint32_t value = 0;
+                    queue.Pop(value);
+                    return value;
+                });
+        }
+
+        double lockFreeRate = 0.0;
+        {
+            aph::BlockingMPMCQueue<uint32_t> queue(CAPACITY);
+            lockFreeRate = runContention(
+                producerCount, [&](uint32_t value) { queue.Push(value); },
+                [&]() {
+                    uint32_t value = 0;
+                    queue.Pop(value);
+                    return value;
+                });
+        }
+
+        std::printf("%2u producers   legacy %12.0f items/s   mpmc %12.0f items/s\n", producerCount, legacyRate,
+                    lockFreeRate);
+    }
+}
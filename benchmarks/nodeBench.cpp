@@ -0,0 +1,86 @@
+#include "bench.h"
+#include "scene/node.h"
+
+namespace
+{
+using namespace aph::bench;
+
+// A single chain, the worst case for transform propagation: moving the root dirties every node.
+std::vector<std::shared_ptr<aph::SceneNode>> buildChain(uint32_t depth)
+{
+    std::vector<std::shared_ptr<aph::SceneNode>> chain{ aph::Object::Create<aph::SceneNode>(nullptr) };
+    for(uint32_t i = 1; i < depth; ++i)
+    {
+        auto child = chain.back()->createChildNode();
+        child->translate(glm::vec3(0.01f, 0.0f, 0.0f)).rotate(0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+        chain.push_back(child);
+    }
+    chain.front()->updateTransforms();
+    return chain;
+}
+}  // namespace
+
+APH_BENCHMARK(Node_GetTransform)
+{
+    // World transform of every node, as a renderer collecting all meshes would ask for it. Nothing moves, so this is
+    // the cached path.
+    for(uint32_t depth : { 8U, 64U, 512U })
+    {
+        auto chain = buildChain(depth);
+        measure("all nodes, depth " + std::to_string(depth), depth, [&]() {
+            for(const auto& node : chain)
+            {
+                doNotOptimize(node->getTransform());
+            }
+        });
+    }
+
+    // Only the deepest node.
+    for(uint32_t depth : { 8U, 64U, 512U })
+    {
+        constexpr uint32_t CALLS = 1000;
+        auto               chain = buildChain(depth);
+        measure("leaf, depth " + std::to_string(depth), CALLS, [&]() {
+            for(uint32_t i = 0; i < CALLS; ++i)
+            {
+                doNotOptimize(chain.back()->getTransform());
+            }
+        });
+    }
+}
+
+APH_BENCHMARK(Node_UpdateTransforms)
+{
+    // One node moved per frame, then the per-frame update, recomputing the moved branch only.
+    constexpr uint32_t DEPTH = 512;
+    auto               chain = buildChain(DEPTH);
+    auto&              root  = chain.front();
+    root->updateTransforms();
+
+    measure("root moved, depth 512", DEPTH, [&]() {
+        root->rotate(0.001f, glm::vec3(0.0f, 1.0f, 0.0f));
+        root->updateTransforms();
+    });
+    measure("leaf moved, depth 512", 1, [&]() {
+        chain.back()->rotate(0.001f, glm::vec3(0.0f, 1.0f, 0.0f));
+        root->updateTransforms();
+    });
+    measure("nothing moved", 1, [&]() { root->updateTransforms(); });
+
+    // Shallow and wide, the usual shape of an imported scene: every level is split across the thread pool.
+    constexpr uint32_t FANOUT = 64;
+    auto               wide   = aph::Object::Create<aph::SceneNode>(nullptr);
+    for(uint32_t i = 0; i < FANOUT; ++i)
+    {
+        auto child = wide->createChildNode(glm::translate(glm::mat4(1.0f), glm::vec3(float(i), 0.0f, 0.0f)));
+        for(uint32_t j = 0; j < FANOUT; ++j)
+        {
+            child->createChildNode(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, float(j), 0.0f)));
+        }
+    }
+    wide->updateTransforms();
+    measure("root moved, 64 x 64 children", 1 + FANOUT + FANOUT * FANOUT, [&]() {
+        wide->rotate(0.001f, glm::vec3(0.0f, 1.0f, 0.0f));
+        wide->updateTransforms();
+    });
+}
@@ -0,0 +1,66 @@
+#include "bench.h"
+#include "common/parallel.h"
+
+#include <numeric>
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t REPETITIONS = 10;
+
+template <typename F>
+double bestOf(F&& func)
+{
+    double best = std::numeric_limits<double>::max();
+    for(uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+        auto start = Clock::now();
+        func();
+        best = std::min(best, elapsedSeconds(start, Clock::now()));
+    }
+    return best;
+}
+}  // namespace
+
+APH_BENCHMARK(Parallel_RGBToRGBA)
+{
+    // One 4k texture, the case gltf::loadImages hits for RGB-only images.
+    constexpr size_t     PIXEL_COUNT = 4096 * 4096;
+    std::vector<uint8_t> rgb(PIXEL_COUNT * 3, 0x7F);
+    std::vector<uint8_t> rgba(PIXEL_COUNT * 4);
+
+    auto convert = [&](size_t i) {
+        memcpy(&rgba[4 * i], &rgb[3 * i], 3);
+        rgba[4 * i + 3] = 0xFF;
+    };
+
+    double serial = bestOf([&]() {
+        for(size_t i = 0; i < PIXEL_COUNT; ++i)
+            convert(i);
+    });
+    double parallel = bestOf([&]() { aph::parallelFor(0, PIXEL_COUNT, convert, 64 * 1024); });
+    std::printf("serial %8.2f ms   parallelFor %8.2f ms   (%u workers)\n", serial * 1e3, parallel * 1e3,
+                aph::ThreadPool::GetDefault()->GetThreadCount());
+}
+
+APH_BENCHMARK(Parallel_Reduce)
+{
+    constexpr size_t   COUNT = 1 << 24;
+    std::vector<float> values(COUNT, 0.5f);
+
+    double serialSum = 0.0;
+    double serial    = bestOf([&]() { serialSum = std::accumulate(values.begin(), values.end(), 0.0); });
+
+    double parallelSum = 0.0;
+    double parallel    = bestOf([&]() {
+        parallelSum = aph::parallelReduce(
+            0, COUNT, 0.0,
+            [&](size_t begin, size_t end, double sum) {
+                return std::accumulate(values.begin() + begin, values.begin() + end, sum);
+            },
+            std::plus<double>(), 64 * 1024);
+    });
+    std::printf("serial %8.2f ms   parallelReduce %8.2f ms   (sums %s)\n", serial * 1e3, parallel * 1e3,
+                serialSum == parallelSum ? "match" : "MISMATCH");
+}
@@ -0,0 +1,35 @@
+#include "bench.h"
+#include "common/profiler.h"
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t FRAME_COUNT     = 200;
+constexpr uint32_t ZONES_PER_FRAME = 4096;
+}  // namespace
+
+// Cost of one nested pair of zones, including draining them at the start of the next frame.
+APH_BENCHMARK(Profiler_ZoneOverhead)
+{
+    uint64_t sum   = 0;
+    auto     start = Clock::now();
+    for(uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+    {
+        aph::Profiler::BeginFrame();
+        for(uint32_t zone = 0; zone < ZONES_PER_FRAME / 2; ++zone)
+        {
+            APH_PROFILE_SCOPE("outer");
+            {
+                APH_PROFILE_SCOPE("inner");
+                sum += zone;
+            }
+        }
+    }
+    aph::Profiler::BeginFrame();
+    double seconds = elapsedSeconds(start, Clock::now());
+    if(sum == 1)
+        std::printf(" ");
+    std::printf("%-16s %8.1f ns/zone   dropped %llu\n", "ProfileScope", seconds * 1e9 / (FRAME_COUNT * ZONES_PER_FRAME),
+                static_cast<unsigned long long>(aph::Profiler::GetDroppedZoneCount()));
+}
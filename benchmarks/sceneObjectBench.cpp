@@ -0,0 +1,59 @@
+#include "bench.h"
+#include "scene/scene.h"
+
+#include <random>
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t OBJECT_COUNT = 200000;
+}  // namespace
+
+// Scene objects looked up by id and visited in bulk, against the unordered_map of shared_ptr the scene used before.
+APH_BENCHMARK(Scene_ObjectStorage)
+{
+    auto                                                         scene = aph::Scene::Create(aph::SceneType::DEFAULT);
+    std::unordered_map<aph::IdType, std::shared_ptr<aph::Light>> map;
+    std::vector<aph::IdType>                                     ids;
+    for(uint32_t i = 0; i < OBJECT_COUNT; ++i)
+    {
+        auto light = scene->createLight();
+        light->setColor(glm::vec3(float(i % 7)));
+        map[light->getId()] = light;
+        ids.push_back(light->getId());
+    }
+    // Every tenth light destroyed and recreated, so slots are reused and the dense order no longer matches the ids.
+    for(uint32_t i = 0; i < OBJECT_COUNT; i += 10)
+    {
+        map.erase(ids[i]);
+        scene->destroyLight(ids[i]);
+        auto light          = scene->createLight();
+        ids[i]              = light->getId();
+        map[light->getId()] = light;
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+
+    // Both return a shared_ptr copy, as getLightWithId() always did.
+    measure("lookup, unordered_map", OBJECT_COUNT, [&]() {
+        for(aph::IdType id : ids)
+            doNotOptimize(std::shared_ptr<aph::Light>(map.find(id)->second).get());
+    });
+    measure("lookup, slot map", OBJECT_COUNT, [&]() {
+        for(aph::IdType id : ids)
+            doNotOptimize(scene->getLightWithId(id).get());
+    });
+
+    measure("iterate, unordered_map", OBJECT_COUNT, [&]() {
+        glm::vec3 sum{};
+        for(const auto& [id, light] : map)
+            sum += light->getColor();
+        doNotOptimize(sum);
+    });
+    measure("iterate, slot map", OBJECT_COUNT, [&]() {
+        glm::vec3 sum{};
+        for(const auto& light : scene->getLights())
+            sum += light->getColor();
+        doNotOptimize(sum);
+    });
+}
@@ -0,0 +1,113 @@
+#include "bench.h"
+#include "scene/node.h"
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t NODE_COUNT  = 100000;
+constexpr uint32_t FANOUT      = 8;
+constexpr uint32_t REPETITIONS = 20;
+
+// What Object::Create and Node::createChildNode did before they were pooled: a separate heap block per object plus
+// one for the shared_ptr control block of every node.
+std::shared_ptr<aph::SceneNode> createChildHeap(aph::SceneNode* pParent)
+{
+    auto child = std::shared_ptr<aph::SceneNode>(new aph::SceneNode(pParent));
+    pParent->addChild(child);
+    return child;
+}
+
+// Breadth-first, every node carries a mesh like a glTF import produces.
+template <typename FCreateChild, typename FCreateMesh>
+std::shared_ptr<aph::SceneNode> buildScene(std::shared_ptr<aph::SceneNode> root, FCreateChild&& createChild,
+                                           FCreateMesh&& createMesh)
+{
+    std::vector<std::shared_ptr<aph::SceneNode>> level{ root };
+    uint32_t                                     count = 1;
+    while(count < NODE_COUNT)
+    {
+        std::vector<std::shared_ptr<aph::SceneNode>> next;
+        for(const auto& node : level)
+        {
+            for(uint32_t i = 0; i < FANOUT && count < NODE_COUNT; ++i, ++count)
+            {
+                auto child = createChild(node.get());
+                auto mesh  = createMesh();
+                mesh->m_subsets.push_back({ .firstIndex = 0, .indexCount = 36 });
+                child->template attachObject<aph::Mesh>(mesh);
+                child->translate(glm::vec3(0.1f * i, 0.0f, 0.0f));
+                next.push_back(child);
+            }
+        }
+        level = std::move(next);
+    }
+    return root;
+}
+
+// One frame of scene update: animate every node, then compute world transforms walking down from the root.
+float updateScene(aph::SceneNode* pNode, const glm::mat4& parentWorld)
+{
+    pNode->rotate(0.001f, glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 world = parentWorld * pNode->getMatrix();
+    float     sum   = world[3][0];
+    if(pNode->getAttachType() == aph::ObjectType::MESH)
+    {
+        sum += static_cast<float>(pNode->getObject<aph::Mesh>()->m_subsets.size());
+    }
+    for(const auto& child : pNode->getChildren())
+    {
+        sum += updateScene(child.get(), world);
+    }
+    return sum;
+}
+
+void benchScene(const char* name, const std::shared_ptr<aph::SceneNode>& root)
+{
+    std::vector<double> times;
+    float               sum = 0.0f;
+    for(uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+        auto start = Clock::now();
+        sum += updateScene(root.get(), glm::mat4(1.0f));
+        times.push_back(elapsedSeconds(start, Clock::now()) * 1e3);
+    }
+    std::printf("%-8s update %7.2f ms (p50)  %7.2f ms (min)%s\n", name, percentile(times, 0.5),
+                percentile(times, 0.0), sum == 0.0f ? " " : "");
+}
+}  // namespace
+
+APH_BENCHMARK(Scene_PooledNodes)
+{
+    // Interleaved unrelated allocations, as a scene load has them (names, vertex data, textures).
+    std::vector<std::unique_ptr<char[]>> churn;
+    auto scatter = [&]() { churn.push_back(std::make_unique<char[]>(16 + churn.size() % 200)); };
+
+    auto createHeapNode = [&](aph::SceneNode* pParent) {
+        scatter();
+        return createChildHeap(pParent);
+    };
+    auto createHeapMesh = [&]() {
+        scatter();
+        return std::make_shared<aph::Mesh>();
+    };
+    auto createPooledNode = [&](aph::SceneNode* pParent) {
+        scatter();
+        return pParent->createChildNode();
+    };
+    auto createPooledMesh = [&]() {
+        scatter();
+        return aph::Object::Create<aph::Mesh>();
+    };
+
+    auto start     = Clock::now();
+    auto heapScene = buildScene(std::make_shared<aph::SceneNode>(nullptr), createHeapNode, createHeapMesh);
+    std::printf("%-8s build  %7.2f ms\n", "heap", elapsedSeconds(start, Clock::now()) * 1e3);
+
+    start            = Clock::now();
+    auto pooledScene = buildScene(aph::Object::Create<aph::SceneNode>(nullptr), createPooledNode, createPooledMesh);
+    std::printf("%-8s build  %7.2f ms\n", "pooled", elapsedSeconds(start, Clock::now()) * 1e3);
+
+    benchScene("heap", heapScene);
+    benchScene("pooled", pooledScene);
+}
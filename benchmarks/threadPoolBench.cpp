@@ -0,0 +1,142 @@
+#include "bench.h"
+#include "common/threadPool.h"
+#include "legacy.h"
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t TASK_COUNT = 200000;
+
+uint32_t getThreadCount()
+{
+    return std::max(1U, std::thread::hardware_concurrency() - 1);
+}
+
+void report(const char* pool, double seconds, std::vector<double>& latencies)
+{
+    std::printf("%-14s %12.0f tasks/s   latency us: p50 %8.2f  p99 %8.2f  p99.9 %8.2f  max %8.2f\n", pool,
+                TASK_COUNT / seconds, percentile(latencies, 0.5), percentile(latencies, 0.99),
+                percentile(latencies, 0.999), percentile(latencies, 1.0));
+}
+
+// Submit-to-start latency of each task, measured from the submitting thread's clock reading.
+template <typename TSubmit, typename TWait>
+void runFlat(const char* name, TSubmit&& submit, TWait&& wait)
+{
+    std::vector<Clock::time_point> submitTimes(TASK_COUNT);
+    std::vector<double>            latencies(TASK_COUNT);
+
+    auto start = Clock::now();
+    for(uint32_t i = 0; i < TASK_COUNT; ++i)
+    {
+        submitTimes[i] = Clock::now();
+        submit([i, &submitTimes, &latencies]() {
+            latencies[i] = std::chrono::duration<double, std::micro>(Clock::now() - submitTimes[i]).count();
+        });
+    }
+    wait();
+    auto end = Clock::now();
+
+    report(name, elapsedSeconds(start, end), latencies);
+}
+}  // namespace
+
+APH_BENCHMARK(ThreadPool_FlatSubmit)
+{
+    const uint32_t threadCount = getThreadCount();
+    std::printf("%u worker threads, %u tasks\n", threadCount, TASK_COUNT);
+    {
+        legacy::ThreadPool pool(threadCount);
+        runFlat(
+            "legacy", [&](auto&& task) { pool.AddTask(std::move(task)); }, [&]() { pool.Wait(); });
+    }
+    {
+        aph::ThreadPool pool(threadCount);
+        runFlat(
+            "work-stealing", [&](auto&& task) { pool.AddTask(std::move(task)); }, [&]() { pool.Wait(); });
+    }
+}
+
+APH_BENCHMARK(ThreadPool_NestedSpawn)
+{
+    // Fork-join from inside tasks: 64 parents each spawning 1024 children.
+    constexpr uint32_t PARENT_COUNT = 64;
+    constexpr uint32_t CHILD_COUNT  = 1024;
+    const uint32_t     threadCount  = getThreadCount();
+
+    {
+        legacy::ThreadPool    pool(threadCount);
+        std::atomic<uint32_t> counter{ 0 };
+        auto                  start = Clock::now();
+        for(uint32_t p = 0; p < PARENT_COUNT; ++p)
+        {
+            pool.AddTask([&]() {
+                for(uint32_t c = 0; c < CHILD_COUNT; ++c)
+                    pool.AddTask([&]() { counter.fetch_add(1, std::memory_order_relaxed); });
+            });
+        }
+        while(counter.load() < PARENT_COUNT * CHILD_COUNT)
+            std::this_thread::yield();
+        pool.Wait();
+        std::printf("%-14s %12.0f tasks/s\n", "legacy",
+                    PARENT_COUNT * CHILD_COUNT / elapsedSeconds(start, Clock::now()));
+    }
+    {
+        aph::ThreadPool       pool(threadCount);
+        std::atomic<uint32_t> counter{ 0 };
+        auto                  start = Clock::now();
+        for(uint32_t p = 0; p < PARENT_COUNT; ++p)
+        {
+            pool.AddTask([&]() {
+                for(uint32_t c = 0; c < CHILD_COUNT; ++c)
+                    pool.AddTask([&]() { counter.fetch_add(1, std::memory_order_relaxed); });
+            });
+        }
+        pool.Wait();
+        std::printf("%-14s %12.0f tasks/s\n", "work-stealing",
+                    PARENT_COUNT * CHILD_COUNT / elapsedSeconds(start, Clock::now()));
+    }
+}
+
+APH_BENCHMARK(ThreadPool_WaitGroup)
+{
+    // Many small batches, each awaited on its own group, as a frame would do per stage.
+    constexpr uint32_t BATCH_COUNT = 2000;
+    constexpr uint32_t BATCH_SIZE  = 64;
+    aph::ThreadPool    pool(getThreadCount());
+
+    std::vector<double> batchTimes(BATCH_COUNT);
+    for(uint32_t b = 0; b < BATCH_COUNT; ++b)
+    {
+        auto            start = Clock::now();
+        aph::WaitGroup  group;
+        std::atomic_int sum{ 0 };
+        for(uint32_t i = 0; i < BATCH_SIZE; ++i)
+        {
+            pool.AddTask([&sum]() { sum.fetch_add(1, std::memory_order_relaxed); }, &group);
+        }
+        pool.Wait(group);
+        batchTimes[b] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+    std::printf("batch of %u us: p50 %8.2f  p99 %8.2f  max %8.2f\n", BATCH_SIZE, percentile(batchTimes, 0.5),
+                percentile(batchTimes, 0.99), percentile(batchTimes, 1.0));
+}
+
+APH_BENCHMARK(ThreadPool_AddTask)
+{
+    // Submission plus execution of trivial tasks, the pool is created once so thread startup is not charged.
+    constexpr uint32_t BATCH_SIZE = 20000;
+    for(uint32_t threadCount : std::set<uint32_t>{ 1U, getThreadCount() })
+    {
+        aph::ThreadPool       pool(threadCount);
+        std::atomic<uint64_t> counter{ 0 };
+        measure(std::to_string(threadCount) + " workers", BATCH_SIZE, [&]() {
+            for(uint32_t i = 0; i < BATCH_SIZE; ++i)
+            {
+                pool.AddTask([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+            }
+            pool.Wait();
+        });
+    }
+}
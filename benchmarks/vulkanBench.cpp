@@ -0,0 +1,72 @@
+#include "bench.h"
+#include "renderer/api/vulkan/renderer.h"
+
+namespace
+{
+using namespace aph::bench;
+
+constexpr uint32_t OBJECT_COUNT = 256;
+
+// One headless renderer for every benchmark that needs a device, created on first use. Runs on any ICD, lavapipe
+// included.
+aph::VulkanRenderer* getRenderer()
+{
+    static std::unique_ptr<aph::VulkanRenderer> renderer = []() {
+        aph::RenderConfig config{
+            .enableDebug = false,
+            .enableUI    = false,
+            .headless    = true,
+        };
+        return aph::IRenderer::Create<aph::VulkanRenderer>(aph::Window::Create(256, 256, true), config);
+    }();
+    return renderer.get();
+}
+}  // namespace
+
+APH_BENCHMARK(Vulkan_DescriptorPool)
+{
+    auto* pDevice = getRenderer()->getDevice();
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings{
+        { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL },
+        { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, VK_SHADER_STAGE_FRAGMENT_BIT },
+    };
+    VkDescriptorSetLayoutCreateInfo createInfo{
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings    = bindings.data(),
+    };
+    aph::VulkanDescriptorSetLayout* pLayout = nullptr;
+    VK_CHECK_RESULT(pDevice->createDescriptorSetLayout(createInfo, &pLayout));
+
+    // Spans several VkDescriptorPools, the first round creates them and is left to the warmup.
+    std::vector<VkDescriptorSet> sets(OBJECT_COUNT);
+    measure("allocateSet + freeSet", OBJECT_COUNT, [&]() {
+        for(auto& set : sets)
+            set = pLayout->allocateSet();
+        for(auto set : sets)
+            pLayout->freeSet(set);
+    });
+
+    pDevice->destroyDescriptorSetLayout(pLayout);
+}
+
+APH_BENCHMARK(Vulkan_SyncPrimitivesPool)
+{
+    auto* pPool = getRenderer()->getSyncPrimitiviesPool();
+
+    std::vector<VkFence> fences(OBJECT_COUNT);
+    measure("acquireFence + releaseFence", OBJECT_COUNT, [&]() {
+        for(auto& fence : fences)
+            pPool->acquireFence(fence, false);
+        for(auto fence : fences)
+            pPool->releaseFence(fence);
+    });
+
+    std::vector<VkSemaphore> semaphores(OBJECT_COUNT);
+    measure("acquireSemaphore + ReleaseSemaphores", OBJECT_COUNT, [&]() {
+        for(auto& semaphore : semaphores)
+            pPool->acquireSemaphore(1, &semaphore);
+        pPool->ReleaseSemaphores(semaphores.size(), semaphores.data());
+    });
+}
@@ -4,5 +4,26 @@ set(CMAKE_CXX_FLAGS "")
 set(CMAKE_CXX_FLAGS_DEBUG "${CMAKE_CXX_FLAGS} -O0 -g -ggdb")
 set(CMAKE_CXX_FLAGS_RELEASE "${CMAKE_CXX_FLAGS} -O3")
 
-set(CMAKE_CXX_STANDARD 17)
+set(CMAKE_CXX_STANDARD 20)
 set(CMAKE_CXX_STANDARD_REQUIRED required)
+
+# Log calls above this level are compiled out (0 silent, 1 error, 2 warning, 3 info, 4 time, 5 debug).
+# Empty keeps everything in Debug builds and strips debug messages from Release builds.
+set(APH_LOG_COMPILE_LEVEL "" CACHE STRING "Highest log level compiled in")
+if(APH_LOG_COMPILE_LEVEL STREQUAL "")
+  add_compile_definitions($<$<CONFIG:Release>:APH_LOG_COMPILE_LEVEL=3>)
+else()
+  add_compile_definitions(APH_LOG_COMPILE_LEVEL=${APH_LOG_COMPILE_LEVEL})
+endif()
+
+# Replaces the global operator new/delete to count heap allocations per subsystem and per frame.
+option(APH_ALLOCATION_TRACKING "Count heap allocations per subsystem tag" OFF)
+if(APH_ALLOCATION_TRACKING)
+  add_compile_definitions(APH_ALLOCATION_TRACKING=1)
+endif()
+
+# Lets the compiler use AVX2 and FMA, the frustum culler then tests eight boxes per instruction instead of four.
+option(APH_ENABLE_AVX2 "Build for CPUs with AVX2 and FMA" OFF)
+if(APH_ENABLE_AVX2)
+  add_compile_options(-mavx2 -mfma)
+endif()
@@ -12,6 +12,9 @@
 #include "common/window.h"
 #include "common/assetManager.h"
 #include "common/timer.h"
+#include "common/parallel.h"
+#include "common/taskGraph.h"
+#include "common/task.h"
 #include "common/logger.h"
 
 #include "app/app.h"
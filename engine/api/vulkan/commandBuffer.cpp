@@ -81,9 +81,9 @@ void VulkanCommandBuffer::bindDescriptorSet(VulkanPipeline* pPipeline, uint32_t
                             descriptorSetCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffset);
 }
 void VulkanCommandBuffer::bindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VulkanBuffer* pBuffer,
-                                            const std::vector<VkDeviceSize>& offsets)
+                                            std::initializer_list<VkDeviceSize> offsets)
 {
-    vkCmdBindVertexBuffers(m_handle, firstBinding, bindingCount, &pBuffer->getHandle(), offsets.data());
+    vkCmdBindVertexBuffers(m_handle, firstBinding, bindingCount, &pBuffer->getHandle(), offsets.begin());
 }
 void VulkanCommandBuffer::bindIndexBuffers(const VulkanBuffer* pBuffer, VkDeviceSize offset, VkIndexType indexType)
 {
@@ -330,7 +330,15 @@ void VulkanCommandBuffer::dispatch(uint32_t groupCountX, uint32_t groupCountY, u
 {
     vkCmdDispatch(getHandle(), groupCountX, groupCountY, groupCountZ);
 }
-void VulkanCommandBuffer::pushDescriptorSet(VulkanPipeline* pipeline, const std::vector<VkWriteDescriptorSet>& writes,
+void VulkanCommandBuffer::resetQueryPool(VkQueryPool pool, uint32_t firstQuery, uint32_t queryCount)
+{
+    vkCmdResetQueryPool(m_handle, pool, firstQuery, queryCount);
+}
+void VulkanCommandBuffer::writeTimestamp(VkPipelineStageFlagBits stage, VkQueryPool pool, uint32_t query)
+{
+    vkCmdWriteTimestamp(m_handle, stage, pool, query);
+}
+void VulkanCommandBuffer::pushDescriptorSet(VulkanPipeline* pipeline, std::span<const VkWriteDescriptorSet> writes,
                                             uint32_t setIdx)
 {
     vkCmdPushDescriptorSetKHR(getHandle(), pipeline->getBindPoint(), pipeline->getPipelineLayout(), setIdx,
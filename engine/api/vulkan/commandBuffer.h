@@ -44,13 +44,13 @@ public:
                            const uint32_t* pDynamicOffset = nullptr);
     void bindPipeline(VulkanPipeline* pPipeline);
     void bindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VulkanBuffer* pBuffer,
-                           const std::vector<VkDeviceSize>& offsets);
+                           std::initializer_list<VkDeviceSize> offsets);
     void bindIndexBuffers(const VulkanBuffer* pBuffer, VkDeviceSize offset, VkIndexType indexType);
     void pushConstants(VulkanPipeline* pPipeline, VkShaderStageFlags stage, uint32_t offset, uint32_t size,
                        const void* pValues);
     void drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset,
                      uint32_t firstInstance);
-    void pushDescriptorSet(VulkanPipeline* pipeline, const std::vector<VkWriteDescriptorSet>& writes, uint32_t setIdx);
+    void pushDescriptorSet(VulkanPipeline* pipeline, std::span<const VkWriteDescriptorSet> writes, uint32_t setIdx);
     void dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
     void draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
     void copyBuffer(VulkanBuffer* srcBuffer, VulkanBuffer* dstBuffer, VkDeviceSize size);
@@ -68,6 +68,8 @@ public:
     void blitImage(VulkanImage* srcImage, VkImageLayout srcImageLayout, VulkanImage* dstImage,
                    VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageBlit* pRegions,
                    VkFilter filter = VK_FILTER_LINEAR);
+    void resetQueryPool(VkQueryPool pool, uint32_t firstQuery, uint32_t queryCount);
+    void writeTimestamp(VkPipelineStageFlagBits stage, VkQueryPool pool, uint32_t query);
 
     uint32_t getQueueFamilyIndices() const;
 
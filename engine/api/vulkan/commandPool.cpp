@@ -14,7 +14,7 @@ VulkanCommandPool::VulkanCommandPool(const CommandPoolCreateInfo& createInfo, Vu
 VkResult VulkanCommandPool::allocateCommandBuffers(uint32_t commandBufferCount, VkCommandBuffer* pCommandBuffers)
 {
     // Safe guard access to internal resources across threads.
-    m_spinLock.Lock();
+    LockGuard<AdaptiveMutex> lock(m_lock);
 
     // Allocate a new command buffer.
     VkCommandBufferAllocateInfo allocInfo = {
@@ -24,20 +24,13 @@ VkResult VulkanCommandPool::allocateCommandBuffers(uint32_t commandBufferCount,
         .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
         .commandBufferCount = commandBufferCount,
     };
-    auto result = vkAllocateCommandBuffers(m_device->getHandle(), &allocInfo, pCommandBuffers);
-
-    // Unlock access to internal resources.
-    m_spinLock.Unlock();
-
-    // Return result.
-    return result;
+    return vkAllocateCommandBuffers(m_device->getHandle(), &allocInfo, pCommandBuffers);
 }
 void VulkanCommandPool::freeCommandBuffers(uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
 {
     // Safe guard access to internal resources across threads.
-    m_spinLock.Lock();
+    LockGuard<AdaptiveMutex> lock(m_lock);
     vkFreeCommandBuffers(m_device->getHandle(), getHandle(), commandBufferCount, pCommandBuffers);
-    m_spinLock.Unlock();
 }
 
 uint32_t VulkanCommandPool::getQueueFamilyIndex() const
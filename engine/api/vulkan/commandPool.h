@@ -24,8 +24,8 @@ public:
     uint32_t getQueueFamilyIndex() const;
 
 private:
-    VulkanDevice* m_device   = {};
-    SpinLock      m_spinLock = {};
+    VulkanDevice* m_device = {};
+    AdaptiveMutex m_lock   = {};
 };
 
 using QueueFamilyCommandPools = std::unordered_map<uint32_t, VulkanCommandPool*>;
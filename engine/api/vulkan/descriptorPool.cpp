@@ -40,7 +40,7 @@ VulkanDescriptorPool::~VulkanDescriptorPool()
 VkDescriptorSet VulkanDescriptorPool::allocateSet()
 {
     // Safe guard access to internal resources across threads.
-    m_spinLock.Lock();
+    LockGuard<AdaptiveMutex> lock(m_lock);
 
     // Find the next pool to allocate from.
     while(true)
@@ -83,9 +83,6 @@ VkDescriptorSet VulkanDescriptorPool::allocateSet()
         ++m_currentAllocationPoolIndex;
     }
 
-    // Increment allocated set count for given pool.
-    ++m_allocatedSets[m_currentAllocationPoolIndex];
-
     // Allocate a new descriptor set from the current pool index.
     VkDescriptorSetLayout setLayout = m_layout->getHandle();
 
@@ -99,13 +96,13 @@ VkDescriptorSet VulkanDescriptorPool::allocateSet()
     if(result != VK_SUCCESS)
         return VK_NULL_HANDLE;
 
+    // Increment allocated set count for given pool.
+    ++m_allocatedSets[m_currentAllocationPoolIndex];
+
     // Store an internal mapping between the descriptor set handle and it's parent pool.
     // This is used when FreeDescriptorSet is called downstream.
     m_allocatedDescriptorSets.emplace(handle, m_currentAllocationPoolIndex);
 
-    // Unlock access to internal resources.
-    m_spinLock.Unlock();
-
     // Return descriptor set handle.
     return handle;
 }
@@ -113,7 +110,7 @@ VkDescriptorSet VulkanDescriptorPool::allocateSet()
 VkResult VulkanDescriptorPool::freeSet(VkDescriptorSet descriptorSet)
 {
     // Safe guard access to internal resources across threads.
-    m_spinLock.Lock();
+    LockGuard<AdaptiveMutex> lock(m_lock);
 
     // Get the index of the descriptor pool the descriptor set was allocated from.
     auto it = m_allocatedDescriptorSets.find(descriptorSet);
@@ -133,9 +130,6 @@ VkResult VulkanDescriptorPool::freeSet(VkDescriptorSet descriptorSet)
     // Set the next allocation to use this pool index.
     m_currentAllocationPoolIndex = poolIndex;
 
-    // Unlock access to internal resources.
-    m_spinLock.Unlock();
-
     // Return success.
     return VK_SUCCESS;
 }
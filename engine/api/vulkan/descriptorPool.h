@@ -28,7 +28,7 @@ private:
     uint32_t                                       m_currentAllocationPoolIndex = {};
     std::unordered_map<VkDescriptorSet, uint32_t>  m_allocatedDescriptorSets    = {};
     std::unordered_map<VkDescriptorType, uint32_t> m_descriptorTypeCounts       = {};
-    SpinLock                                       m_spinLock                   = {};
+    AdaptiveMutex                                  m_lock                       = {};
 };
 }  // namespace aph
 
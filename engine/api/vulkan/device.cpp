@@ -1,4 +1,5 @@
 #include "device.h"
+#include "common/profiler.h"
 
 namespace aph
 {
@@ -13,6 +14,12 @@ namespace aph
         if(res != VK_SUCCESS) { return res; } \
     }
 
+#define VK_CO_CHECK_RESULT(f) \
+    { \
+        VkResult res = (f); \
+        if(res != VK_SUCCESS) { co_return res; } \
+    }
+
 VulkanDevice::VulkanDevice(const DeviceCreateInfo& createInfo, VulkanPhysicalDevice* pPhysicalDevice, VkDevice handle) :
     m_physicalDevice(pPhysicalDevice)
 {
@@ -101,6 +108,7 @@ VkResult VulkanDevice::Create(const DeviceCreateInfo& createInfo, VulkanDevice**
     // Initialize Device class.
     auto* device                = new VulkanDevice(createInfo, physicalDevice, handle);
     device->m_supportedFeatures = supportedFeatures;
+    device->m_fenceWaiter       = std::make_unique<VulkanFenceWaiter>(handle);
 
     // Get handles to all of the previously enumerated and created queues.
     device->m_queues.resize(queueFamilyCount);
@@ -125,10 +133,27 @@ VkResult VulkanDevice::Create(const DeviceCreateInfo& createInfo, VulkanDevice**
 
 void VulkanDevice::Destroy(VulkanDevice* pDevice)
 {
+    // Let every submission complete, so the waiter finishes its pending waits while the device is still alive.
+    vkDeviceWaitIdle(pDevice->m_handle);
+    pDevice->m_fenceWaiter.reset();
+
     for(auto& [_, commandpool] : pDevice->m_commandPools)
     {
         pDevice->destroyCommandPool(commandpool);
     }
+    for(auto& [thread, pools] : pDevice->m_singleCommandPools)
+    {
+        for(auto& [queueFamilyIndex, pool] : pools)
+        {
+            pool->available.insert(pool->available.end(), pool->retired.begin(), pool->retired.end());
+            for(const auto& commands : pool->available)
+            {
+                delete commands.pCmd;
+                vkDestroyFence(pDevice->m_handle, commands.fence, nullptr);
+            }
+            pDevice->destroyCommandPool(pool->pPool);
+        }
+    }
 
     if(pDevice->m_handle) { vkDestroyDevice(pDevice->m_handle, nullptr); }
     delete pDevice;
@@ -187,25 +212,129 @@ VkResult VulkanDevice::createImageView(const ImageViewCreateInfo& createInfo,
 VkResult VulkanDevice::executeSingleCommands(QueueTypeFlags                                               type,
                                              const std::function<void(VulkanCommandBuffer* pCmdBuffer)>&& func)
 {
-    VulkanCommandBuffer* cmd = nullptr;
-    VK_CHECK_RESULT(allocateCommandBuffers(1, &cmd, getQueueByFlags(type)));
+    APH_PROFILE_FUNCTION();
+    SingleCommandPool* pool     = nullptr;
+    SingleCommands     commands = {};
+
+    // Only wait for our own submission, not for everything else in flight on the queue.
+    VkResult result = submitSingleCommands(type, func, &pool, &commands);
+    if(result == VK_SUCCESS) { result = vkWaitForFences(getHandle(), 1, &commands.fence, VK_TRUE, UINT64_MAX); }
+
+    releaseSingleCommands(pool, commands);
+    return result;
+}
+
+Task<VkResult> VulkanDevice::executeSingleCommandsAsync(QueueTypeFlags                                        type,
+                                                        std::function<void(VulkanCommandBuffer* pCmdBuffer)> func)
+{
+    SingleCommandPool* pool     = nullptr;
+    SingleCommands     commands = {};
 
-    VK_CHECK_RESULT(cmd->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT));
-    func(cmd);
-    VK_CHECK_RESULT(cmd->end());
+    VkResult result = submitSingleCommands(type, func, &pool, &commands);
+    if(result == VK_SUCCESS) { result = co_await m_fenceWaiter->wait(commands.fence); }
 
-    uint32_t queueFamilyIndex = getQueueByFlags(type)->getFamilyIndex();
-    auto&    queue            = m_queues[queueFamilyIndex][0];
+    releaseSingleCommands(pool, commands);
+    co_return result;
+}
 
-    QueueSubmitInfo submitInfo{.commandBuffers = {cmd}};
-    VK_CHECK_RESULT(queue->submit({submitInfo}, VK_NULL_HANDLE));
-    VK_CHECK_RESULT(queue->waitIdle());
+VkResult VulkanDevice::getSingleCommandPool(uint32_t queueFamilyIndex, SingleCommandPool** ppPool)
+{
+    LockGuard<AdaptiveMutex> lock(m_singleCommandPoolsLock);
 
-    freeCommandBuffers(1, &cmd);
+    auto& pool = m_singleCommandPools[std::this_thread::get_id()][queueFamilyIndex];
+    if(!pool)
+    {
+        CommandPoolCreateInfo createInfo{
+            .queueFamilyIndex = queueFamilyIndex,
+            .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        };
+        VulkanCommandPool* pCommandPool = nullptr;
+        VK_CHECK_RESULT(createCommandPool(createInfo, &pCommandPool));
+        pool        = std::make_unique<SingleCommandPool>();
+        pool->pPool = pCommandPool;
+    }
 
+    *ppPool = pool.get();
     return VK_SUCCESS;
 }
 
+VkResult VulkanDevice::submitSingleCommands(QueueTypeFlags                                              type,
+                                            const std::function<void(VulkanCommandBuffer* pCmdBuffer)>& func,
+                                            SingleCommandPool** ppPool, SingleCommands* pCommands)
+{
+    uint32_t           queueFamilyIndex = getQueueByFlags(type)->getFamilyIndex();
+    SingleCommandPool* pool             = nullptr;
+    VK_CHECK_RESULT(getSingleCommandPool(queueFamilyIndex, &pool));
+
+    // Take back what finished executing meanwhile, wherever it was released from.
+    {
+        LockGuard<AdaptiveMutex> lock(pool->retiredLock);
+        pool->available.insert(pool->available.end(), pool->retired.begin(), pool->retired.end());
+        pool->retired.clear();
+    }
+
+    SingleCommands commands = {};
+    if(!pool->available.empty())
+    {
+        commands = pool->available.back();
+        pool->available.pop_back();
+    }
+    else
+    {
+        VkFenceCreateInfo fenceInfo = aph::init::fenceCreateInfo();
+        VK_CHECK_RESULT(vkCreateFence(getHandle(), &fenceInfo, nullptr, &commands.fence));
+
+        VkCommandBuffer handle = VK_NULL_HANDLE;
+        VkResult        result = pool->pPool->allocateCommandBuffers(1, &handle);
+        if(result != VK_SUCCESS)
+        {
+            vkDestroyFence(getHandle(), commands.fence, nullptr);
+            return result;
+        }
+        commands.pCmd = new VulkanCommandBuffer(pool->pPool, handle, queueFamilyIndex);
+    }
+
+    // Handed out before recording, the caller gives them back whatever happens next.
+    *ppPool    = pool;
+    *pCommands = commands;
+
+    // The pool resets the buffer when recording begins again.
+    VK_CHECK_RESULT(commands.pCmd->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT));
+    func(commands.pCmd);
+    VK_CHECK_RESULT(commands.pCmd->end());
+
+    QueueSubmitInfo submitInfo{.commandBuffers = {commands.pCmd}};
+    return m_queues[queueFamilyIndex][0]->submit({ &submitInfo, 1 }, commands.fence);
+}
+
+void VulkanDevice::releaseSingleCommands(SingleCommandPool* pPool, const SingleCommands& commands)
+{
+    if(!pPool)
+    {
+        return;
+    }
+
+    // Only the fence is touched here, the command buffer is reset by the thread owning the pool.
+    vkResetFences(getHandle(), 1, &commands.fence);
+    LockGuard<AdaptiveMutex> lock(pPool->retiredLock);
+    pPool->retired.push_back(commands);
+}
+
+void VulkanDevice::trackMemory(VkDeviceSize size, bool allocated)
+{
+    if(!allocated)
+    {
+        m_allocatedMemory.fetch_sub(size, std::memory_order_relaxed);
+        return;
+    }
+
+    VkDeviceSize current = m_allocatedMemory.fetch_add(size, std::memory_order_relaxed) + size;
+    VkDeviceSize peak    = m_peakMemory.load(std::memory_order_relaxed);
+    while(current > peak && !m_peakMemory.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+    {
+    }
+}
+
 VkResult VulkanDevice::createBuffer(const BufferCreateInfo& createInfo,
                                     VulkanBuffer**          ppBuffer,
                                     const void*             data,
@@ -262,6 +391,7 @@ VkResult VulkanDevice::createBuffer(const BufferCreateInfo& createInfo,
         VK_CHECK_RESULT(vkAllocateMemory(m_handle, &allocInfo, nullptr, &memory));
     }
 
+    trackMemory(memRequirements.memoryRequirements.size, true);
     *ppBuffer = new VulkanBuffer(createInfo, buffer, memory);
 
     // bind buffer and memory
@@ -344,6 +474,7 @@ VkResult VulkanDevice::createImage(const ImageCreateInfo& createInfo, VulkanImag
         VK_CHECK_RESULT(vkAllocateMemory(m_handle, &allocInfo, nullptr, &memory));
     }
 
+    trackMemory(memRequirements.memoryRequirements.size, true);
     *ppImage = new VulkanImage(this, createInfo, image, memory);
 
     if((*ppImage)->getMemory() != VK_NULL_HANDLE) { VK_CHECK_RESULT(bindMemory(*ppImage)); }
@@ -355,7 +486,13 @@ VulkanPhysicalDevice* VulkanDevice::getPhysicalDevice() const { return m_physica
 
 void VulkanDevice::destroyBuffer(VulkanBuffer* pBuffer)
 {
-    if(pBuffer->getMemory() != VK_NULL_HANDLE) { vkFreeMemory(m_handle, pBuffer->getMemory(), nullptr); }
+    if(pBuffer->getMemory() != VK_NULL_HANDLE)
+    {
+        VkMemoryRequirements memRequirements;
+        vkGetBufferMemoryRequirements(m_handle, pBuffer->getHandle(), &memRequirements);
+        trackMemory(memRequirements.size, false);
+        vkFreeMemory(m_handle, pBuffer->getMemory(), nullptr);
+    }
     vkDestroyBuffer(m_handle, pBuffer->getHandle(), nullptr);
     delete pBuffer;
     pBuffer = nullptr;
@@ -363,7 +500,13 @@ void VulkanDevice::destroyBuffer(VulkanBuffer* pBuffer)
 
 void VulkanDevice::destroyImage(VulkanImage* pImage)
 {
-    if(pImage->getMemory() != VK_NULL_HANDLE) { vkFreeMemory(m_handle, pImage->getMemory(), nullptr); }
+    if(pImage->getMemory() != VK_NULL_HANDLE)
+    {
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(m_handle, pImage->getHandle(), &memRequirements);
+        trackMemory(memRequirements.size, false);
+        vkFreeMemory(m_handle, pImage->getMemory(), nullptr);
+    }
     vkDestroyImage(m_handle, pImage->getHandle(), nullptr);
     delete pImage;
     pImage = nullptr;
@@ -384,7 +527,10 @@ VkResult VulkanDevice::createSwapchain(const SwapChainCreateInfo& createInfo, Vu
 
 void VulkanDevice::destroySwapchain(VulkanSwapChain* pSwapchain)
 {
-    vkDestroySwapchainKHR(getHandle(), pSwapchain->getHandle(), nullptr);
+    if(!pSwapchain->isHeadless())
+    {
+        vkDestroySwapchainKHR(getHandle(), pSwapchain->getHandle(), nullptr);
+    }
     delete pSwapchain;
     pSwapchain = nullptr;
 }
@@ -571,7 +717,7 @@ VkResult VulkanDevice::createComputePipeline(const ComputePipelineCreateInfo& cr
     return VK_SUCCESS;
 }
 
-VkResult VulkanDevice::waitForFence(const std::vector<VkFence>& fences, bool waitAll, uint32_t timeout)
+VkResult VulkanDevice::waitForFence(std::span<const VkFence> fences, bool waitAll, uint32_t timeout)
 {
     return vkWaitForFences(getHandle(), fences.size(), fences.data(), VK_TRUE, UINT64_MAX);
 }
@@ -579,6 +725,14 @@ VkResult VulkanDevice::waitForFence(const std::vector<VkFence>& fences, bool wai
 VkResult VulkanDevice::createDeviceLocalBuffer(const BufferCreateInfo& createInfo,
                                                VulkanBuffer**          ppBuffer,
                                                const void*             data)
+{
+    APH_PROFILE_FUNCTION();
+    return syncWait(createDeviceLocalBufferAsync(createInfo, ppBuffer, data));
+}
+
+Task<VkResult> VulkanDevice::createDeviceLocalBufferAsync(BufferCreateInfo createInfo,
+                                                          VulkanBuffer**   ppBuffer,
+                                                          const void*      data)
 {
     // using staging buffer
     aph::VulkanBuffer* stagingBuffer{};
@@ -588,7 +742,7 @@ VkResult VulkanDevice::createDeviceLocalBuffer(const BufferCreateInfo& createInf
             .usage    = BUFFER_USAGE_TRANSFER_SRC_BIT,
             .property = MEMORY_PROPERTY_HOST_VISIBLE_BIT | MEMORY_PROPERTY_HOST_COHERENT_BIT,
         };
-        VK_CHECK_RESULT(createBuffer(stagingCI, &stagingBuffer, data));
+        VK_CO_CHECK_RESULT(createBuffer(stagingCI, &stagingBuffer, data));
     }
 
     VulkanBuffer* buffer = nullptr;
@@ -596,33 +750,41 @@ VkResult VulkanDevice::createDeviceLocalBuffer(const BufferCreateInfo& createInf
         auto bufferCI = createInfo;
         bufferCI.property |= MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
         bufferCI.usage |= BUFFER_USAGE_TRANSFER_DST_BIT;
-        VK_CHECK_RESULT(createBuffer(bufferCI, &buffer));
+        VK_CO_CHECK_RESULT(createBuffer(bufferCI, &buffer));
     }
 
-    executeSingleCommands(QUEUE_GRAPHICS,
-                          [&](VulkanCommandBuffer* cmd) { cmd->copyBuffer(stagingBuffer, buffer, createInfo.size); });
+    VkResult result = co_await executeSingleCommandsAsync(
+        QUEUE_GRAPHICS, [&](VulkanCommandBuffer* cmd) { cmd->copyBuffer(stagingBuffer, buffer, createInfo.size); });
     *ppBuffer = buffer;
     destroyBuffer(stagingBuffer);
-    return VK_SUCCESS;
-};
+    co_return result;
+}
 
 VkResult VulkanDevice::createDeviceLocalImage(const ImageCreateInfo&      createInfo,
                                               VulkanImage**               ppImage,
                                               const std::vector<uint8_t>& data)
+{
+    APH_PROFILE_FUNCTION();
+    return syncWait(createDeviceLocalImageAsync(createInfo, ppImage, data));
+}
+
+Task<VkResult> VulkanDevice::createDeviceLocalImageAsync(ImageCreateInfo          createInfo,
+                                                         VulkanImage**            ppImage,
+                                                         std::span<const uint8_t> data)
 {
     bool           genMipmap = createInfo.mipLevels > 1;
     const uint32_t width     = createInfo.extent.width;
     const uint32_t height    = createInfo.extent.height;
 
     // Load texture from image buffer
-    VulkanBuffer* stagingBuffer;
+    VulkanBuffer* stagingBuffer{};
     {
         BufferCreateInfo bufferCI{
             .size     = static_cast<uint32_t>(data.size()),
             .usage    = BUFFER_USAGE_TRANSFER_SRC_BIT,
             .property = MEMORY_PROPERTY_HOST_VISIBLE_BIT | MEMORY_PROPERTY_HOST_COHERENT_BIT,
         };
-        createBuffer(bufferCI, &stagingBuffer, data.data());
+        VK_CO_CHECK_RESULT(createBuffer(bufferCI, &stagingBuffer, data.data()));
     }
 
     VulkanImage* texture{};
@@ -632,9 +794,9 @@ VkResult VulkanDevice::createDeviceLocalImage(const ImageCreateInfo&      create
         imageCI.usage |= IMAGE_USAGE_TRANSFER_DST_BIT;
         if(genMipmap) { imageCI.usage |= BUFFER_USAGE_TRANSFER_SRC_BIT; }
 
-        VK_CHECK_RESULT(createImage(imageCI, &texture));
+        VK_CO_CHECK_RESULT(createImage(imageCI, &texture));
 
-        executeSingleCommands(QUEUE_GRAPHICS, [&](VulkanCommandBuffer* cmd) {
+        VK_CO_CHECK_RESULT(co_await executeSingleCommandsAsync(QUEUE_GRAPHICS, [&](VulkanCommandBuffer* cmd) {
             cmd->transitionImageLayout(texture, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
             cmd->copyBufferToImage(stagingBuffer, texture);
             if(genMipmap)
@@ -642,9 +804,9 @@ VkResult VulkanDevice::createDeviceLocalImage(const ImageCreateInfo&      create
                 cmd->transitionImageLayout(texture, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
             }
-        });
+        }));
 
-        executeSingleCommands(QUEUE_GRAPHICS, [&](VulkanCommandBuffer* cmd) {
+        VK_CO_CHECK_RESULT(co_await executeSingleCommandsAsync(QUEUE_GRAPHICS, [&](VulkanCommandBuffer* cmd) {
             if(genMipmap)
             {
                 // generate mipmap chains
@@ -698,13 +860,13 @@ VkResult VulkanDevice::createDeviceLocalImage(const ImageCreateInfo&      create
                 cmd->transitionImageLayout(texture, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
             }
-        });
+        }));
     }
 
     destroyBuffer(stagingBuffer);
     *ppImage = texture;
 
-    return VK_SUCCESS;
+    co_return VK_SUCCESS;
 }
 VkResult VulkanDevice::flushMemory(VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size)
 {
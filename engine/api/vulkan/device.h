@@ -6,6 +6,7 @@
 #include "commandPool.h"
 #include "descriptorPool.h"
 #include "descriptorSetLayout.h"
+#include "fenceWaiter.h"
 #include "image.h"
 #include "physicalDevice.h"
 #include "pipeline.h"
@@ -45,11 +46,20 @@ public:
 public:
     VkResult createCubeMap(const std::array<std::shared_ptr<ImageInfo>, 6>& images, VulkanImage** ppImage,
                            VulkanImageView** ppImageView);
+    // Block on the async versions below, so they must not be called from a task of the default pool.
     VkResult createDeviceLocalBuffer(const BufferCreateInfo& createInfo, VulkanBuffer** ppBuffer, const void* data);
     VkResult createDeviceLocalImage(const ImageCreateInfo& createInfo, VulkanImage** ppImage,
                                     const std::vector<uint8_t>& data);
-    VkResult executeSingleCommands(QueueTypeFlags                                               type,
-                                   const std::function<void(VulkanCommandBuffer* pCmdBuffer)>&& func);
+    // Upload through a staging buffer without blocking a thread on the GPU, several can be in flight at once.
+    // data must stay valid until the task finished.
+    Task<VkResult> createDeviceLocalBufferAsync(BufferCreateInfo createInfo, VulkanBuffer** ppBuffer, const void* data);
+    Task<VkResult> createDeviceLocalImageAsync(ImageCreateInfo createInfo, VulkanImage** ppImage,
+                                               std::span<const uint8_t> data);
+    VkResult       executeSingleCommands(QueueTypeFlags                                               type,
+                                         const std::function<void(VulkanCommandBuffer* pCmdBuffer)>&& func);
+    // Records and submits like executeSingleCommands() from any thread, the task finishes once the GPU is done.
+    Task<VkResult> executeSingleCommandsAsync(QueueTypeFlags                                        type,
+                                              std::function<void(VulkanCommandBuffer* pCmdBuffer)> func);
 
 public:
     VkResult createBuffer(const BufferCreateInfo& createInfo, VulkanBuffer** ppBuffer, const void* data = nullptr,
@@ -91,16 +101,54 @@ public:
     void               freeCommandBuffers(uint32_t commandBufferCount, VulkanCommandBuffer** ppCommandBuffers);
 
     VkResult waitIdle();
-    VkResult waitForFence(const std::vector<VkFence>& fences, bool waitAll = true, uint32_t timeout = UINT32_MAX);
+    VkResult waitForFence(std::span<const VkFence> fences, bool waitAll = true, uint32_t timeout = UINT32_MAX);
+    VulkanFenceWaiter*       getFenceWaiter() const { return m_fenceWaiter.get(); }
     VulkanPhysicalDevice*    getPhysicalDevice() const;
     VkFormat                 getDepthFormat() const;
     VkPhysicalDeviceFeatures getFeatures() const { return m_supportedFeatures; }
 
+    // Device memory held by buffers and images created through this device, and the most it ever held.
+    VkDeviceSize getAllocatedMemorySize() const { return m_allocatedMemory.load(std::memory_order_relaxed); }
+    VkDeviceSize getPeakMemorySize() const { return m_peakMemory.load(std::memory_order_relaxed); }
+
+private:
+    struct SingleCommands
+    {
+        VulkanCommandBuffer* pCmd  = {};
+        VkFence              fence = {};
+    };
+
+    // Single-use command buffers are recorded from a pool of the calling thread, so recording takes no lock and never
+    // touches the pools frames are recorded from. Once executed they are handed back to the owning thread, which
+    // reuses them with their fence on its next submission; the pool itself is never externally shared.
+    struct SingleCommandPool
+    {
+        VulkanCommandPool*          pPool       = {};
+        std::vector<SingleCommands> available   = {};
+        AdaptiveMutex               retiredLock = {};
+        std::vector<SingleCommands> retired     = {};
+    };
+
+    VkResult getSingleCommandPool(uint32_t queueFamilyIndex, SingleCommandPool** ppPool);
+    VkResult submitSingleCommands(QueueTypeFlags type, const std::function<void(VulkanCommandBuffer* pCmdBuffer)>& func,
+                                  SingleCommandPool** ppPool, SingleCommands* pCommands);
+    void     releaseSingleCommands(SingleCommandPool* pPool, const SingleCommands& commands);
+    void     trackMemory(VkDeviceSize size, bool allocated);
+
 private:
-    VkPhysicalDeviceFeatures m_supportedFeatures{};
-    VulkanPhysicalDevice*    m_physicalDevice{};
-    std::vector<QueueFamily> m_queues;
-    QueueFamilyCommandPools  m_commandPools;
+    VkPhysicalDeviceFeatures           m_supportedFeatures{};
+    VulkanPhysicalDevice*              m_physicalDevice{};
+    std::vector<QueueFamily>           m_queues;
+    QueueFamilyCommandPools            m_commandPools;
+    std::unique_ptr<VulkanFenceWaiter> m_fenceWaiter;
+
+    // Per thread and queue family, pools of threads that exited stay around until the device is destroyed.
+    using SingleCommandPools = std::unordered_map<uint32_t, std::unique_ptr<SingleCommandPool>>;
+    AdaptiveMutex                                           m_singleCommandPoolsLock;
+    std::unordered_map<std::thread::id, SingleCommandPools> m_singleCommandPools;
+
+    std::atomic<VkDeviceSize> m_allocatedMemory = { 0 };
+    std::atomic<VkDeviceSize> m_peakMemory      = { 0 };
 };
 
 }  // namespace aph
@@ -0,0 +1,134 @@
+#include "fenceWaiter.h"
+
+namespace aph
+{
+namespace
+{
+// Upper bound on how long a newly added wait goes unnoticed while the thread is blocked in the driver.
+constexpr uint64_t FENCE_WAIT_TIMEOUT_NS = 1000 * 1000;
+constexpr auto     SEMAPHORE_POLL_PERIOD = std::chrono::microseconds(250);
+}  // namespace
+
+VulkanFenceWaiter::VulkanFenceWaiter(VkDevice device, ThreadPool* pPool) : m_device(device), m_pPool(pPool)
+{
+    m_thread = std::thread([this]() { threadLoop(); });
+}
+
+VulkanFenceWaiter::~VulkanFenceWaiter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+
+    // Resumed coroutines may release their resources and submit again, so keep draining until nothing is left in
+    // flight. Whatever they still submit is waited on here, the device is destroyed once this returns.
+    std::vector<Entry> remaining;
+    while(true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            remaining.swap(m_pending);
+        }
+        for(const auto& entry : remaining)
+        {
+            VkResult result = entry.fence ? vkWaitForFences(m_device, 1, &entry.fence, VK_TRUE, UINT64_MAX) :
+                                            poll(entry);
+            *entry.pResult  = result == VK_NOT_READY ? VK_INCOMPLETE : result;
+            entry.handle.resume();
+        }
+        remaining.clear();
+
+        // A coroutine resumed on the pool has either finished or added its next wait once its task returned.
+        m_pPool->Wait(m_resumeGroup);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_pending.empty())
+            break;
+    }
+}
+
+VkResult VulkanFenceWaiter::poll(const Entry& entry) const
+{
+    if(entry.fence)
+    {
+        return vkGetFenceStatus(m_device, entry.fence);
+    }
+
+    uint64_t value  = 0;
+    VkResult result = vkGetSemaphoreCounterValue(m_device, entry.semaphore, &value);
+    if(result != VK_SUCCESS)
+        return result;
+    return value >= entry.value ? VK_SUCCESS : VK_NOT_READY;
+}
+
+void VulkanFenceWaiter::add(const Entry& entry)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(entry);
+        // Once stopping, the destructor picks it up instead of the thread.
+        if(m_stop)
+            return;
+    }
+    m_condition.notify_one();
+}
+
+void VulkanFenceWaiter::resume(const Entry& entry, VkResult result)
+{
+    *entry.pResult = result;
+    m_pPool->AddTask([handle = entry.handle]() { handle.resume(); }, &m_resumeGroup);
+}
+
+void VulkanFenceWaiter::threadLoop()
+{
+    std::vector<Entry>   polling;
+    std::vector<VkFence> fences;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if(polling.empty())
+            {
+                m_condition.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+            }
+            if(m_stop)
+            {
+                m_pending.insert(m_pending.end(), polling.begin(), polling.end());
+                return;
+            }
+            polling.insert(polling.end(), m_pending.begin(), m_pending.end());
+            m_pending.clear();
+        }
+
+        // Resume everything that completed, keep the rest for the next round.
+        fences.clear();
+        auto it = std::remove_if(polling.begin(), polling.end(), [&](const Entry& entry) {
+            VkResult result = poll(entry);
+            if(result == VK_NOT_READY)
+            {
+                if(entry.fence)
+                    fences.push_back(entry.fence);
+                return false;
+            }
+            resume(entry, result);
+            return true;
+        });
+        polling.erase(it, polling.end());
+
+        // Block in the driver until any fence signals, semaphores alone are polled periodically.
+        if(!fences.empty())
+        {
+            vkWaitForFences(m_device, static_cast<uint32_t>(fences.size()), fences.data(), VK_FALSE,
+                            FENCE_WAIT_TIMEOUT_NS);
+        }
+        else if(!polling.empty())
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock, SEMAPHORE_POLL_PERIOD, [this]() { return m_stop || !m_pending.empty(); });
+        }
+    }
+}
+}  // namespace aph
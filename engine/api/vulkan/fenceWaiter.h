@@ -0,0 +1,82 @@
+#ifndef FENCEWAITER_H_
+#define FENCEWAITER_H_
+
+#include "common/task.h"
+#include "vkUtils.h"
+
+namespace aph
+{
+// Dedicated thread polling fences and timeline semaphores on behalf of suspended coroutines. Once the GPU signals,
+// the waiting coroutine is resumed on the thread pool, so no engine thread ever blocks in vkWaitForFences.
+class VulkanFenceWaiter
+{
+public:
+    VulkanFenceWaiter(VkDevice device, ThreadPool* pPool = ThreadPool::GetDefault());
+
+    // Finishes every pending wait on the calling thread before returning, including the waits the resumed coroutines
+    // add meanwhile, so it must run while the device is still alive and after the GPU went idle. A timeline value
+    // that is not reached by then is cancelled with VK_INCOMPLETE.
+    ~VulkanFenceWaiter();
+
+    VulkanFenceWaiter(const VulkanFenceWaiter&)            = delete;
+    VulkanFenceWaiter& operator=(const VulkanFenceWaiter&) = delete;
+
+private:
+    struct Entry
+    {
+        VkFence                 fence     = {};
+        VkSemaphore             semaphore = {};
+        uint64_t                value     = {};
+        std::coroutine_handle<> handle    = {};
+        VkResult*               pResult   = {};
+    };
+
+public:
+    class Awaiter
+    {
+    public:
+        Awaiter(VulkanFenceWaiter* pWaiter, Entry entry) : m_pWaiter(pWaiter), m_entry(entry) {}
+
+        bool await_ready() { return (m_result = m_pWaiter->poll(m_entry)) != VK_NOT_READY; }
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_entry.handle  = handle;
+            m_entry.pResult = &m_result;
+            m_pWaiter->add(m_entry);
+        }
+        VkResult await_resume() const { return m_result; }
+
+    private:
+        VulkanFenceWaiter* m_pWaiter = {};
+        Entry              m_entry   = {};
+        VkResult           m_result  = VK_NOT_READY;
+    };
+
+    // co_await yields VK_SUCCESS once the fence is signaled, or the error vkGetFenceStatus reported.
+    Awaiter wait(VkFence fence) { return { this, { .fence = fence } }; }
+    // co_await yields VK_SUCCESS once the timeline semaphore reached value.
+    Awaiter wait(VkSemaphore timelineSemaphore, uint64_t value)
+    {
+        return { this, { .semaphore = timelineSemaphore, .value = value } };
+    }
+
+private:
+    VkResult poll(const Entry& entry) const;
+    void     add(const Entry& entry);
+    void     resume(const Entry& entry, VkResult result);
+    void     threadLoop();
+
+private:
+    VkDevice                m_device = {};
+    ThreadPool*             m_pPool  = {};
+    std::thread             m_thread;
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    std::vector<Entry>      m_pending = {};
+    bool                    m_stop    = false;
+    // Resumptions handed to the pool, the destructor waits for them.
+    WaitGroup               m_resumeGroup;
+};
+}  // namespace aph
+
+#endif  // FENCEWAITER_H_
@@ -0,0 +1,138 @@
+#include "gpuProfiler.h"
+#include "commandBuffer.h"
+#include "device.h"
+#include "common/profiler.h"
+
+namespace aph
+{
+VulkanGpuProfiler::VulkanGpuProfiler(VulkanDevice* pDevice, VulkanQueue* pQueue, uint32_t frameCount) :
+    m_pDevice(pDevice),
+    m_timestampPeriod(pDevice->getPhysicalDevice()->getProperties().limits.timestampPeriod)
+{
+    uint32_t validBits = pQueue->getTimestampValidBits();
+    if(validBits == 0)
+    {
+        return;
+    }
+    m_validBitsMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+    m_track         = Profiler::CreateTrack("GPU");
+
+    m_frames.resize(frameCount);
+    for(auto& frame : m_frames)
+    {
+        VkQueryPoolCreateInfo createInfo{
+            .sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .queryType  = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount = MAX_SCOPES_PER_FRAME * 2,
+        };
+        VK_CHECK_RESULT(vkCreateQueryPool(m_pDevice->getHandle(), &createInfo, nullptr, &frame.pool));
+        frame.scopes.reserve(MAX_SCOPES_PER_FRAME);
+    }
+    m_results.resize(MAX_SCOPES_PER_FRAME * 2);
+}
+
+VulkanGpuProfiler::~VulkanGpuProfiler()
+{
+    for(auto& frame : m_frames)
+    {
+        vkDestroyQueryPool(m_pDevice->getHandle(), frame.pool, nullptr);
+    }
+}
+
+void VulkanGpuProfiler::beginFrame(VulkanCommandBuffer* pCmd, uint32_t frameIdx)
+{
+    if(!isSupported())
+    {
+        return;
+    }
+
+    m_pCurrent = &m_frames[frameIdx];
+    if(m_pCurrent->hasResults)
+    {
+        resolve(*m_pCurrent);
+    }
+
+    m_pCurrent->scopes.clear();
+    m_pCurrent->hasResults = false;
+    m_depth                = 0;
+    pCmd->resetQueryPool(m_pCurrent->pool, 0, MAX_SCOPES_PER_FRAME * 2);
+    m_frameScope = beginScope(pCmd, "GPU frame");
+}
+
+void VulkanGpuProfiler::endFrame(VulkanCommandBuffer* pCmd)
+{
+    if(!m_pCurrent)
+    {
+        return;
+    }
+
+    endScope(pCmd, m_frameScope);
+    assert(m_depth == 0);
+    m_pCurrent->submitNs   = Profiler::GetTimeNs();
+    m_pCurrent->hasResults = true;
+    m_pCurrent             = nullptr;
+}
+
+uint32_t VulkanGpuProfiler::beginScope(VulkanCommandBuffer* pCmd, const char* name)
+{
+    if(!m_pCurrent || m_pCurrent->scopes.size() >= MAX_SCOPES_PER_FRAME)
+    {
+        return UINT32_MAX;
+    }
+
+    auto scope = static_cast<uint32_t>(m_pCurrent->scopes.size());
+    m_pCurrent->scopes.push_back({ name, m_depth++ });
+    pCmd->writeTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_pCurrent->pool, scope * 2);
+    return scope;
+}
+
+void VulkanGpuProfiler::endScope(VulkanCommandBuffer* pCmd, uint32_t scope)
+{
+    if(!m_pCurrent || scope == UINT32_MAX)
+    {
+        return;
+    }
+
+    --m_depth;
+    pCmd->writeTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_pCurrent->pool, scope * 2 + 1);
+}
+
+void VulkanGpuProfiler::resolve(Frame& frame)
+{
+    auto queryCount = static_cast<uint32_t>(frame.scopes.size() * 2);
+    if(queryCount == 0)
+    {
+        return;
+    }
+
+    // The frame's fence already signalled, a frame the GPU somehow has not finished is skipped rather than waited on.
+    VkResult result = vkGetQueryPoolResults(m_pDevice->getHandle(), frame.pool, 0, queryCount,
+                                            queryCount * sizeof(uint64_t), m_results.data(), sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+    if(result != VK_SUCCESS)
+    {
+        return;
+    }
+
+    auto toMs = [this](uint64_t ticks) {
+        return static_cast<double>(ticks & m_validBitsMask) * m_timestampPeriod / 1e6;
+    };
+
+    // The GPU clock is not calibrated against the CPU one, the frame is placed on the CPU timeline at its submission.
+    uint64_t frameStart = m_results[0];
+    m_lastFrame.clear();
+    for(uint32_t idx = 0; idx < frame.scopes.size(); idx++)
+    {
+        const auto& scope = frame.scopes[idx];
+        double      start = toMs(m_results[idx * 2] - frameStart);
+        double      end   = toMs(m_results[idx * 2 + 1] - frameStart);
+        m_lastFrame.push_back({ scope.name, start, end - start, scope.depth });
+
+        uint64_t startNs = frame.submitNs + static_cast<uint64_t>(start * 1e6);
+        Profiler::RecordTrackZone(m_track, scope.name, startNs, startNs + static_cast<uint64_t>((end - start) * 1e6),
+                                  scope.depth);
+    }
+    m_lastFrameTimeMs = m_lastFrame.front().durationMs;
+    ++m_resolvedFrameCount;
+}
+}  // namespace aph
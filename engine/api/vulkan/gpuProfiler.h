@@ -0,0 +1,108 @@
+#ifndef GPU_PROFILER_H_
+#define GPU_PROFILER_H_
+
+#include "vkUtils.h"
+
+namespace aph
+{
+class VulkanDevice;
+class VulkanQueue;
+class VulkanCommandBuffer;
+
+struct GpuProfileZone
+{
+    const char* name       = {};
+    double      startMs    = {};
+    double      durationMs = {};
+    uint32_t    depth      = {};
+};
+
+// Timestamp queries around named scopes of a frame's command buffer, one query pool per frame in flight.
+// A frame's results are read when its index comes around again, after the renderer waited on its fence, so reading
+// them never stalls. Resolved zones also go to the CPU Profiler on a "GPU" track, aligned to the frame's submission.
+class VulkanGpuProfiler
+{
+public:
+    static constexpr uint32_t MAX_SCOPES_PER_FRAME = 64;
+
+    VulkanGpuProfiler(VulkanDevice* pDevice, VulkanQueue* pQueue, uint32_t frameCount);
+    ~VulkanGpuProfiler();
+
+    // False if the queue family does not support timestamps, every call below is a no-op then.
+    bool isSupported() const { return m_validBitsMask != 0; }
+
+    // Resolves the results frameIdx produced last time and resets its queries, record right after pCmd->begin().
+    void beginFrame(VulkanCommandBuffer* pCmd, uint32_t frameIdx);
+    // Record right before pCmd->end(), the frame's scopes must all be closed.
+    void endFrame(VulkanCommandBuffer* pCmd);
+
+    // Returns the scope to pass to endScope(). Scopes nest and must be closed in reverse order.
+    uint32_t beginScope(VulkanCommandBuffer* pCmd, const char* name);
+    void     endScope(VulkanCommandBuffer* pCmd, uint32_t scope);
+
+    // The last resolved frame, in recording order. Times are relative to the start of that frame.
+    const std::vector<GpuProfileZone>& getLastFrameZones() const { return m_lastFrame; }
+    double                             getLastFrameTimeMs() const { return m_lastFrameTimeMs; }
+    // Increments every time a frame got resolved.
+    uint64_t                           getResolvedFrameCount() const { return m_resolvedFrameCount; }
+
+private:
+    struct Scope
+    {
+        const char* name;
+        uint32_t    depth;
+    };
+
+    // Scope i writes queries 2 * i (begin) and 2 * i + 1 (end).
+    struct Frame
+    {
+        VkQueryPool        pool       = {};
+        std::vector<Scope> scopes     = {};
+        uint64_t           submitNs   = {};
+        bool               hasResults = {};
+    };
+
+    void resolve(Frame& frame);
+
+    VulkanDevice*         m_pDevice         = {};
+    double                m_timestampPeriod = {};
+    uint64_t              m_validBitsMask   = {};
+    uint32_t              m_track           = {};
+    std::vector<Frame>    m_frames          = {};
+    Frame*                m_pCurrent        = {};
+    uint32_t              m_depth           = {};
+    uint32_t              m_frameScope      = {};
+    std::vector<uint64_t> m_results         = {};
+
+    std::vector<GpuProfileZone> m_lastFrame          = {};
+    double                      m_lastFrameTimeMs    = {};
+    uint64_t                    m_resolvedFrameCount = {};
+};
+
+// Times the enclosing scope on the GPU. pProfiler may be null.
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(VulkanGpuProfiler* pProfiler, VulkanCommandBuffer* pCmd, const char* name) :
+        m_pProfiler(pProfiler),
+        m_pCmd(pCmd),
+        m_scope(pProfiler ? pProfiler->beginScope(pCmd, name) : 0)
+    {
+    }
+    ~GpuProfileScope()
+    {
+        if(m_pProfiler)
+            m_pProfiler->endScope(m_pCmd, m_scope);
+    }
+
+    GpuProfileScope(const GpuProfileScope&)            = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    VulkanGpuProfiler*   m_pProfiler;
+    VulkanCommandBuffer* m_pCmd;
+    uint32_t             m_scope;
+};
+}  // namespace aph
+
+#endif  // GPU_PROFILER_H_
@@ -188,9 +188,8 @@ VkResult VulkanInstance::Create(const InstanceCreateInfo& createInfo, VulkanInst
         }
     }
 
-    // Initialize the Instance's thread pool with a single worker thread for now.
-    // TODO: Assess background tasks and performance before increasing thread count.
-    instance->m_threadPool = new ThreadPool(1);
+    // Share the engine-wide work-stealing pool, it is sized to the hardware thread count.
+    instance->m_threadPool = ThreadPool::GetDefault();
 
     // Copy address of object instance.
     *ppInstance = instance;
@@ -208,7 +207,7 @@ VkResult VulkanInstance::Create(const InstanceCreateInfo& createInfo, VulkanInst
 
 void VulkanInstance::Destroy(VulkanInstance* pInstance)
 {
-    delete pInstance->m_threadPool;
+    pInstance->m_threadPool->Wait();
     destroyDebugUtilsMessengerEXT(pInstance->getHandle(), pInstance->m_debugMessenger, nullptr);
     vkDestroyInstance(pInstance->getHandle(), nullptr);
 }
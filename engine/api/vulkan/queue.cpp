@@ -13,14 +13,27 @@ VulkanQueue::VulkanQueue(VkQueue queue, uint32_t queueFamilyIndex, uint32_t inde
     getHandle() = queue;
 }
 
-VkResult VulkanQueue::submit(const std::vector<QueueSubmitInfo>& submitInfos, VkFence fence)
+VkResult VulkanQueue::submit(std::span<const QueueSubmitInfo> submitInfos, VkFence fence)
 {
-    std::vector<VkSubmitInfo>    finalSubmits;
-    std::vector<VkCommandBuffer> cmds;
+    // Only spills to the heap for unusually large submissions.
+    std::array<std::byte, 1024>         stackBuffer;
+    std::pmr::monotonic_buffer_resource scratch(stackBuffer.data(), stackBuffer.size());
 
+    size_t cmdCount = 0;
     for(const auto& submitInfo : submitInfos)
     {
-        cmds.reserve(submitInfo.commandBuffers.size());
+        cmdCount += submitInfo.commandBuffers.size();
+    }
+
+    std::pmr::vector<VkSubmitInfo>    finalSubmits(&scratch);
+    std::pmr::vector<VkCommandBuffer> cmds(&scratch);
+    finalSubmits.reserve(submitInfos.size());
+    // Reserved up front, every VkSubmitInfo points into it.
+    cmds.reserve(cmdCount);
+
+    for(const auto& submitInfo : submitInfos)
+    {
+        VkCommandBuffer* pCmds = cmds.data() + cmds.size();
         for(auto* cmd : submitInfo.commandBuffers)
         {
             cmds.push_back(cmd->getHandle());
@@ -30,16 +43,29 @@ VkResult VulkanQueue::submit(const std::vector<QueueSubmitInfo>& submitInfos, Vk
             .waitSemaphoreCount   = static_cast<uint32_t>(submitInfo.waitSemaphores.size()),
             .pWaitSemaphores      = submitInfo.waitSemaphores.data(),
             .pWaitDstStageMask    = submitInfo.waitStages.data(),
-            .commandBufferCount   = static_cast<uint32_t>(cmds.size()),
-            .pCommandBuffers      = cmds.data(),
+            .commandBufferCount   = static_cast<uint32_t>(submitInfo.commandBuffers.size()),
+            .pCommandBuffers      = pCmds,
             .signalSemaphoreCount = static_cast<uint32_t>(submitInfo.signalSemaphores.size()),
             .pSignalSemaphores    = submitInfo.signalSemaphores.data(),
         };
         finalSubmits.push_back(info);
     }
 
-    VkResult result = vkQueueSubmit(getHandle(), finalSubmits.size(), finalSubmits.data(), fence);
+    LockGuard<AdaptiveMutex> lock(m_lock);
+    VkResult                 result = vkQueueSubmit(getHandle(), finalSubmits.size(), finalSubmits.data(), fence);
     return result;
 }
 
+VkResult VulkanQueue::waitIdle()
+{
+    LockGuard<AdaptiveMutex> lock(m_lock);
+    return vkQueueWaitIdle(getHandle());
+}
+
+VkResult VulkanQueue::present(const VkPresentInfoKHR& presentInfo)
+{
+    LockGuard<AdaptiveMutex> lock(m_lock);
+    return vkQueuePresentKHR(getHandle(), &presentInfo);
+}
+
 }  // namespace aph
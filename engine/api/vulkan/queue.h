@@ -1,6 +1,7 @@
 #ifndef QUEUE_H_
 #define QUEUE_H_
 
+#include "common/spinlock.h"
 #include "api/gpuResource.h"
 #include "vkUtils.h"
 
@@ -9,12 +10,13 @@ namespace aph
 class VulkanDevice;
 class VulkanCommandBuffer;
 
+// The lists default to the heap, per-frame submissions build them on the FrameAllocator's resource instead.
 struct QueueSubmitInfo
 {
-    std::vector<VulkanCommandBuffer*> commandBuffers;
-    std::vector<VkPipelineStageFlags> waitStages;
-    std::vector<VkSemaphore>          waitSemaphores;
-    std::vector<VkSemaphore>          signalSemaphores;
+    std::pmr::vector<VulkanCommandBuffer*> commandBuffers;
+    std::pmr::vector<VkPipelineStageFlags> waitStages;
+    std::pmr::vector<VkSemaphore>          waitSemaphores;
+    std::pmr::vector<VkSemaphore>          signalSemaphores;
 };
 
 class VulkanQueue : public ResourceHandle<VkQueue>
@@ -25,13 +27,17 @@ public:
     uint32_t     getFamilyIndex() const { return m_queueFamilyIndex; }
     uint32_t     getIndex() const { return m_index; }
     VkQueueFlags getFlags() const { return m_properties.queueFlags; }
-    VkResult     waitIdle() { return vkQueueWaitIdle(getHandle()); }
-    VkResult     submit(const std::vector<QueueSubmitInfo>& submitInfos, VkFence fence);
+    uint32_t     getTimestampValidBits() const { return m_properties.timestampValidBits; }
+    VkResult     waitIdle();
+    VkResult     submit(std::span<const QueueSubmitInfo> submitInfos, VkFence fence);
+    VkResult     present(const VkPresentInfoKHR& presentInfo);
 
 private:
     uint32_t                m_queueFamilyIndex = {};
     uint32_t                m_index            = {};
     VkQueueFamilyProperties m_properties       = {};
+    // Vulkan requires queue access to be externally synchronized, uploads may submit from worker threads.
+    AdaptiveMutex m_lock = {};
 };
 
 using QueueFamily = std::vector<std::unique_ptr<VulkanQueue>>;
@@ -97,6 +97,30 @@ VulkanSwapChain::VulkanSwapChain(const SwapChainCreateInfo& createInfo, VulkanDe
     m_device(pDevice),
     m_surface(createInfo.surface)
 {
+    getCreateInfo() = createInfo;
+    if(isHeadless())
+    {
+        // rgba8 rather than bgra8, storage image support is only guaranteed for the former.
+        m_surfaceFormat = { VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+        m_extent        = { createInfo.width, createInfo.height };
+        ImageUsageFlags usage =
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        for(uint32_t idx = 0; idx < MAX_SWAPCHAIN_IMAGE_COUNT; idx++)
+        {
+            ImageCreateInfo imageCreateInfo = {
+                .extent    = { m_extent.width, m_extent.height, 1 },
+                .usage     = usage,
+                .property  = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                .imageType = ImageType::_2D,
+                .format    = static_cast<Format>(getSurfaceFormat()),
+            };
+            VulkanImage* pImage = nullptr;
+            VK_CHECK_RESULT(m_device->createImage(imageCreateInfo, &pImage));
+            m_images.emplace_back(pImage);
+        }
+        return;
+    }
+
     SwapChainSupportDetails swapChainSupport = querySwapChainSupport(
         m_surface, m_device->getPhysicalDevice()->getHandle(), static_cast<GLFWwindow*>(createInfo.windowHandle));
 
@@ -153,14 +177,25 @@ VulkanSwapChain::VulkanSwapChain(const SwapChainCreateInfo& createInfo, VulkanDe
     }
 }
 
-VkResult VulkanSwapChain::acquireNextImage(uint32_t* pImageIndex, VkSemaphore semaphore, VkFence fence) const
+VkResult VulkanSwapChain::acquireNextImage(uint32_t* pImageIndex, VkSemaphore semaphore, VkFence fence)
 {
+    if(isHeadless())
+    {
+        *pImageIndex = m_nextImage;
+        m_nextImage  = (m_nextImage + 1) % m_images.size();
+        return VK_SUCCESS;
+    }
     return vkAcquireNextImageKHR(m_device->getHandle(), getHandle(), UINT64_MAX, semaphore, fence, pImageIndex);
 }
 
 VkResult VulkanSwapChain::presentImage(const uint32_t& imageIdx, VulkanQueue* pQueue,
-                                       const std::vector<VkSemaphore>& waitSemaphores)
+                                       std::span<const VkSemaphore> waitSemaphores)
 {
+    if(isHeadless())
+    {
+        return VK_SUCCESS;
+    }
+
     VkPresentInfoKHR presentInfo = {
         .sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
         .waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
@@ -171,9 +206,18 @@ VkResult VulkanSwapChain::presentImage(const uint32_t& imageIdx, VulkanQueue* pQ
         .pResults           = nullptr,  // Optional
     };
 
-    VkResult result = vkQueuePresentKHR(pQueue->getHandle(), &presentInfo);
-    return result;
+    return pQueue->present(presentInfo);
 }
 
-VulkanSwapChain::~VulkanSwapChain() = default;
+VulkanSwapChain::~VulkanSwapChain()
+{
+    // Swapchain images belong to the swapchain, offscreen ones were allocated by us.
+    if(isHeadless())
+    {
+        for(auto& image : m_images)
+        {
+            m_device->destroyImage(image.release());
+        }
+    }
+}
 }  // namespace aph
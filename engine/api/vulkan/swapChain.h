@@ -15,20 +15,25 @@ struct SwapChainCreateInfo
 {
     VkSurfaceKHR surface;
     void*        windowHandle;
+    // Size of the offscreen images when there is no surface.
+    uint32_t width  = {};
+    uint32_t height = {};
 };
 
+// Without a surface the swapchain is headless: a ring of offscreen images handed out round-robin. Acquiring does not
+// signal the semaphore or fence and presenting does nothing, the renderer submits without them in that mode.
 class VulkanSwapChain : public ResourceHandle<VkSwapchainKHR, SwapChainCreateInfo>
 {
 public:
     VulkanSwapChain(const SwapChainCreateInfo& createInfo, VulkanDevice* pDevice);
     ~VulkanSwapChain();
 
-    VkResult acquireNextImage(uint32_t* pImageIndex, VkSemaphore semaphore, VkFence fence = VK_NULL_HANDLE) const;
+    VkResult acquireNextImage(uint32_t* pImageIndex, VkSemaphore semaphore, VkFence fence = VK_NULL_HANDLE);
 
-    VkResult presentImage(const uint32_t& imageIdx, VulkanQueue* pQueue,
-                          const std::vector<VkSemaphore>& waitSemaphores);
+    VkResult presentImage(const uint32_t& imageIdx, VulkanQueue* pQueue, std::span<const VkSemaphore> waitSemaphores);
 
 public:
+    bool       isHeadless() const { return m_surface == VK_NULL_HANDLE; }
     VkFormat   getSurfaceFormat() const { return m_surfaceFormat.format; }
     VkExtent2D getExtent() const { return m_extent; }
     uint32_t   getWidth() const { return m_extent.width; }
@@ -37,6 +42,12 @@ public:
     uint32_t     getImageCount() const { return m_images.size(); }
     VulkanImage* getImage(uint32_t idx) const { return m_images[idx].get(); }
 
+    // Layout a finished frame has to be in: presentable, or ready to be copied out when headless.
+    VkImageLayout getPresentLayout() const
+    {
+        return isHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    }
+
 private:
     VulkanDevice*             m_device{};
     std::vector<std::unique_ptr<VulkanImage>> m_images{};
@@ -44,6 +55,7 @@ private:
     VkSurfaceKHR       m_surface{};
     VkSurfaceFormatKHR m_surfaceFormat{};
     VkExtent2D         m_extent{};
+    uint32_t           m_nextImage{};
 
     constexpr static uint32_t MAX_SWAPCHAIN_IMAGE_COUNT = 3;
 };
@@ -23,7 +23,7 @@ VkResult VulkanSyncPrimitivesPool::acquireFence(VkFence& fence, bool isSignaled)
     VkResult result = VK_SUCCESS;
 
     // See if there's a free fence available.
-    m_fenceLock.Lock();
+    LockGuard<AdaptiveMutex> lock(m_fenceLock);
     if(!m_availableFences.empty())
     {
         fence = m_availableFences.front();
@@ -42,34 +42,27 @@ VkResult VulkanSyncPrimitivesPool::acquireFence(VkFence& fence, bool isSignaled)
         if(result == VK_SUCCESS)
             m_allFences.emplace(fence);
     }
-    m_fenceLock.Unlock();
 
     return result;
 }
 
 VkResult VulkanSyncPrimitivesPool::releaseFence(VkFence fence)
 {
-    m_fenceLock.Lock();
+    LockGuard<AdaptiveMutex> lock(m_fenceLock);
     if(m_allFences.count(fence))
     {
         VkResult result = vkResetFences(m_device->getHandle(), 1, &fence);
         if(result != VK_SUCCESS)
-        {
-            m_fenceLock.Unlock();
             return result;
-        }
         m_availableFences.push(fence);
     }
-    m_fenceLock.Unlock();
     return VK_SUCCESS;
 }
 
 bool VulkanSyncPrimitivesPool::Exists(VkFence fence)
 {
-    m_fenceLock.Lock();
-    auto result = (m_allFences.find(fence) != m_allFences.end());
-    m_fenceLock.Unlock();
-    return result;
+    LockGuard<AdaptiveMutex> lock(m_fenceLock);
+    return m_allFences.find(fence) != m_allFences.end();
 }
 
 VkResult VulkanSyncPrimitivesPool::acquireSemaphore(uint32_t semaphoreCount, VkSemaphore* pSemaphores)
@@ -77,7 +70,7 @@ VkResult VulkanSyncPrimitivesPool::acquireSemaphore(uint32_t semaphoreCount, VkS
     VkResult result = VK_SUCCESS;
 
     // See if there are free semaphores available.
-    m_semaphoreLock.Lock();
+    LockGuard<AdaptiveMutex> lock(m_semaphoreLock);
     while(!m_availableSemaphores.empty())
     {
         *pSemaphores = m_availableSemaphores.front();
@@ -99,13 +92,12 @@ VkResult VulkanSyncPrimitivesPool::acquireSemaphore(uint32_t semaphoreCount, VkS
         m_allSemaphores.emplace(pSemaphores[i]);
     }
 
-    m_semaphoreLock.Unlock();
     return result;
 }
 
 VkResult VulkanSyncPrimitivesPool::ReleaseSemaphores(uint32_t semaphoreCount, const VkSemaphore* pSemaphores)
 {
-    m_semaphoreLock.Lock();
+    LockGuard<AdaptiveMutex> lock(m_semaphoreLock);
     for(auto i = 0U; i < semaphoreCount; ++i)
     {
         if(m_allSemaphores.count(pSemaphores[i]))
@@ -113,15 +105,12 @@ VkResult VulkanSyncPrimitivesPool::ReleaseSemaphores(uint32_t semaphoreCount, co
             m_availableSemaphores.push(pSemaphores[i]);
         }
     }
-    m_semaphoreLock.Unlock();
     return VK_SUCCESS;
 }
 
 bool VulkanSyncPrimitivesPool::Exists(VkSemaphore semaphore)
 {
-    m_semaphoreLock.Lock();
-    auto result = (m_allSemaphores.find(semaphore) != m_allSemaphores.end());
-    m_semaphoreLock.Unlock();
-    return result;
+    LockGuard<AdaptiveMutex> lock(m_semaphoreLock);
+    return m_allSemaphores.find(semaphore) != m_allSemaphores.end();
 }
 }  // namespace aph
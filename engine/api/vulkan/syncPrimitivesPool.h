@@ -29,7 +29,7 @@ private:
     std::set<VkSemaphore>   m_allSemaphores       = {};
     std::queue<VkFence>     m_availableFences     = {};
     std::queue<VkSemaphore> m_availableSemaphores = {};
-    SpinLock                m_fenceLock = {}, m_semaphoreLock = {};
+    AdaptiveMutex           m_fenceLock = {}, m_semaphoreLock = {};
 };
 }  // namespace aph
 
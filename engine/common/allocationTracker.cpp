@@ -0,0 +1,348 @@
+#include "allocationTracker.h"
+#include "spinlock.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace aph
+{
+namespace
+{
+constexpr size_t TAG_COUNT = size_t(AllocationTag::COUNT);
+
+struct TagCounters
+{
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> frees{ 0 };
+    std::atomic<uint64_t> totalBytes{ 0 };
+    std::atomic<int64_t>  liveBytes{ 0 };
+    std::atomic<int64_t>  peakBytes{ 0 };
+    std::atomic<int64_t>  framePeakBytes{ 0 };
+};
+
+// Constant initialized, so allocations made during static initialization are counted too.
+TagCounters                          g_counters[TAG_COUNT];
+constinit thread_local AllocationTag tl_tag = AllocationTag::UNTAGGED;
+
+// Counter values at the start of the current frame and the finished frame reports, guarded by g_reportLock.
+AdaptiveMutex                                                           g_reportLock;
+uint64_t                                                                g_frame = 0;
+std::array<std::pair<uint64_t, uint64_t>, TAG_COUNT>                    g_frameStart;
+std::array<FrameAllocationReport, AllocationTracker::MAX_FRAME_HISTORY> g_history;
+uint64_t                                                                g_historyCount = 0;
+
+void updateMax(std::atomic<int64_t>& value, int64_t candidate)
+{
+    int64_t current = value.load(std::memory_order_relaxed);
+    while(current < candidate && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed))
+    {
+    }
+}
+
+[[maybe_unused]] void recordAllocation(AllocationTag tag, size_t size)
+{
+    auto& counters = g_counters[size_t(tag)];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.totalBytes.fetch_add(size, std::memory_order_relaxed);
+    int64_t live = counters.liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + size;
+    updateMax(counters.peakBytes, live);
+    updateMax(counters.framePeakBytes, live);
+}
+
+[[maybe_unused]] void recordFree(AllocationTag tag, size_t size)
+{
+    auto& counters = g_counters[size_t(tag)];
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+    counters.liveBytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+
+void appendStats(std::string& out, const char* name, uint64_t value, bool last = false)
+{
+    out.append("\"").append(name).append("\":").append(std::to_string(value)).append(last ? "" : ",");
+}
+}  // namespace
+
+const char* AllocationTracker::GetTagName(AllocationTag tag)
+{
+    switch(tag)
+    {
+    case AllocationTag::UNTAGGED:
+        return "untagged";
+    case AllocationTag::SCENE:
+        return "scene";
+    case AllocationTag::RENDERER:
+        return "renderer";
+    case AllocationTag::UI:
+        return "ui";
+    case AllocationTag::IMPORT:
+        return "import";
+    default:
+        return "";
+    }
+}
+
+AllocationStats AllocationTracker::GetStats(AllocationTag tag)
+{
+    const auto& counters = g_counters[size_t(tag)];
+    return {
+        .allocations = counters.allocations.load(std::memory_order_relaxed),
+        .frees       = counters.frees.load(std::memory_order_relaxed),
+        .totalBytes  = counters.totalBytes.load(std::memory_order_relaxed),
+        .liveBytes   = counters.liveBytes.load(std::memory_order_relaxed),
+        .peakBytes   = counters.peakBytes.load(std::memory_order_relaxed),
+    };
+}
+
+AllocationTag AllocationTracker::GetCurrentTag()
+{
+    return tl_tag;
+}
+
+void AllocationTracker::BeginFrame()
+{
+    if constexpr(!IsEnabled())
+    {
+        return;
+    }
+
+    LockGuard<AdaptiveMutex> lock(g_reportLock);
+    FrameAllocationReport    report{ .frame = g_frame };
+    for(size_t tag = 0; tag < TAG_COUNT; ++tag)
+    {
+        auto&    counters    = g_counters[tag];
+        uint64_t allocations = counters.allocations.load(std::memory_order_relaxed);
+        uint64_t bytes       = counters.totalBytes.load(std::memory_order_relaxed);
+        int64_t  live        = counters.liveBytes.load(std::memory_order_relaxed);
+
+        report.tags[tag] = {
+            .allocations = allocations - g_frameStart[tag].first,
+            .bytes       = bytes - g_frameStart[tag].second,
+            .peakBytes   = counters.framePeakBytes.exchange(live, std::memory_order_relaxed),
+        };
+        g_frameStart[tag] = { allocations, bytes };
+    }
+
+    // The very first call only marks the start of frame 0.
+    if(g_frame > 0)
+    {
+        g_history[g_historyCount % MAX_FRAME_HISTORY] = report;
+        ++g_historyCount;
+    }
+    ++g_frame;
+}
+
+FrameAllocationReport AllocationTracker::GetLastFrameReport()
+{
+    LockGuard<AdaptiveMutex> lock(g_reportLock);
+    if(g_historyCount == 0)
+    {
+        return {};
+    }
+    return g_history[(g_historyCount - 1) % MAX_FRAME_HISTORY];
+}
+
+std::string AllocationTracker::ToJson()
+{
+    std::string out = "{\"enabled\":";
+    out.append(IsEnabled() ? "true" : "false").append(",\"tags\":{");
+    for(size_t tag = 0; tag < TAG_COUNT; ++tag)
+    {
+        AllocationStats stats = GetStats(AllocationTag(tag));
+        out.append(tag ? ",\"" : "\"").append(GetTagName(AllocationTag(tag))).append("\":{");
+        appendStats(out, "allocations", stats.allocations);
+        appendStats(out, "frees", stats.frees);
+        appendStats(out, "totalBytes", stats.totalBytes);
+        appendStats(out, "liveBytes", stats.liveBytes);
+        appendStats(out, "peakBytes", stats.peakBytes, true);
+        out.append("}");
+    }
+    out.append("},\"frames\":[");
+
+    LockGuard<AdaptiveMutex> lock(g_reportLock);
+    uint64_t                 first = g_historyCount > MAX_FRAME_HISTORY ? g_historyCount - MAX_FRAME_HISTORY : 0;
+    for(uint64_t idx = first; idx < g_historyCount; ++idx)
+    {
+        const auto& report = g_history[idx % MAX_FRAME_HISTORY];
+        out.append(idx > first ? ",{" : "{");
+        appendStats(out, "frame", report.frame);
+        out.append("\"tags\":{");
+        for(size_t tag = 0; tag < TAG_COUNT; ++tag)
+        {
+            out.append(tag ? ",\"" : "\"").append(GetTagName(AllocationTag(tag))).append("\":{");
+            appendStats(out, "allocations", report.tags[tag].allocations);
+            appendStats(out, "bytes", report.tags[tag].bytes);
+            appendStats(out, "peakBytes", report.tags[tag].peakBytes, true);
+            out.append("}");
+        }
+        out.append("}}");
+    }
+    out.append("]}\n");
+    return out;
+}
+
+bool AllocationTracker::WriteJson(const std::filesystem::path& path)
+{
+    std::ofstream file(path);
+    if(!file)
+    {
+        return false;
+    }
+    file << ToJson();
+    return static_cast<bool>(file);
+}
+
+#if APH_ALLOCATION_TRACKING
+AllocationScope::AllocationScope(AllocationTag tag) : m_previous(tl_tag)
+{
+    tl_tag = tag;
+}
+
+AllocationScope::~AllocationScope()
+{
+    tl_tag = m_previous;
+}
+#endif
+}  // namespace aph
+
+#if APH_ALLOCATION_TRACKING
+namespace
+{
+// Stored in front of every tracked block, so delete knows the size and the tag to credit.
+struct alignas(16) AllocationHeader
+{
+    size_t             size;
+    uint32_t           offset;
+    aph::AllocationTag tag;
+};
+
+void* trackedAllocate(size_t size, size_t alignment)
+{
+    alignment         = std::max(alignment, alignof(AllocationHeader));
+    size_t headerSize = std::max(sizeof(AllocationHeader), alignment);
+    void*  pBase      = nullptr;
+    if(alignment <= alignof(std::max_align_t))
+    {
+        pBase = std::malloc(headerSize + size);
+    }
+    else
+    {
+        pBase = std::aligned_alloc(alignment, (headerSize + size + alignment - 1) / alignment * alignment);
+    }
+    if(!pBase)
+    {
+        return nullptr;
+    }
+
+    auto* pUser     = static_cast<std::byte*>(pBase) + headerSize;
+    auto* pHeader   = reinterpret_cast<AllocationHeader*>(pUser) - 1;
+    pHeader->size   = size;
+    pHeader->offset = static_cast<uint32_t>(headerSize);
+    pHeader->tag    = aph::tl_tag;
+    aph::recordAllocation(pHeader->tag, size);
+    return pUser;
+}
+
+void* trackedNew(size_t size, size_t alignment)
+{
+    void* pUser = trackedAllocate(size, alignment);
+    if(!pUser)
+    {
+        throw std::bad_alloc();
+    }
+    return pUser;
+}
+
+void trackedFree(void* pUser)
+{
+    if(!pUser)
+    {
+        return;
+    }
+    auto* pHeader = static_cast<AllocationHeader*>(pUser) - 1;
+    aph::recordFree(pHeader->tag, pHeader->size);
+    std::free(static_cast<std::byte*>(pUser) - pHeader->offset);
+}
+}  // namespace
+
+void* operator new(size_t size)
+{
+    return trackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new[](size_t size)
+{
+    return trackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return trackedNew(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return trackedNew(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return trackedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return trackedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return trackedAllocate(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return trackedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pUser) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete[](void* pUser) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete(void* pUser, size_t) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete[](void* pUser, size_t) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete(void* pUser, std::align_val_t) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete[](void* pUser, std::align_val_t) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete(void* pUser, size_t, std::align_val_t) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete[](void* pUser, size_t, std::align_val_t) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete(void* pUser, const std::nothrow_t&) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete[](void* pUser, const std::nothrow_t&) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete(void* pUser, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    trackedFree(pUser);
+}
+void operator delete[](void* pUser, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    trackedFree(pUser);
+}
+#endif
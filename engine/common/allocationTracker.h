@@ -0,0 +1,100 @@
+#ifndef ALLOCATION_TRACKER_H_
+#define ALLOCATION_TRACKER_H_
+
+#include "common/common.h"
+
+// Define to 1 (CMake option APH_ALLOCATION_TRACKING) to replace the global operator new/delete with versions that
+// count every heap allocation by tag. Otherwise the API below compiles to no-ops and reports nothing.
+#ifndef APH_ALLOCATION_TRACKING
+#    define APH_ALLOCATION_TRACKING 0
+#endif
+
+namespace aph
+{
+// Subsystem an allocation is charged to, taken from the innermost AllocationScope of the allocating thread.
+enum class AllocationTag : uint8_t
+{
+    UNTAGGED,
+    SCENE,
+    RENDERER,
+    UI,
+    IMPORT,
+    COUNT,
+};
+
+struct AllocationStats
+{
+    uint64_t allocations = 0;
+    uint64_t frees       = 0;
+    uint64_t totalBytes  = 0;
+    int64_t  liveBytes   = 0;
+    int64_t  peakBytes   = 0;
+};
+
+// Allocations and bytes allocated during one frame, and the highest live byte count reached within it.
+struct FrameAllocationStats
+{
+    uint64_t allocations = 0;
+    uint64_t bytes       = 0;
+    int64_t  peakBytes   = 0;
+};
+
+struct FrameAllocationReport
+{
+    uint64_t                                                       frame = 0;
+    std::array<FrameAllocationStats, size_t(AllocationTag::COUNT)> tags  = {};
+
+    uint64_t getTotalAllocations() const
+    {
+        uint64_t total = 0;
+        for(const auto& tag : tags)
+            total += tag.allocations;
+        return total;
+    }
+};
+
+class AllocationTracker
+{
+public:
+    static constexpr uint32_t MAX_FRAME_HISTORY = 256;
+
+    static constexpr bool IsEnabled() { return APH_ALLOCATION_TRACKING; }
+    static const char*    GetTagName(AllocationTag tag);
+
+    // Since process start.
+    static AllocationStats GetStats(AllocationTag tag);
+    // Innermost scope of the calling thread, for work handed to other threads to charge the same tag.
+    static AllocationTag   GetCurrentTag();
+
+    // Closes the current frame's report and starts a new one, call once per frame from one thread.
+    static void BeginFrame();
+    // The last completed frame, empty before the second BeginFrame().
+    static FrameAllocationReport GetLastFrameReport();
+
+    // Process totals and the last MAX_FRAME_HISTORY frame reports.
+    static std::string ToJson();
+    static bool        WriteJson(const std::filesystem::path& path);
+};
+
+// Charges the heap allocations of the calling thread to tag until the scope ends. Scopes nest.
+class AllocationScope
+{
+public:
+#if APH_ALLOCATION_TRACKING
+    explicit AllocationScope(AllocationTag tag);
+    ~AllocationScope();
+#else
+    explicit AllocationScope(AllocationTag) {}
+#endif
+
+    AllocationScope(const AllocationScope&)            = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+#if APH_ALLOCATION_TRACKING
+private:
+    AllocationTag m_previous;
+#endif
+};
+}  // namespace aph
+
+#endif  // ALLOCATION_TRACKER_H_
@@ -15,9 +15,11 @@
 #include <future>
 #include <iostream>
 #include <list>
+#include <memory_resource>
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <span>
 #include <stack>
 #include <thread>
 #include <type_traits>
@@ -36,6 +38,14 @@
 
 #include <stb/stb_image.h>
 
+// Hint to the CPU that the calling thread is in a spin-wait loop.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#    include <immintrin.h>
+#    define APH_CPU_PAUSE() _mm_pause()
+#else
+#    define APH_CPU_PAUSE() std::this_thread::yield()
+#endif
+
 namespace aph
 {
 enum class Result
@@ -0,0 +1,128 @@
+#include "frameAllocator.h"
+
+namespace aph
+{
+namespace
+{
+std::atomic<uint32_t> g_frameAllocatorCount{ 0 };
+}  // namespace
+
+LinearArena::~LinearArena()
+{
+    for(const auto& block : m_blocks)
+    {
+        delete[] block.pData;
+    }
+}
+
+void LinearArena::reset()
+{
+    m_currentBlock = 0;
+    m_offset       = 0;
+    m_usedSize     = 0;
+}
+
+void* LinearArena::do_allocate(size_t bytes, size_t alignment)
+{
+    while(m_currentBlock < m_blocks.size())
+    {
+        const Block& block   = m_blocks[m_currentBlock];
+        auto         address = reinterpret_cast<uintptr_t>(block.pData) + m_offset;
+        size_t       padding = (alignment - address % alignment) % alignment;
+        if(m_offset + padding + bytes <= block.size)
+        {
+            m_offset += padding + bytes;
+            m_usedSize += padding + bytes;
+            return block.pData + m_offset - bytes;
+        }
+        // Skip the rest of this block, the next one may have room.
+        ++m_currentBlock;
+        m_offset = 0;
+    }
+
+    // Out of blocks, the worst case padding is alignment - 1.
+    Block block{ nullptr, std::max(m_blockSize, bytes + alignment) };
+    block.pData = new std::byte[block.size];
+    m_blocks.push_back(block);
+    m_capacity += block.size;
+    ++m_blockAllocationCount;
+    m_currentBlock = m_blocks.size() - 1;
+    return do_allocate(bytes, alignment);
+}
+
+FrameAllocator::FrameAllocator(uint32_t frameCount, size_t blockSize) :
+    m_id(g_frameAllocatorCount.fetch_add(1, std::memory_order_relaxed)),
+    m_frameCount(frameCount),
+    m_blockSize(blockSize),
+    m_frameBlockAllocationCounts(frameCount, 0)
+{
+}
+
+void FrameAllocator::beginFrame(uint32_t frameIndex)
+{
+    assert(frameIndex < m_frameCount);
+    LockGuard<AdaptiveMutex> lock(m_lock);
+    size_t                   frameSize  = 0;
+    uint64_t                 blockCount = 0;
+    for(auto& thread : m_threads)
+    {
+        LinearArena& arena = *thread->frames[frameIndex];
+        frameSize += arena.getUsedSize();
+        blockCount += arena.getBlockAllocationCount();
+        arena.reset();
+    }
+    m_peakFrameSize                          = std::max(m_peakFrameSize, frameSize);
+    m_frameBlockAllocationCounts[frameIndex] = blockCount;
+    m_frameIndex.store(frameIndex, std::memory_order_relaxed);
+}
+
+size_t FrameAllocator::getPeakFrameSize()
+{
+    LockGuard<AdaptiveMutex> lock(m_lock);
+    return m_peakFrameSize;
+}
+
+uint64_t FrameAllocator::getBlockAllocationCount()
+{
+    LockGuard<AdaptiveMutex> lock(m_lock);
+    uint64_t                 count = 0;
+    for(uint64_t frameCount : m_frameBlockAllocationCounts)
+    {
+        count += frameCount;
+    }
+    return count;
+}
+
+LinearArena& FrameAllocator::getThreadArena()
+{
+    // Allocators this thread has used, the arenas themselves stay owned by the allocator.
+    thread_local std::vector<std::pair<uint32_t, ThreadArenas*>> tl_arenas;
+
+    ThreadArenas* pArenas = nullptr;
+    for(auto& [id, pThreadArenas] : tl_arenas)
+    {
+        if(id == m_id)
+        {
+            pArenas = pThreadArenas;
+            break;
+        }
+    }
+
+    if(!pArenas)
+    {
+        auto arenas = std::make_unique<ThreadArenas>();
+        for(uint32_t idx = 0; idx < m_frameCount; ++idx)
+        {
+            arenas->frames.push_back(std::make_unique<LinearArena>(m_blockSize));
+        }
+        pArenas = arenas.get();
+        {
+            LockGuard<AdaptiveMutex> lock(m_lock);
+            m_threads.push_back(std::move(arenas));
+        }
+        tl_arenas.emplace_back(m_id, pArenas);
+    }
+
+    return *pArenas->frames[m_frameIndex.load(std::memory_order_relaxed)];
+}
+}  // namespace aph
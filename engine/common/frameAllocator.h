@@ -0,0 +1,111 @@
+#ifndef FRAME_ALLOCATOR_H_
+#define FRAME_ALLOCATOR_H_
+
+#include "common/spinlock.h"
+
+#include <memory_resource>
+
+namespace aph
+{
+// Bump allocator over a list of blocks. Deallocation is a no-op, reset() rewinds to the first block and keeps every
+// block, so once the arena has grown to a workload's peak it never calls malloc again.
+// Usable directly or as the memory resource of std::pmr containers. Not thread safe.
+class LinearArena : public std::pmr::memory_resource
+{
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit LinearArena(size_t blockSize = DEFAULT_BLOCK_SIZE) : m_blockSize(blockSize) {}
+    ~LinearArena() override;
+
+    LinearArena(const LinearArena&)            = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    // Everything allocated since the last reset() must be dead by now.
+    void reset();
+
+    size_t   getUsedSize() const { return m_usedSize; }
+    size_t   getCapacity() const { return m_capacity; }
+    uint64_t getBlockAllocationCount() const { return m_blockAllocationCount; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void  do_deallocate(void*, size_t, size_t) override {}
+    bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct Block
+    {
+        std::byte* pData;
+        size_t     size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t             m_blockSize;
+    size_t             m_currentBlock         = 0;
+    size_t             m_offset               = 0;
+    size_t             m_usedSize             = 0;
+    size_t             m_capacity             = 0;
+    uint64_t           m_blockAllocationCount = 0;
+};
+
+// Transient CPU memory that lives for one frame in flight.
+// Every thread gets its own LinearArena per frame index, so allocating takes no lock. beginFrame() rewinds the arenas
+// of a frame index once its fence signalled, i.e. once nothing, neither the CPU nor a pending submission, can still
+// read what was allocated for it maxFrames ago.
+// A container built on getResource() must only grow on the thread that created it.
+class FrameAllocator
+{
+public:
+    explicit FrameAllocator(uint32_t frameCount, size_t blockSize = LinearArena::DEFAULT_BLOCK_SIZE);
+
+    FrameAllocator(const FrameAllocator&)            = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+    // Must not race with allocations for frameIndex, allocations for other frame indices may continue.
+    void beginFrame(uint32_t frameIndex);
+
+    // The calling thread's arena for the current frame, e.g. std::pmr::vector<VkSemaphore> semaphores(pResource).
+    std::pmr::memory_resource* getResource() { return &getThreadArena(); }
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+    {
+        return getThreadArena().allocate(size, alignment);
+    }
+
+    // Uninitialized storage for count objects of T.
+    template <typename T>
+    T* allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "Frame allocations are never destroyed");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    uint32_t getFrameIndex() const { return m_frameIndex.load(std::memory_order_relaxed); }
+    // Peak bytes used by a single frame across all threads, and the number of blocks the arenas allocated, both as of
+    // the last beginFrame() of each frame index. A block count that stops growing means frames no longer malloc.
+    size_t   getPeakFrameSize();
+    uint64_t getBlockAllocationCount();
+
+private:
+    // One arena per frame index, owned by a single thread.
+    struct ThreadArenas
+    {
+        std::vector<std::unique_ptr<LinearArena>> frames;
+    };
+
+    LinearArena& getThreadArena();
+
+private:
+    const uint32_t                             m_id;
+    const uint32_t                             m_frameCount;
+    const size_t                               m_blockSize;
+    std::atomic<uint32_t>                      m_frameIndex{ 0 };
+    size_t                                     m_peakFrameSize = 0;
+    std::vector<uint64_t>                      m_frameBlockAllocationCounts;
+    AdaptiveMutex                              m_lock;
+    std::vector<std::unique_ptr<ThreadArenas>> m_threads;
+};
+}  // namespace aph
+
+#endif  // FRAME_ALLOCATOR_H_
@@ -0,0 +1,246 @@
+#include "frameStats.h"
+
+namespace aph
+{
+namespace
+{
+constexpr float MISSING = -1.0f;
+
+// p in [0, 1] of samples sorted ascending.
+double percentile(std::vector<float>& sorted, double p)
+{
+    auto idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+void appendNumber(std::string& out, double value)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.4f", value);
+    out.append(buffer);
+}
+}  // namespace
+
+FrameStats::FrameStats(uint32_t windowSize) : m_windowSize(std::max(windowSize, 1U))
+{
+    m_window.reserve(m_windowSize);
+    m_summaryScratch.reserve(m_windowSize);
+    m_current.fill(MISSING);
+}
+
+const char* FrameStats::GetMetricName(FrameMetric metric)
+{
+    switch(metric)
+    {
+    case FrameMetric::CPU_FRAME:
+        return "cpu_frame";
+    case FrameMetric::GPU_FRAME:
+        return "gpu_frame";
+    case FrameMetric::ACQUIRE_WAIT:
+        return "acquire_wait";
+    case FrameMetric::FENCE_WAIT:
+        return "fence_wait";
+    default:
+        return "";
+    }
+}
+
+template <typename F>
+void FrameStats::forEachInWindow(F&& func) const
+{
+    // m_window is a ring once full, the oldest sample sits at the next write position.
+    size_t start = m_window.size() < m_windowSize ? 0 : m_frameCount % m_window.size();
+    for(size_t idx = 0; idx < m_window.size(); ++idx)
+    {
+        func(m_window[(start + idx) % m_window.size()]);
+    }
+}
+
+void FrameStats::endFrame()
+{
+    Sample sample{ m_frameCount, m_current };
+    if(m_window.size() < m_windowSize)
+    {
+        m_window.push_back(sample);
+    }
+    else
+    {
+        m_window[m_frameCount % m_window.size()] = sample;
+    }
+    if(m_recordHistory)
+    {
+        m_history.push_back(sample);
+    }
+
+    float cpuMs = m_current[size_t(FrameMetric::CPU_FRAME)];
+    if(m_frameCount % MEDIAN_INTERVAL == 0)
+    {
+        m_cpuMedianMs = getSummary(FrameMetric::CPU_FRAME).p50Ms;
+    }
+    if(cpuMs != MISSING && m_cpuMedianMs > 0.0 && cpuMs > m_cpuMedianMs * SPIKE_FACTOR &&
+       cpuMs > m_cpuMedianMs + SPIKE_MIN_DELTA_MS)
+    {
+        if(m_spikes.size() == MAX_SPIKES)
+        {
+            m_spikes.pop_front();
+        }
+        m_spikes.push_back({ m_frameCount, cpuMs, m_cpuMedianMs });
+        ++m_spikeCount;
+    }
+
+    m_current.fill(MISSING);
+    ++m_frameCount;
+}
+
+std::vector<float> FrameStats::getWindow(FrameMetric metric) const
+{
+    std::vector<float> values;
+    values.reserve(m_window.size());
+    forEachInWindow([&](const Sample& sample) { values.push_back(sample.ms[size_t(metric)]); });
+    return values;
+}
+
+FrameMetricSummary FrameStats::getSummary(FrameMetric metric) const
+{
+    std::vector<float>& values = m_summaryScratch;
+    values.clear();
+    double sum = 0.0;
+    for(const auto& sample : m_window)
+    {
+        float value = sample.ms[size_t(metric)];
+        if(value != MISSING)
+        {
+            values.push_back(value);
+            sum += value;
+        }
+    }
+    if(values.empty())
+    {
+        return {};
+    }
+
+    std::sort(values.begin(), values.end());
+    return {
+        .sampleCount = static_cast<uint32_t>(values.size()),
+        .averageMs   = sum / static_cast<double>(values.size()),
+        .p50Ms       = percentile(values, 0.50),
+        .p95Ms       = percentile(values, 0.95),
+        .p99Ms       = percentile(values, 0.99),
+        .maxMs       = values.back(),
+    };
+}
+
+FrameStats::Histogram FrameStats::getHistogram(FrameMetric metric) const
+{
+    Histogram histogram = {};
+    for(const auto& sample : m_window)
+    {
+        float value = sample.ms[size_t(metric)];
+        if(value != MISSING)
+        {
+            auto bucket = static_cast<size_t>(value / HISTOGRAM_BUCKET_MS);
+            ++histogram[std::min<size_t>(bucket, HISTOGRAM_BUCKETS - 1)];
+        }
+    }
+    return histogram;
+}
+
+std::string FrameStats::toCsv() const
+{
+    std::string out = "frame";
+    for(size_t metric = 0; metric < METRIC_COUNT; ++metric)
+    {
+        out.append(",").append(GetMetricName(FrameMetric(metric))).append("_ms");
+    }
+    out.append("\n");
+
+    auto appendRow = [&out](const Sample& sample) {
+        out.append(std::to_string(sample.frame));
+        for(float value : sample.ms)
+        {
+            out.append(",");
+            if(value != MISSING)
+            {
+                appendNumber(out, value);
+            }
+        }
+        out.append("\n");
+    };
+
+    if(m_recordHistory)
+    {
+        std::for_each(m_history.begin(), m_history.end(), appendRow);
+    }
+    else
+    {
+        forEachInWindow(appendRow);
+    }
+    return out;
+}
+
+std::string FrameStats::toJson() const
+{
+    std::string out = "{\"frames\":" + std::to_string(m_frameCount) + ",\"metrics\":{";
+    for(size_t metric = 0; metric < METRIC_COUNT; ++metric)
+    {
+        auto summary = getSummary(FrameMetric(metric));
+        out.append(metric ? "," : "").append("\"").append(GetMetricName(FrameMetric(metric))).append("\":{");
+        out.append("\"samples\":").append(std::to_string(summary.sampleCount));
+        out.append(",\"average_ms\":");
+        appendNumber(out, summary.averageMs);
+        out.append(",\"p50_ms\":");
+        appendNumber(out, summary.p50Ms);
+        out.append(",\"p95_ms\":");
+        appendNumber(out, summary.p95Ms);
+        out.append(",\"p99_ms\":");
+        appendNumber(out, summary.p99Ms);
+        out.append(",\"max_ms\":");
+        appendNumber(out, summary.maxMs);
+
+        out.append(",\"histogram\":[");
+        auto histogram = getHistogram(FrameMetric(metric));
+        for(size_t bucket = 0; bucket < histogram.size(); ++bucket)
+        {
+            out.append(bucket ? "," : "").append(std::to_string(histogram[bucket]));
+        }
+        out.append("]}");
+    }
+
+    out.append("},\"histogram_bucket_ms\":");
+    appendNumber(out, HISTOGRAM_BUCKET_MS);
+    out.append(",\"spike_count\":").append(std::to_string(m_spikeCount)).append(",\"spikes\":[");
+    for(size_t idx = 0; idx < m_spikes.size(); ++idx)
+    {
+        out.append(idx ? "," : "").append("{\"frame\":").append(std::to_string(m_spikes[idx].frame));
+        out.append(",\"ms\":");
+        appendNumber(out, m_spikes[idx].valueMs);
+        out.append(",\"median_ms\":");
+        appendNumber(out, m_spikes[idx].medianMs);
+        out.append("}");
+    }
+    out.append("]}");
+    return out;
+}
+
+bool FrameStats::writeCsv(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if(!file)
+    {
+        return false;
+    }
+    file << toCsv();
+    return static_cast<bool>(file);
+}
+
+bool FrameStats::writeJson(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if(!file)
+    {
+        return false;
+    }
+    file << toJson();
+    return static_cast<bool>(file);
+}
+}  // namespace aph
@@ -0,0 +1,108 @@
+#ifndef FRAME_STATS_H_
+#define FRAME_STATS_H_
+
+#include "common/common.h"
+
+namespace aph
+{
+enum class FrameMetric : uint8_t
+{
+    // Wall time between the ends of two consecutive frames, what the user actually sees.
+    CPU_FRAME,
+    GPU_FRAME,
+    ACQUIRE_WAIT,
+    FENCE_WAIT,
+    COUNT,
+};
+
+struct FrameMetricSummary
+{
+    uint32_t sampleCount = 0;
+    double   averageMs   = 0.0;
+    double   p50Ms       = 0.0;
+    double   p95Ms       = 0.0;
+    double   p99Ms       = 0.0;
+    double   maxMs       = 0.0;
+};
+
+// A CPU frame well above the rolling median.
+struct FrameSpike
+{
+    uint64_t frame    = 0;
+    double   valueMs  = 0.0;
+    double   medianMs = 0.0;
+};
+
+// Rolling window of per-frame timings. Metrics a frame did not report are left out of its statistics.
+class FrameStats
+{
+public:
+    static constexpr uint32_t DEFAULT_WINDOW_SIZE = 1024;
+    static constexpr uint32_t HISTOGRAM_BUCKETS   = 40;
+    // The last bucket also takes everything slower.
+    static constexpr double   HISTOGRAM_BUCKET_MS = 1.0;
+    static constexpr uint32_t MAX_SPIKES          = 64;
+    // A CPU frame is a spike if it took SPIKE_FACTOR times the median and at least SPIKE_MIN_DELTA_MS longer.
+    static constexpr double   SPIKE_FACTOR        = 2.0;
+    static constexpr double   SPIKE_MIN_DELTA_MS  = 2.0;
+
+    using Histogram = std::array<uint32_t, HISTOGRAM_BUCKETS>;
+
+    explicit FrameStats(uint32_t windowSize = DEFAULT_WINDOW_SIZE);
+
+    static const char* GetMetricName(FrameMetric metric);
+
+    // Samples of the current frame, committed by endFrame().
+    void record(FrameMetric metric, double ms) { m_current[size_t(metric)] = static_cast<float>(ms); }
+    void endFrame();
+
+    // Keeps every frame, not only the window, for the CSV of an automated run.
+    void setRecordHistory(bool enabled) { m_recordHistory = enabled; }
+
+    uint64_t                      getFrameCount() const { return m_frameCount; }
+    // Sorts in a scratch buffer of the window's size, not thread safe even though const.
+    FrameMetricSummary            getSummary(FrameMetric metric) const;
+    Histogram                     getHistogram(FrameMetric metric) const;
+    const std::deque<FrameSpike>& getSpikes() const { return m_spikes; }
+    uint64_t                      getSpikeCount() const { return m_spikeCount; }
+    // Oldest first, a negative value marks a frame without that metric.
+    std::vector<float>            getWindow(FrameMetric metric) const;
+
+    // One row per frame: the history if recorded, the window otherwise.
+    std::string toCsv() const;
+    // Summaries and histograms of the window, and the recent spikes.
+    std::string toJson() const;
+    bool        writeCsv(const std::filesystem::path& path) const;
+    bool        writeJson(const std::filesystem::path& path) const;
+
+private:
+    static constexpr size_t METRIC_COUNT = size_t(FrameMetric::COUNT);
+    // Medians used for spike detection are refreshed this often rather than every frame.
+    static constexpr uint32_t MEDIAN_INTERVAL = 16;
+
+    struct Sample
+    {
+        uint64_t                        frame;
+        std::array<float, METRIC_COUNT> ms;
+    };
+
+    template <typename F>
+    void forEachInWindow(F&& func) const;
+
+    uint32_t                        m_windowSize    = {};
+    std::vector<Sample>             m_window        = {};
+    std::vector<Sample>             m_history       = {};
+    std::array<float, METRIC_COUNT> m_current       = {};
+    uint64_t                        m_frameCount    = 0;
+    bool                            m_recordHistory = false;
+
+    // Reused by getSummary(), which endFrame() calls for the spike detection.
+    mutable std::vector<float> m_summaryScratch = {};
+
+    double                 m_cpuMedianMs = 0.0;
+    std::deque<FrameSpike> m_spikes      = {};
+    uint64_t               m_spikeCount  = 0;
+};
+}  // namespace aph
+
+#endif  // FRAME_STATS_H_
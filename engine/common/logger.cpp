@@ -103,17 +103,6 @@ std::string prep_name(Logger& l)
     return "[ " + l._name + " ]";
 }
 
-template <typename T>
-Logger& operator<<(Logger& l, const T& s)
-{
-    if(l._message_level <= Logger::_loglevel())
-    {
-        l._fac << s;
-        return l;
-    }
-    return l;
-}
-
 Logger::Logger(std::ostream& f, std::string n) : _message_level(LOG_SILENT), _fac(f), _name(std::move(n))
 {
     time(&_now);
@@ -207,3 +196,463 @@ void Logger::flush()
 }
 
 }  // namespace aph
+
+namespace aph
+{
+namespace
+{
+// How often the sink thread wakes up on its own to drain the rings.
+constexpr auto ASYNC_LOG_SINK_PERIOD = std::chrono::milliseconds(2);
+
+std::atomic<uint32_t> g_asyncLoggerCount{ 0 };
+
+const char* getLevelPrefix(unsigned level)
+{
+    switch(level)
+    {
+    case LOG_ERR:
+        return APH_LOG_ERROR;
+    case LOG_WARN:
+        return APH_LOG_WARNING;
+    case LOG_INFO:
+        return APH_LOG_INFO;
+    case LOG_DEBUG:
+        return APH_LOG_DEBUG;
+    case LOG_TIME:
+        return APH_LOG_TIME;
+    default:
+        return "";
+    }
+}
+}  // namespace
+
+// Single-producer single-consumer byte ring owned by one logging thread. Records never wrap: one that does not fit
+// before the end of the buffer is preceded by a padding record. All record sizes are multiples of the header size,
+// so the padding always has room for its header.
+struct AsyncLogger::ThreadRing
+{
+    ThreadRing(size_t capacity, uint32_t index) : buffer(new uint8_t[capacity]), mask(capacity - 1), threadIndex(index)
+    {
+    }
+
+    std::unique_ptr<uint8_t[]> buffer;
+    const size_t               mask;
+    const uint32_t             threadIndex;
+
+    alignas(64) std::atomic<size_t> head{ 0 };
+    size_t                          pendingHead = 0;
+    alignas(64) std::atomic<size_t> tail{ 0 };
+};
+
+AsyncLogger::AsyncLogger(std::ostream& out, LogOverflowPolicy policy, size_t ringSize, LogOutputFormat format) :
+    m_id(g_asyncLoggerCount.fetch_add(1, std::memory_order_relaxed)),
+    m_out(out),
+    m_policy(policy),
+    m_format(format),
+    m_wallStart(std::chrono::system_clock::now()),
+    m_steadyStart(std::chrono::steady_clock::now())
+{
+    // Power of two, at least a few records.
+    m_ringSize = 16 * sizeof(RecordHeader);
+    while(m_ringSize < ringSize)
+        m_ringSize <<= 1;
+
+    if(m_format == LogOutputFormat::BINARY)
+    {
+        binlog::LogFileHeader header = {};
+        std::memcpy(header.magic, binlog::MAGIC, sizeof(header.magic));
+        header.version     = binlog::VERSION;
+        header.startTimeNs =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(m_wallStart.time_since_epoch()).count();
+        m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    m_sink = std::thread([this]() { sinkLoop(); });
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeSink.notify_one();
+    m_sink.join();
+}
+
+AsyncLogger& AsyncLogger::GetDefault()
+{
+    static AsyncLogger logger(std::cout);
+    return logger;
+}
+
+AsyncLogger::ThreadRing* AsyncLogger::getThreadRing()
+{
+    // Loggers this thread has written to, the entries keep the rings alive until the thread exits.
+    thread_local std::vector<std::pair<uint32_t, std::shared_ptr<ThreadRing>>> tl_rings;
+    for(auto& [id, ring] : tl_rings)
+    {
+        if(id == m_id)
+            return ring.get();
+    }
+
+    std::shared_ptr<ThreadRing> ring;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ring = std::make_shared<ThreadRing>(m_ringSize, m_threadCount++);
+        m_rings.push_back(ring);
+    }
+    tl_rings.emplace_back(m_id, ring);
+    return ring.get();
+}
+
+uint8_t* AsyncLogger::beginRecord(unsigned level, const char* fmt, const LogSignature* pSignature, size_t size)
+{
+    size = (size + sizeof(RecordHeader) - 1) / sizeof(RecordHeader) * sizeof(RecordHeader);
+    if(size > m_ringSize)
+    {
+        m_droppedTotal.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    ThreadRing* ring    = getThreadRing();
+    size_t      head    = ring->head.load(std::memory_order_relaxed);
+    size_t      offset  = head & ring->mask;
+    size_t      padding = offset + size > m_ringSize ? m_ringSize - offset : 0;
+
+    while(head + padding + size - ring->tail.load(std::memory_order_acquire) > m_ringSize)
+    {
+        if(m_policy == LogOverflowPolicy::DROP)
+        {
+            m_droppedTotal.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        m_drainRequested.exchange(true, std::memory_order_acq_rel);
+        m_wakeSink.notify_one();
+        std::this_thread::yield();
+    }
+
+    if(padding)
+    {
+        auto* pPadding   = reinterpret_cast<RecordHeader*>(ring->buffer.get() + offset);
+        pPadding->pSignature = nullptr;
+        pPadding->size       = static_cast<uint32_t>(padding);
+        head += padding;
+        offset = 0;
+    }
+
+    auto* pHeader      = reinterpret_cast<RecordHeader*>(ring->buffer.get() + offset);
+    pHeader->timestamp  = std::chrono::steady_clock::now().time_since_epoch().count();
+    pHeader->pSignature = pSignature;
+    pHeader->fmt        = fmt;
+    pHeader->size       = static_cast<uint32_t>(size);
+    pHeader->level      = level;
+    ring->pendingHead   = head + size;
+    return ring->buffer.get() + offset + sizeof(RecordHeader);
+}
+
+void AsyncLogger::endRecord()
+{
+    ThreadRing* ring = getThreadRing();
+    ring->head.store(ring->pendingHead, std::memory_order_release);
+
+    // Nudge the sink before the ring runs full instead of waiting for its next period.
+    if(ring->pendingHead - ring->tail.load(std::memory_order_relaxed) > m_ringSize / 2 &&
+       !m_drainRequested.exchange(true, std::memory_order_acq_rel))
+        m_wakeSink.notify_one();
+}
+
+void AsyncLogger::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t                     request = ++m_flushRequested;
+    m_wakeSink.notify_one();
+    m_flushed.wait(lock, [&]() { return m_flushCompleted >= request; });
+}
+
+void AsyncLogger::sinkLoop()
+{
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    std::unique_lock<std::mutex>             lock(m_mutex);
+    while(true)
+    {
+        m_wakeSink.wait_for(lock, ASYNC_LOG_SINK_PERIOD, [this]() {
+            return m_stop || m_flushRequested != m_flushCompleted || m_drainRequested.load(std::memory_order_acquire);
+        });
+        // Cleared before draining, so a request made while the rings are drained wakes the next iteration.
+        m_drainRequested.exchange(false, std::memory_order_acq_rel);
+        bool     stop         = m_stop;
+        uint64_t flushRequest = m_flushRequested;
+        rings                 = m_rings;
+        lock.unlock();
+
+        drain(rings);
+        if(stop || flushRequest != m_flushCompleted)
+            m_out.flush();
+
+        lock.lock();
+        // Rings only referenced from here and m_rings belong to exited threads, drop them once empty.
+        m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(),
+                                     [](const std::shared_ptr<ThreadRing>& ring) {
+                                         return ring.use_count() == 2 && ring->head.load() == ring->tail.load();
+                                     }),
+                      m_rings.end());
+        rings.clear();
+
+        m_flushCompleted = flushRequest;
+        m_flushed.notify_all();
+        if(stop)
+            break;
+    }
+}
+
+void AsyncLogger::drain(const std::vector<std::shared_ptr<ThreadRing>>& rings)
+{
+    // Gather what every thread has published so far and emit it in timestamp order.
+    m_batch.clear();
+    m_batchHeads.resize(rings.size());
+    for(size_t i = 0; i < rings.size(); ++i)
+    {
+        ThreadRing& ring = *rings[i];
+        size_t      head = ring.head.load(std::memory_order_acquire);
+        for(size_t pos = ring.tail.load(std::memory_order_relaxed); pos != head;)
+        {
+            const auto* pHeader = reinterpret_cast<const RecordHeader*>(ring.buffer.get() + (pos & ring.mask));
+            if(pHeader->pSignature)
+                m_batch.push_back({ pHeader, ring.threadIndex });
+            pos += pHeader->size;
+        }
+        m_batchHeads[i] = head;
+    }
+    std::stable_sort(m_batch.begin(), m_batch.end(), [](const PendingRecord& a, const PendingRecord& b) {
+        return a.pHeader->timestamp < b.pHeader->timestamp;
+    });
+
+    m_text.clear();
+    uint64_t dropped = m_droppedTotal.load(std::memory_order_relaxed);
+    if(dropped != m_droppedReported)
+    {
+        uint64_t count = dropped - m_droppedReported;
+        if(m_format == LogOutputFormat::BINARY)
+        {
+            auto timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                                    m_steadyStart);
+            appendBinaryRecord(binlog::RecordType::DROPPED, LOG_WARN, 0, 0, timestampNs.count(), &count,
+                               sizeof(count));
+        }
+        else
+        {
+            m_text.append(APH_LOG_WARNING).append("[ AsyncLogger ]: ");
+            m_text.append(std::to_string(count)).append(" messages dropped\n");
+        }
+        m_droppedReported = dropped;
+    }
+    for(const auto& record : m_batch)
+    {
+        if(m_format == LogOutputFormat::BINARY)
+        {
+            appendBinary(*record.pHeader, record.threadIndex);
+            continue;
+        }
+        appendPrefix(*record.pHeader, record.threadIndex);
+        formatLogMessage(record.pHeader->fmt, *record.pHeader->pSignature,
+                         reinterpret_cast<const uint8_t*>(record.pHeader + 1), m_text);
+        m_text.push_back('\n');
+    }
+    if(!m_text.empty())
+        m_out.write(m_text.data(), static_cast<std::streamsize>(m_text.size()));
+
+    for(size_t i = 0; i < rings.size(); ++i)
+    {
+        rings[i]->tail.store(m_batchHeads[i], std::memory_order_release);
+    }
+}
+
+void AsyncLogger::appendPrefix(const RecordHeader& header, uint32_t threadIndex)
+{
+    auto sinceStart = std::chrono::steady_clock::duration(header.timestamp) - m_steadyStart.time_since_epoch();
+    auto wallTime   = m_wallStart + std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceStart);
+    auto seconds    = std::chrono::system_clock::to_time_t(wallTime);
+    auto micros     = std::chrono::duration_cast<std::chrono::microseconds>(wallTime.time_since_epoch()).count() %
+                  1000000;
+
+    // Calendar conversion only once per second.
+    if(seconds != m_cachedSecond)
+    {
+        struct tm t;
+        localtime_r(&seconds, &t);
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &t);
+        m_cachedTime   = buffer;
+        m_cachedSecond = seconds;
+    }
+
+    char micro[16];
+    std::snprintf(micro, sizeof(micro), ".%06lld", static_cast<long long>(micros));
+    m_text.append(getLevelPrefix(header.level)).append("[ ").append(m_cachedTime).append(micro).append(" ]");
+    m_text.append("[ T").append(std::to_string(threadIndex)).append(" ]: ");
+}
+
+void AsyncLogger::appendBinary(const RecordHeader& header, uint32_t threadIndex)
+{
+    auto timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::duration(header.timestamp) - m_steadyStart.time_since_epoch())
+                           .count();
+
+    auto [it, inserted] = m_formatIds.try_emplace({ header.fmt, header.pSignature },
+                                                  static_cast<uint32_t>(m_formatIds.size()));
+    if(inserted)
+    {
+        // First message from this call site: describe its format string and argument types.
+        const LogSignature& signature = *header.pSignature;
+        auto                fmtLength = static_cast<uint32_t>(std::strlen(header.fmt));
+        std::string         payload;
+        payload.append(reinterpret_cast<const char*>(&fmtLength), sizeof(fmtLength));
+        payload.append(header.fmt, fmtLength);
+        payload.append(reinterpret_cast<const char*>(&signature.count), sizeof(signature.count));
+        payload.append(reinterpret_cast<const char*>(signature.pTypes), signature.count);
+        appendBinaryRecord(binlog::RecordType::FORMAT, 0, it->second, 0, 0, payload.data(), payload.size());
+    }
+
+    const auto* pArgs = reinterpret_cast<const uint8_t*>(&header + 1);
+    appendBinaryRecord(binlog::RecordType::MESSAGE, static_cast<uint16_t>(header.level), it->second, threadIndex,
+                       timestampNs, pArgs, getLogArgsSize(*header.pSignature, pArgs));
+}
+
+void AsyncLogger::appendBinaryRecord(binlog::RecordType type, uint16_t level, uint32_t formatId, uint32_t threadIndex,
+                                     uint64_t timestampNs, const void* pPayload, size_t payloadSize)
+{
+    binlog::LogRecordHeader header = {};
+    header.size                    = static_cast<uint32_t>(payloadSize);
+    header.type                    = type;
+    header.level                   = level;
+    header.formatId                = formatId;
+    header.threadIndex             = threadIndex;
+    header.timestampNs             = timestampNs;
+    m_text.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_text.append(static_cast<const char*>(pPayload), payloadSize);
+}
+
+namespace
+{
+template <typename T>
+T readLogArg(const uint8_t* pArg)
+{
+    T value;
+    std::memcpy(&value, pArg, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void appendNumber(std::string& out, T value, int base = 10)
+{
+    char buffer[64];
+    std::to_chars_result result;
+    if constexpr(std::is_floating_point_v<T>)
+        result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    else
+        result = std::to_chars(buffer, buffer + sizeof(buffer), value, base);
+    out.append(buffer, result.ptr);
+}
+
+size_t getLogArgSize(LogArgType type, const uint8_t* pArg)
+{
+    switch(type)
+    {
+    case LogArgType::BOOL:
+    case LogArgType::CHAR:
+    case LogArgType::I8:
+    case LogArgType::U8:
+        return 1;
+    case LogArgType::I16:
+    case LogArgType::U16:
+        return 2;
+    case LogArgType::I32:
+    case LogArgType::U32:
+    case LogArgType::F32:
+        return 4;
+    case LogArgType::I64:
+    case LogArgType::U64:
+    case LogArgType::F64:
+    case LogArgType::POINTER:
+        return 8;
+    case LogArgType::STRING:
+        return sizeof(uint32_t) + readLogArg<uint32_t>(pArg);
+    }
+    return 0;
+}
+}  // namespace
+
+const uint8_t* appendLogArg(LogArgType type, const uint8_t* pArg, std::string& out)
+{
+    switch(type)
+    {
+    case LogArgType::BOOL:
+        out.append(readLogArg<bool>(pArg) ? "true" : "false");
+        break;
+    case LogArgType::CHAR:
+        out.push_back(readLogArg<char>(pArg));
+        break;
+    case LogArgType::I8:
+        appendNumber(out, readLogArg<int8_t>(pArg));
+        break;
+    case LogArgType::I16:
+        appendNumber(out, readLogArg<int16_t>(pArg));
+        break;
+    case LogArgType::I32:
+        appendNumber(out, readLogArg<int32_t>(pArg));
+        break;
+    case LogArgType::I64:
+        appendNumber(out, readLogArg<int64_t>(pArg));
+        break;
+    case LogArgType::U8:
+        appendNumber(out, readLogArg<uint8_t>(pArg));
+        break;
+    case LogArgType::U16:
+        appendNumber(out, readLogArg<uint16_t>(pArg));
+        break;
+    case LogArgType::U32:
+        appendNumber(out, readLogArg<uint32_t>(pArg));
+        break;
+    case LogArgType::U64:
+        appendNumber(out, readLogArg<uint64_t>(pArg));
+        break;
+    case LogArgType::F32:
+        appendNumber(out, readLogArg<float>(pArg));
+        break;
+    case LogArgType::F64:
+        appendNumber(out, readLogArg<double>(pArg));
+        break;
+    case LogArgType::POINTER:
+        out.append("0x");
+        appendNumber(out, readLogArg<uint64_t>(pArg), 16);
+        break;
+    case LogArgType::STRING:
+        out.append(reinterpret_cast<const char*>(pArg + sizeof(uint32_t)), readLogArg<uint32_t>(pArg));
+        break;
+    }
+    return pArg + getLogArgSize(type, pArg);
+}
+
+size_t getLogArgsSize(const LogSignature& signature, const uint8_t* pArgs)
+{
+    const uint8_t* pArg = pArgs;
+    for(uint32_t i = 0; i < signature.count; ++i)
+        pArg += getLogArgSize(signature.pTypes[i], pArg);
+    return pArg - pArgs;
+}
+
+void formatLogMessage(std::string_view fmt, const LogSignature& signature, const uint8_t* pArgs, std::string& out)
+{
+    for(uint32_t i = 0; i < signature.count; ++i)
+    {
+        size_t pos = fmt.find("{}");
+        if(pos == std::string_view::npos)
+            break;
+        out.append(fmt.substr(0, pos));
+        fmt.remove_prefix(pos + 2);
+        pArgs = appendLogArg(signature.pTypes[i], pArgs, out);
+    }
+    out.append(fmt);
+}
+}  // namespace aph
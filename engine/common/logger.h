@@ -2,14 +2,23 @@
 #define LOGGER_H_
 
 #include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstring>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -81,6 +90,354 @@ private:
     std::string              _name;
 };
 
+template <typename T>
+Logger& operator<<(Logger& l, const T& s)
+{
+    if(l._message_level <= Logger::_loglevel())
+    {
+        l._fac << s;
+        return l;
+    }
+    return l;
+}
+
+// Type tag of an async log argument, also written to binary log files.
+enum class LogArgType : uint8_t
+{
+    BOOL,
+    CHAR,
+    I8,
+    I16,
+    I32,
+    I64,
+    U8,
+    U16,
+    U32,
+    U64,
+    F32,
+    F64,
+    POINTER,
+    STRING,
+};
+
+// The argument types of one log call site, shared by every record it produces.
+struct LogSignature
+{
+    const LogArgType* pTypes;
+    uint32_t          count;
+};
+
+// Appends fmt to out with every "{}" replaced by the next argument packed in pArgs.
+void formatLogMessage(std::string_view fmt, const LogSignature& signature, const uint8_t* pArgs, std::string& out);
+
+// Appends one argument as text and returns the start of the next one.
+const uint8_t* appendLogArg(LogArgType type, const uint8_t* pArg, std::string& out);
+
+// Byte size of the packed arguments starting at pArgs.
+size_t getLogArgsSize(const LogSignature& signature, const uint8_t* pArgs);
+
+namespace detail
+{
+template <typename T>
+constexpr LogArgType getLogArgType()
+{
+    if constexpr(std::is_same_v<T, bool>)
+        return LogArgType::BOOL;
+    else if constexpr(std::is_same_v<T, char>)
+        return LogArgType::CHAR;
+    else if constexpr(std::is_floating_point_v<T>)
+        return sizeof(T) == 4 ? LogArgType::F32 : LogArgType::F64;
+    else if constexpr(std::is_signed_v<T>)
+    {
+        constexpr LogArgType types[] = { LogArgType::I8, LogArgType::I16, LogArgType::I32, LogArgType::I64 };
+        return types[sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : 3];
+    }
+    else
+    {
+        constexpr LogArgType types[] = { LogArgType::U8, LogArgType::U16, LogArgType::U32, LogArgType::U64 };
+        return types[sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : 3];
+    }
+}
+
+template <typename T, typename = void>
+struct LogWireType
+{
+    using type = std::conditional_t<std::is_same_v<T, long double>, double, T>;
+};
+
+template <typename T>
+struct LogWireType<T, std::enable_if_t<std::is_enum_v<T>>>
+{
+    using type = std::underlying_type_t<T>;
+};
+
+template <typename T>
+struct LogWireType<T, std::enable_if_t<std::is_pointer_v<T>>>
+{
+    using type = uint64_t;
+};
+
+// Packs a log argument into a record on the caller's thread. Strings are copied, everything else is stored by value;
+// enums as their underlying integer and pointers as 64 bit addresses.
+template <typename T>
+struct LogArgCodec
+{
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>,
+                  "Unsupported async log argument type");
+
+    using WireType = typename LogWireType<T>::type;
+
+    static constexpr LogArgType TYPE = std::is_pointer_v<T> ? LogArgType::POINTER : getLogArgType<WireType>();
+
+    static size_t   size(const T&) { return sizeof(WireType); }
+    static uint8_t* encode(uint8_t* pDst, const T& value)
+    {
+        WireType wire;
+        if constexpr(std::is_pointer_v<T>)
+            wire = reinterpret_cast<uintptr_t>(value);
+        else
+            wire = static_cast<WireType>(value);
+        std::memcpy(pDst, &wire, sizeof(wire));
+        return pDst + sizeof(wire);
+    }
+};
+
+struct LogString
+{
+};
+
+template <>
+struct LogArgCodec<LogString>
+{
+    static constexpr LogArgType TYPE = LogArgType::STRING;
+
+    static size_t   size(std::string_view value) { return sizeof(uint32_t) + value.size(); }
+    static uint8_t* encode(uint8_t* pDst, std::string_view value)
+    {
+        auto length = static_cast<uint32_t>(value.size());
+        std::memcpy(pDst, &length, sizeof(length));
+        std::memcpy(pDst + sizeof(length), value.data(), length);
+        return pDst + sizeof(length) + length;
+    }
+};
+
+template <typename T>
+using LogStoredType = std::conditional_t<std::is_convertible_v<const T&, std::string_view>, LogString, T>;
+
+template <typename... TStored>
+struct LogSignatureOf
+{
+    static constexpr LogArgType   types[sizeof...(TStored) + 1] = { LogArgCodec<TStored>::TYPE..., LogArgType::BOOL };
+    static constexpr LogSignature value = { types, sizeof...(TStored) };
+};
+}  // namespace detail
+
+// Layout of the files an AsyncLogger writes in LogOutputFormat::BINARY, all fields little endian.
+// The file starts with a LogFileHeader followed by records, each one a LogRecordHeader and LogRecordHeader::size
+// bytes of payload. A FORMAT record introduces a format string and its argument types once, the MESSAGE records of
+// that call site only refer to it by id and carry the packed arguments.
+namespace binlog
+{
+constexpr char     MAGIC[8] = { 'A', 'P', 'H', 'B', 'L', 'O', 'G', '\0' };
+constexpr uint32_t VERSION  = 1;
+
+struct LogFileHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    // Wall clock time of the logger's creation, record timestamps are relative to it.
+    int64_t startTimeNs;
+};
+
+enum class RecordType : uint16_t
+{
+    // Payload: uint32 format length, format bytes, uint32 argument count, one LogArgType per argument.
+    FORMAT,
+    // Payload: the packed arguments.
+    MESSAGE,
+    // Payload: uint64 number of messages dropped since the previous DROPPED record.
+    DROPPED,
+};
+
+struct LogRecordHeader
+{
+    uint32_t   size;
+    RecordType type;
+    uint16_t   level;
+    uint32_t   formatId;
+    uint32_t   threadIndex;
+    uint64_t   timestampNs;
+};
+static_assert(sizeof(LogFileHeader) == 24 && sizeof(LogRecordHeader) == 24);
+}  // namespace binlog
+
+enum class LogOverflowPolicy
+{
+    // Drops the message and counts it, the sink reports the number of dropped messages.
+    DROP,
+    // Waits for the sink thread to make room.
+    BLOCK,
+};
+
+enum class LogOutputFormat
+{
+    // One formatted line per message.
+    TEXT,
+    // The binlog layout, decoded to text or JSON offline by the log_decoder tool. Skips all formatting.
+    BINARY,
+};
+
+// Logger that keeps formatting and I/O off the calling thread.
+// A log call only stores a compact record (timestamp, level, format string pointer, packed arguments) in the calling
+// thread's lock-free ring; a background sink thread formats the records of all threads in timestamp order and
+// writes them out. Format strings must outlive the logger (string literals) and use "{}" placeholders.
+class AsyncLogger
+{
+public:
+    static constexpr size_t DEFAULT_RING_SIZE = 256 * 1024;
+
+    // A BINARY logger needs out to be opened in binary mode.
+    AsyncLogger(std::ostream& out, LogOverflowPolicy policy = LogOverflowPolicy::DROP,
+                size_t ringSize = DEFAULT_RING_SIZE, LogOutputFormat format = LogOutputFormat::TEXT);
+
+    // Drains every pending record before returning.
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&)            = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Engine-wide logger writing to std::cout.
+    static AsyncLogger& GetDefault();
+
+    template <typename... TArgs>
+    void log(unsigned level, const char* fmt, const TArgs&... args)
+    {
+        if(level > Logger::_loglevel())
+            return;
+
+        const LogSignature* pSignature = &detail::LogSignatureOf<detail::LogStoredType<TArgs>...>::value;
+        size_t              size       = sizeof(RecordHeader);
+        ((size += detail::LogArgCodec<detail::LogStoredType<TArgs>>::size(args)), ...);
+
+        uint8_t* pArgs = beginRecord(level, fmt, pSignature, size);
+        if(!pArgs)
+            return;
+        ((pArgs = detail::LogArgCodec<detail::LogStoredType<TArgs>>::encode(pArgs, args)), ...);
+        endRecord();
+    }
+
+    // Blocks until everything logged before the call has been written out.
+    void flush();
+
+    uint64_t getDroppedCount() const { return m_droppedTotal.load(std::memory_order_relaxed); }
+
+private:
+    struct RecordHeader
+    {
+        uint64_t            timestamp;
+        const LogSignature* pSignature;  // Null for the padding that skips the end of the ring.
+        const char*         fmt;
+        uint32_t            size;
+        uint32_t            level;
+    };
+
+    struct ThreadRing;
+
+    uint8_t*    beginRecord(unsigned level, const char* fmt, const LogSignature* pSignature, size_t size);
+    void        endRecord();
+    ThreadRing* getThreadRing();
+    void        sinkLoop();
+    void        drain(const std::vector<std::shared_ptr<ThreadRing>>& rings);
+    void        appendPrefix(const RecordHeader& header, uint32_t threadIndex);
+    void        appendBinary(const RecordHeader& header, uint32_t threadIndex);
+    void        appendBinaryRecord(binlog::RecordType type, uint16_t level, uint32_t formatId, uint32_t threadIndex,
+                                   uint64_t timestampNs, const void* pPayload, size_t payloadSize);
+
+private:
+    const uint32_t          m_id;
+    std::ostream&           m_out;
+    LogOverflowPolicy       m_policy;
+    LogOutputFormat         m_format;
+    size_t                  m_ringSize;
+    std::atomic<uint64_t>   m_droppedTotal{ 0 };
+    uint64_t                m_droppedReported = 0;
+
+    std::mutex                               m_mutex;
+    std::condition_variable                  m_wakeSink;
+    std::condition_variable                  m_flushed;
+    std::vector<std::shared_ptr<ThreadRing>> m_rings;
+    uint64_t                                 m_flushRequested = 0;
+    uint64_t                                 m_flushCompleted = 0;
+    bool                                     m_stop           = false;
+    // Set by producers that need room in their ring before the next period, cleared by the sink as it drains.
+    std::atomic_bool                         m_drainRequested{ false };
+
+    // Only touched by the sink thread.
+    struct PendingRecord
+    {
+        const RecordHeader* pHeader;
+        uint32_t            threadIndex;
+    };
+    std::chrono::system_clock::time_point m_wallStart;
+    std::chrono::steady_clock::time_point m_steadyStart;
+    std::vector<PendingRecord>            m_batch;
+    std::vector<size_t>                   m_batchHeads;
+    std::string                           m_text;
+    time_t                                m_cachedSecond = -1;
+    std::string                           m_cachedTime;
+    uint32_t                              m_threadCount = 0;
+    // Ids of the format strings already described in the binary output, by call site.
+    std::map<std::pair<const char*, const LogSignature*>, uint32_t> m_formatIds;
+    std::thread                                                     m_sink;
+};
+
+// Log calls above this level are compiled out: their arguments are never evaluated. The runtime level set through
+// Logger::set_log_level() still filters whatever is compiled in.
+#ifndef APH_LOG_COMPILE_LEVEL
+#    define APH_LOG_COMPILE_LEVEL LOG_DEBUG
+#endif
+
+#define LOG_ASYNC(level, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if constexpr((level) <= APH_LOG_COMPILE_LEVEL)                  \
+            ::aph::AsyncLogger::GetDefault().log((level), __VA_ARGS__); \
+    } while(0)
+
+#if APH_LOG_COMPILE_LEVEL >= LOG_ERR
+#    define LOG_ASYNC_ERROR(...) LOG_ASYNC(LOG_ERR, __VA_ARGS__)
+#else
+#    define LOG_ASYNC_ERROR(...) ((void)0)
+#endif
+#if APH_LOG_COMPILE_LEVEL >= LOG_WARN
+#    define LOG_ASYNC_WARN(...) LOG_ASYNC(LOG_WARN, __VA_ARGS__)
+#else
+#    define LOG_ASYNC_WARN(...) ((void)0)
+#endif
+#if APH_LOG_COMPILE_LEVEL >= LOG_INFO
+#    define LOG_ASYNC_INFO(...) LOG_ASYNC(LOG_INFO, __VA_ARGS__)
+#else
+#    define LOG_ASYNC_INFO(...) ((void)0)
+#endif
+#if APH_LOG_COMPILE_LEVEL >= LOG_TIME
+#    define LOG_ASYNC_TIME(...) LOG_ASYNC(LOG_TIME, __VA_ARGS__)
+#else
+#    define LOG_ASYNC_TIME(...) ((void)0)
+#endif
+#if APH_LOG_COMPILE_LEVEL >= LOG_DEBUG
+#    define LOG_ASYNC_DEBUG(...) LOG_ASYNC(LOG_DEBUG, __VA_ARGS__)
+#else
+#    define LOG_ASYNC_DEBUG(...) ((void)0)
+#endif
+
+// Streams into a Logger only if level passes both filters, e.g. LOG_STREAM(log, LOG_DEBUG) << "value " << x;
+// Nothing to the right is evaluated otherwise. Safe inside an unbraced if/else.
+#define LOG_STREAM(logger, level)                    \
+    if constexpr((level) > APH_LOG_COMPILE_LEVEL) {} \
+    else if((level) > ::aph::Logger::_loglevel()) {} \
+    else (logger)(level)
+
 }  // namespace aph
 
 #endif  // LOGGER_H_
@@ -0,0 +1,257 @@
+#ifndef MPMCQUEUE_H_
+#define MPMCQUEUE_H_
+
+#include "common/common.h"
+
+#include <new>
+
+namespace aph
+{
+// Bounded lock-free multi-producer multi-consumer ring (Dmitry Vyukov's design).
+// Every cell carries a sequence number telling producers and consumers whose turn it is, so a push or pop costs a
+// single CAS on the shared head/tail counter and never touches a lock. Head, tail and each cell sit on their own
+// cache line.
+template <typename T>
+class MPMCQueue
+{
+public:
+    // The capacity is rounded up to a power of two.
+    explicit MPMCQueue(size_t capacity) : m_mask(roundUpPowerOfTwo(std::max<size_t>(capacity, 2)) - 1)
+    {
+        m_cells = std::make_unique<Cell[]>(m_mask + 1);
+        for(size_t i = 0; i <= m_mask; ++i)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MPMCQueue()
+    {
+        size_t enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+        for(size_t pos = m_dequeuePos.load(std::memory_order_relaxed); pos != enqueuePos; ++pos)
+        {
+            std::launder(reinterpret_cast<T*>(m_cells[pos & m_mask].storage))->~T();
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&)            = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    // Returns false if the queue is full.
+    template <typename U>
+    bool TryPush(U&& item)
+    {
+        Cell*  pCell;
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        while(true)
+        {
+            pCell           = &m_cells[pos & m_mask];
+            size_t   seq    = pCell->sequence.load(std::memory_order_acquire);
+            intptr_t diff   = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if(diff == 0)
+            {
+                if(m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if(diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        new(pCell->storage) T(std::forward<U>(item));
+        pCell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is empty.
+    bool TryPop(T& item)
+    {
+        Cell*  pCell;
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        while(true)
+        {
+            pCell           = &m_cells[pos & m_mask];
+            size_t   seq    = pCell->sequence.load(std::memory_order_acquire);
+            intptr_t diff   = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if(diff == 0)
+            {
+                if(m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if(diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        T* pItem = std::launder(reinterpret_cast<T*>(pCell->storage));
+        item     = std::move(*pItem);
+        pItem->~T();
+        pCell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently.
+    size_t Size() const
+    {
+        size_t enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+        return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+    }
+    bool   Empty() const { return Size() == 0; }
+    size_t GetCapacity() const { return m_mask + 1; }
+
+private:
+    struct alignas(64) Cell
+    {
+        std::atomic<size_t>  sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    static size_t roundUpPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while(result < value)
+            result <<= 1;
+        return result;
+    }
+
+    const size_t            m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+
+    alignas(64) std::atomic<size_t> m_enqueuePos{ 0 };
+    alignas(64) std::atomic<size_t> m_dequeuePos{ 0 };
+};
+
+// MPMCQueue with blocking Push/Pop. A blocked thread spins for a while before parking on a condition variable, and
+// the other side only takes the mutex to notify when somebody is actually parked.
+template <typename T>
+class BlockingMPMCQueue
+{
+public:
+    // Spinning only pays off if the other side can make progress meanwhile, so it is off on a single core.
+    explicit BlockingMPMCQueue(size_t capacity, uint32_t spinCount = 128) :
+        m_queue(capacity),
+        m_spinCount(std::thread::hardware_concurrency() > 1 ? spinCount : 0)
+    {
+    }
+
+    // Wakes every blocked thread, Push and Pop return false from then on once they would block.
+    void Invalidate()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_valid = false;
+        }
+        m_notEmpty.condition.notify_all();
+        m_notFull.condition.notify_all();
+    }
+    bool IsValid() const { return m_valid; }
+
+    template <typename U>
+    bool TryPush(U&& item)
+    {
+        if(!m_queue.TryPush(std::forward<U>(item)))
+            return false;
+        wake(m_notEmpty);
+        return true;
+    }
+
+    bool TryPop(T& item)
+    {
+        if(!m_queue.TryPop(item))
+            return false;
+        wake(m_notFull);
+        return true;
+    }
+
+    // Blocks while the queue is full.
+    template <typename U>
+    bool Push(U&& item)
+    {
+        // The item is only moved from on success, so retrying with the same reference is safe.
+        if(!block(m_notFull, [&]() { return m_queue.TryPush(std::forward<U>(item)); }))
+            return false;
+        wake(m_notEmpty);
+        return true;
+    }
+
+    // Blocks while the queue is empty.
+    bool Pop(T& item)
+    {
+        if(!block(m_notEmpty, [&]() { return m_queue.TryPop(item); }))
+            return false;
+        wake(m_notFull);
+        return true;
+    }
+
+    size_t Size() const { return m_queue.Size(); }
+    bool   Empty() const { return m_queue.Empty(); }
+    size_t GetCapacity() const { return m_queue.GetCapacity(); }
+
+private:
+    struct WaitSlot
+    {
+        alignas(64) std::atomic<uint32_t> waiters{ 0 };
+        std::condition_variable           condition;
+    };
+
+    void wake(WaitSlot& slot)
+    {
+        // Orders the preceding push/pop before reading the waiter count, pairs with the fence in block().
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(slot.waiters.load(std::memory_order_relaxed) > 0)
+        {
+            // An empty critical section is enough: a waiter checks its predicate under the mutex, so once we got it
+            // the waiter is either already parked or will see our item.
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+            }
+            slot.condition.notify_one();
+        }
+    }
+
+    template <typename F>
+    bool block(WaitSlot& slot, F&& attempt)
+    {
+        for(uint32_t spin = 0; spin < m_spinCount; ++spin)
+        {
+            if(attempt())
+                return true;
+            APH_CPU_PAUSE();
+        }
+
+        // Register as a waiter before the last attempt. wake() reads the counter after its push/pop, so one of the two
+        // sides always sees the other.
+        slot.waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool done = attempt();
+        if(!done)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            slot.condition.wait(lock, [&]() { return (done = attempt()) || !m_valid; });
+        }
+        slot.waiters.fetch_sub(1, std::memory_order_relaxed);
+        return done;
+    }
+
+private:
+    MPMCQueue<T>            m_queue;
+    uint32_t                m_spinCount;
+    std::atomic_bool        m_valid{ true };
+    std::mutex              m_mutex;
+    WaitSlot                m_notEmpty;
+    WaitSlot                m_notFull;
+};
+}  // namespace aph
+
+#endif  // MPMCQUEUE_H_
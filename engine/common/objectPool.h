@@ -0,0 +1,224 @@
+#ifndef OBJECT_POOL_H_
+#define OBJECT_POOL_H_
+
+#include "common/spinlock.h"
+
+namespace aph
+{
+// Typed pool: objects live in fixed-size chunks (slabs) and freed slots are recycled through a free list, so objects
+// created together stay packed together and creating one never touches the general-purpose heap once the pool has
+// grown to its peak.
+// Objects can also be referred to by Handle, which detects use after destroy through a per-slot generation.
+// create() and destroy() are thread safe. get(), getHandle() and forEach() must not race with create().
+template <typename T, uint32_t ChunkSize = 256>
+class ObjectPool
+{
+public:
+    struct Handle
+    {
+        uint32_t index      = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool isValid() const { return index != UINT32_MAX; }
+        bool operator==(const Handle& other) const = default;
+    };
+
+    ObjectPool() = default;
+    ~ObjectPool()
+    {
+        forEach([](T& object) { object.~T(); });
+    }
+
+    ObjectPool(const ObjectPool&)            = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... TArgs>
+    T* create(TArgs&&... args)
+    {
+        Slot* pSlot = nullptr;
+        {
+            LockGuard<AdaptiveMutex> lock(m_lock);
+            if(m_freeHead == INVALID_INDEX)
+            {
+                addChunk();
+            }
+            pSlot      = getSlot(m_freeHead);
+            m_freeHead = pSlot->nextFree;
+            ++m_size;
+        }
+
+        T* pObject = nullptr;
+        try
+        {
+            pObject = new(pSlot->storage) T(std::forward<TArgs>(args)...);
+        }
+        catch(...)
+        {
+            release(pSlot);
+            throw;
+        }
+        pSlot->alive = true;
+        return pObject;
+    }
+
+    void destroy(T* pObject)
+    {
+        if(!pObject)
+        {
+            return;
+        }
+        Slot* pSlot = toSlot(pObject);
+        assert(pSlot->alive);
+        pObject->~T();
+        pSlot->alive = false;
+        release(pSlot);
+    }
+
+    Handle getHandle(const T* pObject) const
+    {
+        const Slot* pSlot = toSlot(pObject);
+        return { pSlot->index, pSlot->generation };
+    }
+
+    // Null if the object the handle refers to has been destroyed.
+    T* get(Handle handle) const
+    {
+        if(handle.index >= m_chunks.size() * ChunkSize)
+        {
+            return nullptr;
+        }
+        Slot* pSlot = getSlot(handle.index);
+        if(!pSlot->alive || pSlot->generation != handle.generation)
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(pSlot->storage);
+    }
+
+    // Visits the live objects in memory order.
+    template <typename F>
+    void forEach(F&& func)
+    {
+        for(auto& chunk : m_chunks)
+        {
+            for(uint32_t idx = 0; idx < ChunkSize; ++idx)
+            {
+                if(chunk[idx].alive)
+                {
+                    func(*reinterpret_cast<T*>(chunk[idx].storage));
+                }
+            }
+        }
+    }
+
+    size_t getSize() const { return m_size; }
+    size_t getCapacity() const { return m_chunks.size() * ChunkSize; }
+
+private:
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    // The storage comes first, so a T* is also a pointer to its slot.
+    struct Slot
+    {
+        alignas(T) std::byte storage[sizeof(T)];
+        uint32_t index      = 0;
+        uint32_t generation = 0;
+        uint32_t nextFree   = INVALID_INDEX;
+        bool     alive      = false;
+    };
+
+    static Slot*       toSlot(T* pObject) { return reinterpret_cast<Slot*>(pObject); }
+    static const Slot* toSlot(const T* pObject) { return reinterpret_cast<const Slot*>(pObject); }
+    Slot*              getSlot(uint32_t index) const { return &m_chunks[index / ChunkSize][index % ChunkSize]; }
+
+    void release(Slot* pSlot)
+    {
+        LockGuard<AdaptiveMutex> lock(m_lock);
+        ++pSlot->generation;
+        pSlot->nextFree = m_freeHead;
+        m_freeHead      = pSlot->index;
+        --m_size;
+    }
+
+    void addChunk()
+    {
+        auto     chunk = std::make_unique<Slot[]>(ChunkSize);
+        uint32_t base  = static_cast<uint32_t>(m_chunks.size()) * ChunkSize;
+        // Link in reverse so the slots are handed out in address order.
+        for(uint32_t idx = ChunkSize; idx-- > 0;)
+        {
+            chunk[idx].index    = base + idx;
+            chunk[idx].nextFree = m_freeHead;
+            m_freeHead          = base + idx;
+        }
+        m_chunks.push_back(std::move(chunk));
+    }
+
+private:
+    std::vector<std::unique_ptr<Slot[]>> m_chunks;
+    uint32_t                             m_freeHead = INVALID_INDEX;
+    size_t                               m_size     = 0;
+    AdaptiveMutex                        m_lock;
+};
+
+namespace detail
+{
+template <size_t Size, size_t Alignment>
+struct alignas(Alignment) PoolStorage
+{
+    std::byte data[Size];
+};
+}  // namespace detail
+
+// std allocator drawing single-object allocations from a process-wide ObjectPool shared by all types of the same
+// size and alignment. With std::allocate_shared the object and its control block come from one pooled slot.
+template <typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&)
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        if(count != 1)
+        {
+            return std::allocator<T>().allocate(count);
+        }
+        return reinterpret_cast<T*>(getPool().create());
+    }
+
+    void deallocate(T* pObject, size_t count)
+    {
+        if(count != 1)
+        {
+            std::allocator<T>().deallocate(pObject, count);
+            return;
+        }
+        getPool().destroy(reinterpret_cast<Storage*>(pObject));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const
+    {
+        return true;
+    }
+
+private:
+    using Storage = detail::PoolStorage<sizeof(T), alignof(T)>;
+
+    static ObjectPool<Storage>& getPool()
+    {
+        // Leaked on purpose: shared objects may still be released during static destruction.
+        static auto* pPool = new ObjectPool<Storage>();
+        return *pPool;
+    }
+};
+}  // namespace aph
+
+#endif  // OBJECT_POOL_H_
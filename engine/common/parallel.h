@@ -0,0 +1,179 @@
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include "common/allocationTracker.h"
+#include "common/threadPool.h"
+
+namespace aph
+{
+// Ranges of at most this many iterations run serially on the calling thread.
+constexpr size_t PARALLEL_DEFAULT_GRAIN_SIZE = 1024;
+
+namespace detail
+{
+// Guided self-scheduling: every claim takes a share of the remaining iterations, never less than the grain size.
+// Chunks start large and shrink towards the end of the range so late or slow participants still balance out.
+class ChunkDispenser
+{
+public:
+    ChunkDispenser(size_t begin, size_t end, size_t grainSize, uint32_t participants) :
+        m_next(begin),
+        m_end(end),
+        m_grainSize(grainSize),
+        m_divisor(2 * static_cast<size_t>(participants))
+    {
+    }
+
+    bool next(size_t& chunkBegin, size_t& chunkEnd)
+    {
+        size_t current = m_next.load(std::memory_order_relaxed);
+        while(current < m_end)
+        {
+            size_t size = std::max(m_grainSize, (m_end - current) / m_divisor);
+            size_t stop = std::min(m_end, current + size);
+            if(m_next.compare_exchange_weak(current, stop, std::memory_order_relaxed))
+            {
+                chunkBegin = current;
+                chunkEnd   = stop;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> m_next;
+    size_t m_end;
+    size_t m_grainSize;
+    size_t m_divisor;
+};
+
+// Number of pool tasks to spawn besides the calling thread, zero means the range should run serially.
+inline uint32_t getHelperCount(size_t count, size_t grainSize, ThreadPool* pPool)
+{
+    if(!pPool || count <= grainSize)
+    {
+        return 0;
+    }
+    size_t chunkCount = (count + grainSize - 1) / grainSize;
+    return static_cast<uint32_t>(std::min<size_t>(pPool->GetThreadCount(), chunkCount - 1));
+}
+
+// Runs body(slot) on the calling thread (slot 0) and on helperCount pool tasks, then waits for all of them.
+// The helpers charge their allocations to the calling thread's tag.
+template <typename F>
+void forkJoin(uint32_t helperCount, F&& body, ThreadPool* pPool)
+{
+    WaitGroup     group;
+    AllocationTag tag = AllocationTracker::GetCurrentTag();
+    for(uint32_t slot = 1; slot <= helperCount; ++slot)
+    {
+        pPool->AddTask(
+            [&body, slot, tag]() {
+                AllocationScope allocationScope(tag);
+                body(slot);
+            },
+            &group);
+    }
+    body(0);
+    pPool->Wait(group);
+}
+}  // namespace detail
+
+// Calls func(chunkBegin, chunkEnd) over disjoint sub-ranges covering [begin, end).
+// Falls back to a single serial call when the range is not larger than grainSize or the pool has no workers.
+template <typename F>
+void parallelForRange(size_t begin, size_t end, F&& func, size_t grainSize = PARALLEL_DEFAULT_GRAIN_SIZE,
+                      ThreadPool* pPool = ThreadPool::GetDefault())
+{
+    if(end <= begin)
+    {
+        return;
+    }
+
+    grainSize            = std::max<size_t>(grainSize, 1);
+    uint32_t helperCount = detail::getHelperCount(end - begin, grainSize, pPool);
+    if(helperCount == 0)
+    {
+        func(begin, end);
+        return;
+    }
+
+    detail::ChunkDispenser dispenser(begin, end, grainSize, helperCount + 1);
+    detail::forkJoin(
+        helperCount,
+        [&](uint32_t) {
+            size_t chunkBegin = 0;
+            size_t chunkEnd   = 0;
+            while(dispenser.next(chunkBegin, chunkEnd))
+            {
+                func(chunkBegin, chunkEnd);
+            }
+        },
+        pPool);
+}
+
+// Calls func(index) for every index in [begin, end).
+template <typename F>
+void parallelFor(size_t begin, size_t end, F&& func, size_t grainSize = PARALLEL_DEFAULT_GRAIN_SIZE,
+                 ThreadPool* pPool = ThreadPool::GetDefault())
+{
+    parallelForRange(
+        begin, end,
+        [&func](size_t chunkBegin, size_t chunkEnd) {
+            for(size_t idx = chunkBegin; idx < chunkEnd; ++idx)
+            {
+                func(idx);
+            }
+        },
+        grainSize, pPool);
+}
+
+// Folds [begin, end) into a single value. func(chunkBegin, chunkEnd, partial) returns partial accumulated over the
+// chunk, reduce(a, b) combines two partial results. Partials are combined in an unspecified order, so reduce must be
+// associative and commutative and identity must be its neutral element.
+template <typename T, typename F, typename R>
+T parallelReduce(size_t begin, size_t end, T identity, F&& func, R&& reduce,
+                 size_t grainSize = PARALLEL_DEFAULT_GRAIN_SIZE, ThreadPool* pPool = ThreadPool::GetDefault())
+{
+    if(end <= begin)
+    {
+        return identity;
+    }
+
+    grainSize            = std::max<size_t>(grainSize, 1);
+    uint32_t helperCount = detail::getHelperCount(end - begin, grainSize, pPool);
+    if(helperCount == 0)
+    {
+        return func(begin, end, std::move(identity));
+    }
+
+    struct alignas(64) Partial
+    {
+        T value;
+    };
+    std::vector<Partial> partials(helperCount + 1, Partial{ identity });
+
+    detail::ChunkDispenser dispenser(begin, end, grainSize, helperCount + 1);
+    detail::forkJoin(
+        helperCount,
+        [&](uint32_t slot) {
+            size_t chunkBegin = 0;
+            size_t chunkEnd   = 0;
+            while(dispenser.next(chunkBegin, chunkEnd))
+            {
+                partials[slot].value = func(chunkBegin, chunkEnd, std::move(partials[slot].value));
+            }
+        },
+        pPool);
+
+    T result = std::move(identity);
+    for(auto& partial : partials)
+    {
+        result = reduce(std::move(result), std::move(partial.value));
+    }
+    return result;
+}
+}  // namespace aph
+
+#endif  // PARALLEL_H_
@@ -0,0 +1,269 @@
+#include "profiler.h"
+#include "spinlock.h"
+
+namespace aph
+{
+namespace
+{
+// Single-producer single-consumer ring of finished zones, written by its thread and drained by BeginFrame().
+struct ThreadBuffer
+{
+    static constexpr uint64_t MASK = Profiler::THREAD_ZONE_CAPACITY - 1;
+    static_assert((Profiler::THREAD_ZONE_CAPACITY & MASK) == 0, "capacity must be a power of two");
+
+    explicit ThreadBuffer(uint32_t index) : zones(new ProfileZone[Profiler::THREAD_ZONE_CAPACITY]), threadIndex(index)
+    {
+    }
+
+    std::unique_ptr<ProfileZone[]> zones;
+    const uint32_t                 threadIndex;
+    std::string                    name;
+
+    alignas(64) std::atomic<uint64_t> head{ 0 };
+    alignas(64) std::atomic<uint64_t> tail{ 0 };
+};
+
+// Thread buffers, thread names, the last frame and the capture, guarded by g_lock. Buffers of exited threads are
+// kept so their names stay in the trace.
+AdaptiveMutex                              g_lock;
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+std::vector<ProfileZone>                   g_lastFrame;
+std::vector<ProfileZone>                   g_capture;
+std::atomic_bool                           g_capturing{ false };
+std::atomic<uint64_t>                      g_dropped{ 0 };
+
+// Must be called with g_lock held.
+std::shared_ptr<ThreadBuffer> createBuffer(std::string name)
+{
+    auto pBuffer  = std::make_shared<ThreadBuffer>(static_cast<uint32_t>(g_buffers.size()));
+    pBuffer->name = std::move(name);
+    g_buffers.push_back(pBuffer);
+    return pBuffer;
+}
+
+ThreadBuffer* getThreadBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> tl_buffer;
+    if(!tl_buffer)
+    {
+        LockGuard<AdaptiveMutex> lock(g_lock);
+        tl_buffer = createBuffer("Thread " + std::to_string(g_buffers.size()));
+    }
+    return tl_buffer.get();
+}
+
+void pushZone(ThreadBuffer* pBuffer, const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth)
+{
+    uint64_t head = pBuffer->head.load(std::memory_order_relaxed);
+    if(head - pBuffer->tail.load(std::memory_order_acquire) >= Profiler::THREAD_ZONE_CAPACITY)
+    {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    pBuffer->zones[head & ThreadBuffer::MASK] = {
+        .name        = name,
+        .startNs     = startNs,
+        .durationNs  = endNs - startNs,
+        .threadIndex = pBuffer->threadIndex,
+        .depth       = depth,
+    };
+    pBuffer->head.store(head + 1, std::memory_order_release);
+}
+
+void appendJsonString(std::string& out, std::string_view str)
+{
+    out.push_back('"');
+    for(char c : str)
+    {
+        if(c == '"' || c == '\\')
+            out.push_back('\\');
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+// Chrome trace timestamps are microseconds.
+void appendMicroseconds(std::string& out, uint64_t ns)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", static_cast<double>(ns) / 1000.0);
+    out.append(buffer);
+}
+}  // namespace
+
+void Profiler::SetThreadName(std::string_view name)
+{
+    if constexpr(!IsEnabled())
+    {
+        return;
+    }
+
+    auto*                    pBuffer = getThreadBuffer();
+    LockGuard<AdaptiveMutex> lock(g_lock);
+    pBuffer->name = name;
+}
+
+void Profiler::RecordZone(const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth)
+{
+    pushZone(getThreadBuffer(), name, startNs, endNs, depth);
+}
+
+uint32_t Profiler::CreateTrack(std::string_view name)
+{
+    LockGuard<AdaptiveMutex> lock(g_lock);
+    return createBuffer(std::string(name))->threadIndex;
+}
+
+void Profiler::RecordTrackZone(uint32_t track, const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth)
+{
+    ThreadBuffer* pBuffer = nullptr;
+    {
+        // Only guards the lookup, new threads may grow the buffer list meanwhile.
+        LockGuard<AdaptiveMutex> lock(g_lock);
+        pBuffer = g_buffers[track].get();
+    }
+    pushZone(pBuffer, name, startNs, endNs, depth);
+}
+
+void Profiler::BeginFrame()
+{
+    if constexpr(!IsEnabled())
+    {
+        return;
+    }
+
+    LockGuard<AdaptiveMutex> lock(g_lock);
+    g_lastFrame.clear();
+    for(auto& pBuffer : g_buffers)
+    {
+        uint64_t tail = pBuffer->tail.load(std::memory_order_relaxed);
+        uint64_t head = pBuffer->head.load(std::memory_order_acquire);
+        for(; tail != head; ++tail)
+        {
+            g_lastFrame.push_back(pBuffer->zones[tail & ThreadBuffer::MASK]);
+        }
+        pBuffer->tail.store(tail, std::memory_order_release);
+    }
+
+    // Zones are recorded when they end, so parents come after their children until sorted.
+    std::sort(g_lastFrame.begin(), g_lastFrame.end(), [](const ProfileZone& lhs, const ProfileZone& rhs) {
+        if(lhs.threadIndex != rhs.threadIndex)
+            return lhs.threadIndex < rhs.threadIndex;
+        if(lhs.startNs != rhs.startNs)
+            return lhs.startNs < rhs.startNs;
+        return lhs.depth < rhs.depth;
+    });
+
+    if(g_capturing.load(std::memory_order_relaxed))
+    {
+        size_t count = std::min(g_lastFrame.size(), MAX_CAPTURE_ZONES - g_capture.size());
+        g_capture.insert(g_capture.end(), g_lastFrame.begin(), g_lastFrame.begin() + count);
+        g_dropped.fetch_add(g_lastFrame.size() - count, std::memory_order_relaxed);
+    }
+}
+
+std::vector<ProfileZone> Profiler::GetLastFrameZones()
+{
+    std::vector<ProfileZone> zones;
+    GetLastFrameZones(zones);
+    return zones;
+}
+
+std::vector<ProfileThread> Profiler::GetThreads()
+{
+    std::vector<ProfileThread> threads;
+    GetThreads(threads);
+    return threads;
+}
+
+void Profiler::GetLastFrameZones(std::vector<ProfileZone>& zones)
+{
+    LockGuard<AdaptiveMutex> lock(g_lock);
+    zones.assign(g_lastFrame.begin(), g_lastFrame.end());
+}
+
+void Profiler::GetThreads(std::vector<ProfileThread>& threads)
+{
+    LockGuard<AdaptiveMutex> lock(g_lock);
+    // Assigned in place, the names reuse their storage.
+    threads.resize(g_buffers.size());
+    for(size_t idx = 0; idx < g_buffers.size(); ++idx)
+    {
+        threads[idx].index = g_buffers[idx]->threadIndex;
+        threads[idx].name.assign(g_buffers[idx]->name);
+    }
+}
+
+uint64_t Profiler::GetDroppedZoneCount()
+{
+    return g_dropped.load(std::memory_order_relaxed);
+}
+
+void Profiler::StartCapture()
+{
+    LockGuard<AdaptiveMutex> lock(g_lock);
+    g_capture.clear();
+    g_capturing.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::StopCapture()
+{
+    g_capturing.store(false, std::memory_order_relaxed);
+}
+
+bool Profiler::IsCapturing()
+{
+    return g_capturing.load(std::memory_order_relaxed);
+}
+
+std::string Profiler::ToChromeTrace()
+{
+    LockGuard<AdaptiveMutex> lock(g_lock);
+
+    uint64_t origin = UINT64_MAX;
+    for(const auto& zone : g_capture)
+    {
+        origin = std::min(origin, zone.startNs);
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool        first = true;
+    for(const auto& pBuffer : g_buffers)
+    {
+        out.append(first ? "" : ",");
+        out.append("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":")
+            .append(std::to_string(pBuffer->threadIndex))
+            .append(",\"args\":{\"name\":");
+        appendJsonString(out, pBuffer->name);
+        out.append("}}");
+        first = false;
+    }
+
+    for(const auto& zone : g_capture)
+    {
+        out.append(first ? "" : ",");
+        out.append("{\"ph\":\"X\",\"name\":");
+        appendJsonString(out, zone.name);
+        out.append(",\"pid\":1,\"tid\":").append(std::to_string(zone.threadIndex)).append(",\"ts\":");
+        appendMicroseconds(out, zone.startNs - origin);
+        out.append(",\"dur\":");
+        appendMicroseconds(out, zone.durationNs);
+        out.append("}");
+        first = false;
+    }
+    out.append("]}");
+    return out;
+}
+
+bool Profiler::WriteChromeTrace(const std::filesystem::path& path)
+{
+    std::ofstream file(path, std::ios::binary);
+    if(!file)
+    {
+        return false;
+    }
+    file << ToChromeTrace();
+    return static_cast<bool>(file);
+}
+}  // namespace aph
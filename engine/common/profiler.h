@@ -0,0 +1,119 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "common/common.h"
+
+// Define to 0 to compile every profile zone away.
+#ifndef APH_PROFILING
+#    define APH_PROFILING 1
+#endif
+
+namespace aph
+{
+// A finished zone. Times are steady clock nanoseconds, the name must outlive the profiler (a literal or __func__).
+struct ProfileZone
+{
+    const char* name        = {};
+    uint64_t    startNs     = {};
+    uint64_t    durationNs  = {};
+    uint32_t    threadIndex = {};
+    uint32_t    depth       = {};
+};
+
+struct ProfileThread
+{
+    uint32_t    index = {};
+    std::string name  = {};
+};
+
+// Scoped-zone CPU profiler. Every thread records finished zones into its own lock-free ring, BeginFrame() drains
+// them once per frame into the last frame's zone list and, while capturing, into a trace that can be exported in
+// the Chrome trace event format (chrome://tracing, Perfetto).
+class Profiler
+{
+public:
+    // Zones a thread can record between two BeginFrame() calls, the rest are dropped.
+    static constexpr uint32_t THREAD_ZONE_CAPACITY = 16384;
+    static constexpr size_t   MAX_CAPTURE_ZONES    = 1 << 21;
+
+    static constexpr bool IsEnabled() { return APH_PROFILING; }
+
+    static uint64_t GetTimeNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // Names the calling thread in the trace and the overlay, "Thread <index>" otherwise.
+    static void SetThreadName(std::string_view name);
+
+    // Records a zone of the calling thread, ProfileScope calls this.
+    static void RecordZone(const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth);
+
+    // A timeline not bound to a thread, e.g. a GPU queue. Only one thread at a time may record into a track.
+    static uint32_t CreateTrack(std::string_view name);
+    static void     RecordTrackZone(uint32_t track, const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth);
+
+    // Collects the zones all threads finished since the previous call, call once per frame from one thread.
+    static void BeginFrame();
+    // Sorted by thread, then start time, so nested zones directly follow their parent.
+    static std::vector<ProfileZone>   GetLastFrameZones();
+    static std::vector<ProfileThread> GetThreads();
+    // Same into the caller's vectors, which keep their capacity so a caller running every frame does not allocate.
+    static void                       GetLastFrameZones(std::vector<ProfileZone>& zones);
+    static void                       GetThreads(std::vector<ProfileThread>& threads);
+    static uint64_t                   GetDroppedZoneCount();
+
+    static void StartCapture();
+    static void StopCapture();
+    static bool IsCapturing();
+
+    // The captured zones as Chrome trace events.
+    static std::string ToChromeTrace();
+    static bool        WriteChromeTrace(const std::filesystem::path& path);
+};
+
+namespace detail
+{
+inline thread_local uint32_t tl_profileDepth = 0;
+}  // namespace detail
+
+// Times the enclosing scope as a zone nested in the scopes already open on this thread.
+class ProfileScope
+{
+public:
+#if APH_PROFILING
+    explicit ProfileScope(const char* name) :
+        m_name(name),
+        m_depth(detail::tl_profileDepth++),
+        m_startNs(Profiler::GetTimeNs())
+    {
+    }
+    ~ProfileScope()
+    {
+        Profiler::RecordZone(m_name, m_startNs, Profiler::GetTimeNs(), m_depth);
+        --detail::tl_profileDepth;
+    }
+#else
+    explicit ProfileScope(const char*) {}
+#endif
+
+    ProfileScope(const ProfileScope&)            = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+#if APH_PROFILING
+private:
+    const char* m_name;
+    uint32_t    m_depth;
+    uint64_t    m_startNs;
+#endif
+};
+}  // namespace aph
+
+#define APH_PROFILE_CONCAT_IMPL(a, b) a##b
+#define APH_PROFILE_CONCAT(a, b)      APH_PROFILE_CONCAT_IMPL(a, b)
+#define APH_PROFILE_SCOPE(name)       ::aph::ProfileScope APH_PROFILE_CONCAT(aphProfileScope, __LINE__)(name)
+#define APH_PROFILE_FUNCTION()        APH_PROFILE_SCOPE(__func__)
+
+#endif  // PROFILER_H_
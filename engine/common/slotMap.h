@@ -0,0 +1,141 @@
+#ifndef SLOT_MAP_H_
+#define SLOT_MAP_H_
+
+#include "common/common.h"
+
+namespace aph
+{
+// Values packed in one dense array, looked up in O(1) through handles that stay valid while the value lives and are
+// recognized as stale afterwards: every slot carries a generation that changes when its value is erased.
+// Erasing moves the last value into the hole, so iteration order is not insertion order and pointers into the map
+// are invalidated by insert() and erase(). Not thread safe.
+template <typename T>
+class SlotMap
+{
+public:
+    struct Handle
+    {
+        uint32_t index      = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool isValid() const { return index != UINT32_MAX; }
+        bool operator==(const Handle& other) const = default;
+
+        // Both halves in one integer, index in the low bits.
+        uint64_t      pack() const { return (static_cast<uint64_t>(generation) << 32) | index; }
+        static Handle Unpack(uint64_t value)
+        {
+            return { static_cast<uint32_t>(value), static_cast<uint32_t>(value >> 32) };
+        }
+    };
+
+    Handle insert(T value)
+    {
+        uint32_t index = m_freeHead;
+        if(index == INVALID_INDEX)
+        {
+            index = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back({});
+        }
+        else
+        {
+            m_freeHead = m_slots[index].denseIndex;
+        }
+
+        Slot& slot      = m_slots[index];
+        slot.denseIndex = static_cast<uint32_t>(m_values.size());
+        m_values.push_back(std::move(value));
+        m_denseToSlot.push_back(index);
+        return { index, slot.generation };
+    }
+
+    // False if the handle is stale.
+    bool erase(Handle handle)
+    {
+        if(!contains(handle))
+        {
+            return false;
+        }
+
+        Slot&    slot  = m_slots[handle.index];
+        uint32_t dense = slot.denseIndex;
+        uint32_t last  = static_cast<uint32_t>(m_values.size()) - 1;
+        if(dense != last)
+        {
+            m_values[dense]                          = std::move(m_values[last]);
+            m_denseToSlot[dense]                     = m_denseToSlot[last];
+            m_slots[m_denseToSlot[dense]].denseIndex = dense;
+        }
+        m_values.pop_back();
+        m_denseToSlot.pop_back();
+
+        ++slot.generation;
+        slot.denseIndex = m_freeHead;
+        m_freeHead      = handle.index;
+        return true;
+    }
+
+    bool contains(Handle handle) const
+    {
+        return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation &&
+               m_slots[handle.index].denseIndex < m_values.size() &&
+               m_denseToSlot[m_slots[handle.index].denseIndex] == handle.index;
+    }
+
+    // Null if the handle is stale.
+    T* get(Handle handle) { return contains(handle) ? &m_values[m_slots[handle.index].denseIndex] : nullptr; }
+    const T* get(Handle handle) const
+    {
+        return contains(handle) ? &m_values[m_slots[handle.index].denseIndex] : nullptr;
+    }
+
+    // Handle of the value at a position of the dense array.
+    Handle getHandle(size_t denseIndex) const
+    {
+        uint32_t index = m_denseToSlot[denseIndex];
+        return { index, m_slots[index].generation };
+    }
+
+    std::span<T>       getValues() { return m_values; }
+    std::span<const T> getValues() const { return m_values; }
+    size_t             getSize() const { return m_values.size(); }
+
+    void reserve(size_t count)
+    {
+        m_values.reserve(count);
+        m_denseToSlot.reserve(count);
+        m_slots.reserve(count);
+    }
+
+    void clear()
+    {
+        // Every slot is freed, live handles go stale.
+        for(uint32_t index : m_denseToSlot)
+        {
+            Slot& slot = m_slots[index];
+            ++slot.generation;
+            slot.denseIndex = m_freeHead;
+            m_freeHead      = index;
+        }
+        m_values.clear();
+        m_denseToSlot.clear();
+    }
+
+private:
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    // denseIndex links the free list while the slot is unused.
+    struct Slot
+    {
+        uint32_t denseIndex = INVALID_INDEX;
+        uint32_t generation = 0;
+    };
+
+    std::vector<Slot>     m_slots;
+    std::vector<T>        m_values;
+    std::vector<uint32_t> m_denseToSlot;
+    uint32_t              m_freeHead = INVALID_INDEX;
+};
+}  // namespace aph
+
+#endif  // SLOT_MAP_H_
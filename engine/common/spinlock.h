@@ -1,52 +1,367 @@
 #ifndef SPINLOCK_H_
 #define SPINLOCK_H_
 
-#include <atomic>
-#include <iostream>
-#include <mutex>
-#include <thread>
+#include "common/common.h"
+
+#if defined(__linux__)
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+// Define to 1 to have every lock count its acquisitions, spins, parks and hold time.
+#ifndef APH_LOCK_STATS
+#    define APH_LOCK_STATS 0
+#endif
 
 namespace aph
 {
-class SpinLock
+// Exponential backoff for spin-wait loops: pauses 1, 2, 4, ... times per round, then starts yielding the thread.
+class SpinBackoff
+{
+public:
+    static constexpr uint32_t MAX_PAUSES = 64;
+
+    void Pause()
+    {
+        if(m_pauses <= MAX_PAUSES)
+        {
+            for(uint32_t i = 0; i < m_pauses; ++i)
+                APH_CPU_PAUSE();
+            m_pauses <<= 1;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+        ++m_rounds;
+    }
+
+    // True until Pause() switched to yielding.
+    bool     IsSpinning() const { return m_pauses <= MAX_PAUSES; }
+    uint32_t GetRounds() const { return m_rounds; }
+
+private:
+    uint32_t m_pauses = 1;
+    uint32_t m_rounds = 0;
+};
+
+struct LockStats
+{
+    std::atomic<uint64_t> acquisitions{ 0 };
+    std::atomic<uint64_t> spins{ 0 };
+    std::atomic<uint64_t> parks{ 0 };
+    std::atomic<uint64_t> holdTimeNs{ 0 };
+};
+
+namespace detail
+{
+// Base of the locks below, records into LockStats when APH_LOCK_STATS is on. Otherwise it has no members and the
+// empty base takes no space in the lock.
+class LockProfiler
+{
+public:
+#if APH_LOCK_STATS
+    const LockStats& GetStats() const { return m_stats; }
+    void             ResetStats()
+    {
+        m_stats.acquisitions = 0;
+        m_stats.spins        = 0;
+        m_stats.parks        = 0;
+        m_stats.holdTimeNs   = 0;
+    }
+#else
+    // Always zero.
+    const LockStats& GetStats() const
+    {
+        static const LockStats stats;
+        return stats;
+    }
+    void ResetStats() {}
+#endif
+
+protected:
+    void onAcquired([[maybe_unused]] uint32_t spins, [[maybe_unused]] uint32_t parks = 0)
+    {
+#if APH_LOCK_STATS
+        onSharedAcquired(spins, parks);
+        m_holdStart = std::chrono::steady_clock::now();
+#endif
+    }
+
+    // Shared owners are counted but their hold time is not, several of them hold the lock at once.
+    void onSharedAcquired([[maybe_unused]] uint32_t spins, [[maybe_unused]] uint32_t parks = 0)
+    {
+#if APH_LOCK_STATS
+        m_stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        m_stats.spins.fetch_add(spins, std::memory_order_relaxed);
+        m_stats.parks.fetch_add(parks, std::memory_order_relaxed);
+#endif
+    }
+
+    // Must be called before the lock is actually released.
+    void onReleased()
+    {
+#if APH_LOCK_STATS
+        auto holdTime = std::chrono::steady_clock::now() - m_holdStart;
+        m_stats.holdTimeNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(holdTime).count(),
+                                     std::memory_order_relaxed);
+#endif
+    }
+
+#if APH_LOCK_STATS
+private:
+    LockStats                             m_stats;
+    std::chrono::steady_clock::time_point m_holdStart;
+#endif
+};
+
+inline void futexWait(std::atomic<uint32_t>& word, uint32_t expected)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+    if(word.load(std::memory_order_relaxed) == expected)
+        std::this_thread::yield();
+#endif
+}
+
+inline void futexWakeOne(std::atomic<uint32_t>& word)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+}  // namespace detail
+
+// Test-and-test-and-set lock. Waiters spin on a plain load with exponential backoff, so the cache line is only
+// written when the lock looks free. For critical sections of a few hundred cycles at most.
+class SpinLock : public detail::LockProfiler
 {
 public:
+    bool TryLock()
+    {
+        if(m_locked.load(std::memory_order_relaxed) || m_locked.exchange(true, std::memory_order_acquire))
+            return false;
+        onAcquired(0);
+        return true;
+    }
+
     void Lock()
     {
-        auto callingThread = std::this_thread::get_id();
-        if(callingThread == m_owningThread)
-            return;
+        SpinBackoff backoff;
+        while(m_locked.exchange(true, std::memory_order_acquire))
+        {
+            while(m_locked.load(std::memory_order_relaxed))
+                backoff.Pause();
+        }
+        onAcquired(backoff.GetRounds());
+    }
 
+    void Unlock()
+    {
+        onReleased();
+        m_locked.store(false, std::memory_order_release);
+    }
+
+private:
+    alignas(64) std::atomic_bool m_locked{ false };
+};
+
+// FIFO spin lock: threads take a ticket and wait until it is served, so nobody starves under contention.
+// Waiters back off proportionally to their distance from the head of the line. Handing the lock to a descheduled
+// waiter stalls everyone behind it, so only use it when the contending threads do not outnumber the cores.
+class TicketLock : public detail::LockProfiler
+{
+public:
+    bool TryLock()
+    {
+        uint32_t serving = m_serving.load(std::memory_order_relaxed);
+        uint32_t ticket  = serving;
+        if(!m_next.compare_exchange_strong(ticket, serving + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            return false;
+        onAcquired(0);
+        return true;
+    }
+
+    void Lock()
+    {
+        uint32_t ticket = m_next.fetch_add(1, std::memory_order_relaxed);
+        uint32_t rounds = 0;
         while(true)
         {
-            bool value = m_lock.test_and_set(std::memory_order_acquire);
-            if(!value)
-            {
-                m_owningThread = std::this_thread::get_id();
+            uint32_t distance = ticket - m_serving.load(std::memory_order_acquire);
+            if(distance == 0)
                 break;
+
+            // The owner or someone ahead of us may be descheduled, spinning longer will not help then.
+            if(++rounds > 16)
+            {
+                std::this_thread::yield();
+                continue;
             }
+            for(uint32_t i = 0; i < distance * 16; ++i)
+                APH_CPU_PAUSE();
         }
+        onAcquired(rounds);
     }
 
     void Unlock()
     {
-        m_lock.clear(std::memory_order_release);
-        m_owningThread = std::thread::id();
+        onReleased();
+        // Only the owner writes m_serving.
+        m_serving.store(m_serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
     }
 
 private:
-    alignas(64) std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
-    std::thread::id m_owningThread      = std::thread::id();
+    alignas(64) std::atomic<uint32_t> m_next{ 0 };
+    alignas(64) std::atomic<uint32_t> m_serving{ 0 };
 };
-#define BEGIN_THREAD_SAFE_BLOCK() \
-    { \
-        static vez::SpinLock spinLock; \
-        spinLock.Lock();
 
-#define END_THREAD_SAFE_BLOCK() \
-    spinLock.Unlock(); \
+// Spins briefly, then parks the thread on a futex. Unlocking only enters the kernel if somebody is parked.
+// The default choice when the critical section may call into the driver or allocate.
+class AdaptiveMutex : public detail::LockProfiler
+{
+public:
+    bool TryLock()
+    {
+        uint32_t expected = UNLOCKED;
+        if(!m_state.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed))
+            return false;
+        onAcquired(0);
+        return true;
+    }
+
+    void Lock()
+    {
+        SpinBackoff backoff;
+        while(backoff.IsSpinning())
+        {
+            uint32_t expected = UNLOCKED;
+            if(m_state.load(std::memory_order_relaxed) == UNLOCKED &&
+               m_state.compare_exchange_weak(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                onAcquired(backoff.GetRounds());
+                return;
+            }
+            backoff.Pause();
+        }
+
+        // Mark the lock as contended so the owner wakes us, then sleep until we grab it.
+        uint32_t parks = 0;
+        while(m_state.exchange(CONTENDED, std::memory_order_acquire) != UNLOCKED)
+        {
+            detail::futexWait(m_state, CONTENDED);
+            ++parks;
+        }
+        onAcquired(backoff.GetRounds(), parks);
+    }
+
+    void Unlock()
+    {
+        onReleased();
+        if(m_state.exchange(UNLOCKED, std::memory_order_release) == CONTENDED)
+            detail::futexWakeOne(m_state);
+    }
+
+private:
+    enum : uint32_t
+    {
+        UNLOCKED  = 0,
+        LOCKED    = 1,
+        CONTENDED = 2,
+    };
+
+    alignas(64) std::atomic<uint32_t> m_state{ UNLOCKED };
+};
+
+// Reader-writer spin lock. A waiting writer blocks new readers from entering, so writers are not starved.
+class RWSpinLock : public detail::LockProfiler
+{
+public:
+    void Lock()
+    {
+        SpinBackoff backoff;
+        while(true)
+        {
+            uint32_t state = m_state.load(std::memory_order_relaxed);
+            if((state & ~WRITER_PENDING) == 0)
+            {
+                if(m_state.compare_exchange_weak(state, WRITER, std::memory_order_acquire, std::memory_order_relaxed))
+                    break;
+            }
+            else if(!(state & WRITER_PENDING))
+            {
+                m_state.fetch_or(WRITER_PENDING, std::memory_order_relaxed);
+            }
+            backoff.Pause();
+        }
+        onAcquired(backoff.GetRounds());
     }
 
+    void Unlock()
+    {
+        onReleased();
+        m_state.fetch_and(~WRITER, std::memory_order_release);
+    }
+
+    void LockShared()
+    {
+        SpinBackoff backoff;
+        while(true)
+        {
+            uint32_t state = m_state.load(std::memory_order_relaxed);
+            if(!(state & (WRITER | WRITER_PENDING)) &&
+               m_state.compare_exchange_weak(state, state + READER, std::memory_order_acquire,
+                                             std::memory_order_relaxed))
+                break;
+            backoff.Pause();
+        }
+        onSharedAcquired(backoff.GetRounds());
+    }
+
+    void UnlockShared() { m_state.fetch_sub(READER, std::memory_order_release); }
+
+private:
+    enum : uint32_t
+    {
+        WRITER         = 1,
+        WRITER_PENDING = 2,
+        READER         = 4,
+    };
+
+    alignas(64) std::atomic<uint32_t> m_state{ 0 };
+};
+
+template <typename TLock>
+class LockGuard
+{
+public:
+    explicit LockGuard(TLock& lock) : m_lock(lock) { m_lock.Lock(); }
+    ~LockGuard() { m_lock.Unlock(); }
+
+    LockGuard(const LockGuard&)            = delete;
+    LockGuard& operator=(const LockGuard&) = delete;
+
+private:
+    TLock& m_lock;
+};
+
+template <typename TLock>
+class SharedLockGuard
+{
+public:
+    explicit SharedLockGuard(TLock& lock) : m_lock(lock) { m_lock.LockShared(); }
+    ~SharedLockGuard() { m_lock.UnlockShared(); }
+
+    SharedLockGuard(const SharedLockGuard&)            = delete;
+    SharedLockGuard& operator=(const SharedLockGuard&) = delete;
+
+private:
+    TLock& m_lock;
+};
 }  // namespace aph
 
 #endif  // SPINLOCK_H_
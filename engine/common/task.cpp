@@ -0,0 +1,19 @@
+#include "task.h"
+
+namespace aph
+{
+Task<std::vector<uint8_t>> readFileAsync(std::filesystem::path path, ThreadPool* pPool)
+{
+    co_await schedule(pPool);
+
+    std::vector<uint8_t> data;
+    std::ifstream        file(path, std::ios::binary | std::ios::ate);
+    if(file)
+    {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+    co_return data;
+}
+}  // namespace aph
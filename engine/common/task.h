@@ -0,0 +1,271 @@
+#ifndef TASK_H_
+#define TASK_H_
+
+#include "common/threadPool.h"
+
+#include <coroutine>
+#include <exception>
+
+namespace aph
+{
+template <typename T>
+class Task;
+
+namespace detail
+{
+class TaskPromiseBase
+{
+public:
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename TPromise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<TPromise> handle) noexcept
+        {
+            // The frame may be destroyed as soon as the state reads done, only touch locals afterwards.
+            auto& promise      = handle.promise();
+            auto* continuation =
+                const_cast<void*>(promise.m_state.exchange(promise.doneMarker(), std::memory_order_acq_rel));
+            return continuation ? std::coroutine_handle<>::from_address(continuation) : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter        final_suspend() const noexcept { return {}; }
+    void                unhandled_exception() { m_exception = std::current_exception(); }
+
+    bool isDone() const { return m_state.load(std::memory_order_acquire) == doneMarker(); }
+    void markStarted() { m_started = true; }
+
+    // Returns the coroutine to resume next: the task itself if it has not been started yet, the awaiting coroutine
+    // if the task already finished, nothing if the task will resume it once it finishes.
+    std::coroutine_handle<> setContinuation(std::coroutine_handle<> task, std::coroutine_handle<> continuation)
+    {
+        if(!m_started)
+        {
+            m_started = true;
+            m_state.store(continuation.address(), std::memory_order_relaxed);
+            return task;
+        }
+        const void* expected = nullptr;
+        if(m_state.compare_exchange_strong(expected, continuation.address(), std::memory_order_acq_rel))
+            return std::noop_coroutine();
+        return continuation;
+    }
+
+protected:
+    void rethrowIfFailed()
+    {
+        if(m_exception)
+            std::rethrow_exception(m_exception);
+    }
+
+private:
+    const void* doneMarker() const { return this; }
+
+    // Null while running, then the awaiting coroutine's address, then doneMarker() once finished.
+    std::atomic<const void*> m_state     = { nullptr };
+    std::exception_ptr       m_exception = {};
+    bool                     m_started   = false;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase
+{
+public:
+    Task<T> get_return_object();
+
+    template <typename U>
+    void return_value(U&& value)
+    {
+        m_value.emplace(std::forward<U>(value));
+    }
+
+    T& result()
+    {
+        rethrowIfFailed();
+        return *m_value;
+    }
+
+private:
+    std::optional<T> m_value = {};
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase
+{
+public:
+    Task<void> get_return_object();
+
+    void return_void() {}
+    void result() { rethrowIfFailed(); }
+};
+}  // namespace detail
+
+// A lazily started coroutine producing a T.
+// The coroutine body only runs once the task is co_await'ed (inline on the awaiting thread, the awaiter resumes
+// wherever the task finishes) or start()'ed on a ThreadPool. A started task is polled with isReady(), so a thread
+// that must not block, e.g. the render thread, can kick off work and pick the result up on a later frame.
+template <typename T = void>
+class [[nodiscard]] Task
+{
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle       = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    explicit Task(Handle handle) : m_handle(handle) {}
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Task& operator=(Task&& other) noexcept
+    {
+        if(this != &other)
+        {
+            destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+
+    // The task must have finished (or never been started) when it is destroyed.
+    ~Task() { destroy(); }
+
+    bool isValid() const { return static_cast<bool>(m_handle); }
+    bool isReady() const { return m_handle && m_handle.promise().isDone(); }
+
+    // Runs the coroutine on pPool. It may still be co_await'ed or syncWait()'ed afterwards.
+    void start(ThreadPool* pPool = ThreadPool::GetDefault())
+    {
+        m_handle.promise().markStarted();
+        pPool->AddTask([handle = m_handle]() { handle.resume(); });
+    }
+
+    // Only valid once isReady() returned true. Rethrows an exception that escaped the coroutine.
+    decltype(auto) get()
+    {
+        assert(isReady());
+        return m_handle.promise().result();
+    }
+
+    auto operator co_await() noexcept
+    {
+        struct Awaiter
+        {
+            Handle handle;
+
+            bool                    await_ready() const noexcept { return handle.promise().isDone(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                return handle.promise().setContinuation(handle, awaiting);
+            }
+            decltype(auto) await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter{ m_handle };
+    }
+
+private:
+    void destroy()
+    {
+        if(m_handle)
+        {
+            m_handle.destroy();
+            m_handle = {};
+        }
+    }
+
+    Handle m_handle = {};
+};
+
+namespace detail
+{
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object()
+{
+    return Task<T>{ std::coroutine_handle<TaskPromise<T>>::from_promise(*this) };
+}
+
+inline Task<void> TaskPromise<void>::get_return_object()
+{
+    return Task<void>{ std::coroutine_handle<TaskPromise<void>>::from_promise(*this) };
+}
+
+// Starts eagerly and frees its own frame when done, used to bridge a Task to a blocking wait.
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask        get_return_object() { return {}; }
+        std::suspend_never  initial_suspend() const noexcept { return {}; }
+        std::suspend_never  final_suspend() const noexcept { return {}; }
+        void                return_void() {}
+        void                unhandled_exception() { std::terminate(); }
+    };
+};
+
+struct SyncWaitState
+{
+    std::mutex              mutex;
+    std::condition_variable condition;
+    bool                    done = false;
+};
+
+template <typename T>
+DetachedTask signalWhenDone(Task<T>& task, SyncWaitState& state)
+{
+    try
+    {
+        co_await task;
+    }
+    catch(...)
+    {
+        // Stays stored in the promise, syncWait() rethrows it.
+    }
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.done = true;
+    state.condition.notify_all();
+}
+}  // namespace detail
+
+// Resumes the awaiting coroutine on a worker of pPool.
+inline auto schedule(ThreadPool* pPool = ThreadPool::GetDefault())
+{
+    struct Awaiter
+    {
+        ThreadPool* pPool;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { pPool->AddTask([handle]() { handle.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{ pPool };
+}
+
+// Runs the task to completion (or waits for a started one) and returns its result, blocking the calling thread.
+template <typename T>
+decltype(auto) syncWait(Task<T>& task)
+{
+    detail::SyncWaitState state;
+    detail::signalWhenDone(task, state);
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.condition.wait(lock, [&state]() { return state.done; });
+    return task.get();
+}
+
+template <typename T>
+T syncWait(Task<T>&& task)
+{
+    if constexpr(std::is_void_v<T>)
+        syncWait(task);
+    else
+        return std::move(syncWait(task));
+}
+
+// Reads a whole file on a worker of pPool, empty if the file could not be opened.
+Task<std::vector<uint8_t>> readFileAsync(std::filesystem::path path, ThreadPool* pPool = ThreadPool::GetDefault());
+}  // namespace aph
+
+#endif  // TASK_H_
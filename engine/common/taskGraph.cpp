@@ -0,0 +1,143 @@
+#include "taskGraph.h"
+
+namespace aph
+{
+TaskNode* TaskNode::precede(TaskNode* other)
+{
+    assert(other && other->m_pGraph == m_pGraph);
+    m_successors.push_back(other);
+    ++other->m_dependencyCount;
+    m_pGraph->m_dirty = true;
+    return this;
+}
+
+TaskNode* TaskNode::succeed(TaskNode* other)
+{
+    other->precede(this);
+    return this;
+}
+
+TaskNode* TaskGraph::addTask(std::string name, std::function<void()>&& func)
+{
+    m_nodes.push_back(std::make_unique<TaskNode>(this, std::move(name), std::move(func)));
+    m_dirty = true;
+    return m_nodes.back().get();
+}
+
+void TaskGraph::run()
+{
+    assert(m_group.IsDone() && "the previous run has not completed.");
+
+    if(m_dirty)
+    {
+        assert(isAcyclic() && "task graph contains a cycle.");
+        m_roots.clear();
+        for(const auto& node : m_nodes)
+        {
+            if(node->m_dependencyCount == 0)
+            {
+                m_roots.push_back(node.get());
+            }
+        }
+        m_dirty = false;
+    }
+
+    for(const auto& node : m_nodes)
+    {
+        node->m_pendingCount.store(node->m_dependencyCount, std::memory_order_relaxed);
+    }
+
+    // Account for every node up front so wait() cannot return between two stages.
+    m_group.Add(static_cast<uint32_t>(m_nodes.size()));
+
+    for(auto* pRoot : m_roots)
+    {
+        schedule(pRoot);
+    }
+}
+
+void TaskGraph::wait()
+{
+    m_pPool->Wait(m_group);
+}
+
+void TaskGraph::execute()
+{
+    run();
+    wait();
+}
+
+void TaskGraph::clear()
+{
+    assert(m_group.IsDone());
+    m_nodes.clear();
+    m_roots.clear();
+    m_dirty = true;
+}
+
+void TaskGraph::schedule(TaskNode* pNode)
+{
+    m_pPool->AddTask([this, pNode]() { runNode(pNode); });
+}
+
+void TaskGraph::runNode(TaskNode* pNode)
+{
+    while(pNode)
+    {
+        if(pNode->m_func)
+        {
+            pNode->m_func();
+        }
+
+        TaskNode* pContinuation = nullptr;
+        for(auto* pSuccessor : pNode->m_successors)
+        {
+            if(pSuccessor->m_pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                if(!pContinuation)
+                {
+                    pContinuation = pSuccessor;
+                }
+                else
+                {
+                    schedule(pSuccessor);
+                }
+            }
+        }
+
+        m_group.Done();
+        pNode = pContinuation;
+    }
+}
+
+bool TaskGraph::isAcyclic() const
+{
+    // Kahn's algorithm over a copy of the dependency counts.
+    std::unordered_map<const TaskNode*, uint32_t> inDegree;
+    std::vector<const TaskNode*>                  ready;
+    for(const auto& node : m_nodes)
+    {
+        inDegree[node.get()] = node->m_dependencyCount;
+        if(node->m_dependencyCount == 0)
+        {
+            ready.push_back(node.get());
+        }
+    }
+
+    size_t visited = 0;
+    while(!ready.empty())
+    {
+        const TaskNode* pNode = ready.back();
+        ready.pop_back();
+        ++visited;
+        for(const auto* pSuccessor : pNode->m_successors)
+        {
+            if(--inDegree[pSuccessor] == 0)
+            {
+                ready.push_back(pSuccessor);
+            }
+        }
+    }
+    return visited == m_nodes.size();
+}
+}  // namespace aph
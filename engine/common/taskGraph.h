@@ -0,0 +1,81 @@
+#ifndef TASKGRAPH_H_
+#define TASKGRAPH_H_
+
+#include "common/threadPool.h"
+
+namespace aph
+{
+class TaskGraph;
+
+// A unit of work in a TaskGraph. Edges are added with precede()/succeed() before the graph runs.
+class TaskNode
+{
+public:
+    TaskNode(TaskGraph* pGraph, std::string name, std::function<void()>&& func) :
+        m_pGraph(pGraph),
+        m_name(std::move(name)),
+        m_func(std::move(func))
+    {
+    }
+
+    // This node has to finish before `other` starts.
+    TaskNode* precede(TaskNode* other);
+    // `other` has to finish before this node starts.
+    TaskNode* succeed(TaskNode* other);
+
+    std::string_view getName() const { return m_name; }
+    uint32_t         getDependencyCount() const { return m_dependencyCount; }
+
+private:
+    friend class TaskGraph;
+
+    TaskGraph*             m_pGraph          = {};
+    std::string            m_name            = {};
+    std::function<void()>  m_func            = {};
+    std::vector<TaskNode*> m_successors      = {};
+    uint32_t               m_dependencyCount = {};
+    std::atomic<uint32_t>  m_pendingCount    = {};
+};
+
+// A reusable dependency graph executed on a ThreadPool.
+// Every run resets the atomic dependency counters, schedules the roots and lets each finished node release its
+// successors. The first successor that becomes ready runs as a continuation on the same thread, the others are
+// handed to the pool, so a linear chain never bounces between workers.
+class TaskGraph
+{
+    friend class TaskNode;
+
+public:
+    TaskGraph(ThreadPool* pPool = ThreadPool::GetDefault()) : m_pPool(pPool) {}
+
+    TaskGraph(const TaskGraph&)            = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    TaskNode* addTask(std::string name, std::function<void()>&& func);
+
+    // Starts a run, the graph must not be modified until wait() returns.
+    void run();
+    // Blocks until the current run completes, the calling thread executes pending tasks meanwhile.
+    void wait();
+    // run() + wait().
+    void execute();
+    // Removes every node.
+    void clear();
+
+    size_t getNodeCount() const { return m_nodes.size(); }
+
+private:
+    void schedule(TaskNode* pNode);
+    void runNode(TaskNode* pNode);
+    bool isAcyclic() const;
+
+private:
+    ThreadPool*                            m_pPool = {};
+    std::vector<std::unique_ptr<TaskNode>> m_nodes = {};
+    std::vector<TaskNode*>                 m_roots = {};
+    WaitGroup                              m_group = {};
+    bool                                   m_dirty = { true };
+};
+}  // namespace aph
+
+#endif  // TASKGRAPH_H_
@@ -1,79 +1,316 @@
 #include "threadPool.h"
+#include "profiler.h"
 
 namespace aph
 {
+namespace
+{
+// Worker identity of the calling thread, used to route spawned tasks to the local deque.
+thread_local ThreadPool* tl_pCurrentPool = nullptr;
+thread_local uint32_t    tl_workerIndex  = 0;
+thread_local uint32_t    tl_stealSeed    = 0x9E3779B9U;
+
+// Recycled jobs of the calling thread so the steady state does not allocate.
+struct JobCache
+{
+    static constexpr size_t MAX_CACHED_JOBS = 64;
+    std::vector<Job*>       jobs;
+
+    ~JobCache()
+    {
+        for(auto* pJob : jobs)
+            delete pJob;
+    }
+};
+thread_local JobCache tl_jobCache;
+
+// Jobs usually finish on another thread than the one that allocated them, so the thread caches alone would drain on
+// submitters and fill up on workers. Whatever overflows a thread's cache is shared with every thread through here.
+constexpr size_t SHARED_CACHED_JOBS = 4096;
+MPMCQueue<Job*>& getSharedJobCache()
+{
+    // Never destroyed, jobs are still freed while the default pool's destructor runs.
+    static auto* pJobs = new MPMCQueue<Job*>(SHARED_CACHED_JOBS);
+    return *pJobs;
+}
+
+uint32_t nextRandom()
+{
+    // xorshift32
+    uint32_t x = tl_stealSeed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tl_stealSeed = x;
+    return x;
+}
+
+constexpr uint32_t SPIN_COUNT_BEFORE_PARK = 64;
+}  // namespace
+
+ThreadPool* ThreadPool::GetDefault()
+{
+    // hardware_concurrency() may report 0 when unknown, clamp before subtracting.
+    static ThreadPool defaultPool(std::max(2U, std::thread::hardware_concurrency()) - 1);
+    return &defaultPool;
+}
+
 ThreadPool::ThreadPool(uint32_t threadCount)
 {
-    // Spawn maxThreadCount threads to execute tasks.
+    m_workers.reserve(threadCount);
     for(auto i = 0U; i < threadCount; ++i)
     {
-        // All threads execute until task queue becomes invalidated.
-        m_threads.emplace([this]() {
-            while(true)
-            {
-                // Pop the next task off of the queue.
-                std::packaged_task<void()> packagedTask;
-                if(!m_tasks.Pop(packagedTask))
-                    break;
+        m_workers.push_back(std::make_unique<Worker>());
+    }
 
-                // Increment the number of active threads.
-                ++m_activeThreads;
+    // Spawn threads only once every deque exists, so workers can steal right away.
+    for(auto i = 0U; i < threadCount; ++i)
+    {
+        m_workers[i]->thread = std::thread([this, i]() { WorkerLoop(i); });
+    }
+}
 
-                // Run the task.
-                packagedTask();
+ThreadPool::~ThreadPool()
+{
+    // Finish remaining tasks before tearing the workers down.
+    Wait();
 
-                // Decrement the number of active threads.
-                --m_activeThreads;
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_sleepCondition.notify_all();
+
+    for(auto& worker : m_workers)
+    {
+        worker->thread.join();
+    }
+}
+
+Job* ThreadPool::AllocateJob()
+{
+    auto& cache = tl_jobCache.jobs;
+    if(!cache.empty())
+    {
+        Job* pJob = cache.back();
+        cache.pop_back();
+        return pJob;
+    }
+    Job* pJob = nullptr;
+    if(getSharedJobCache().TryPop(pJob))
+    {
+        return pJob;
+    }
+    return new Job();
+}
 
-                // Notify any thread waiting on task completition via ThreadPool::Wait().
-                m_threadsCompleteCondition.notify_all();
+void ThreadPool::FreeJob(Job* pJob)
+{
+    auto& cache = tl_jobCache.jobs;
+    if(cache.size() < JobCache::MAX_CACHED_JOBS)
+    {
+        cache.push_back(pJob);
+        return;
+    }
+    if(!getSharedJobCache().TryPush(pJob))
+    {
+        delete pJob;
+    }
+}
+
+void ThreadPool::Submit(Job* pJob)
+{
+    assert(!m_stopping);
+    m_unfinishedTasks.fetch_add(1, std::memory_order_relaxed);
+
+    // Counted before publishing so a thief never decrements it below zero.
+    // Paired with the sleeping counter in WorkerLoop, see the comment there.
+    m_queuedTasks.fetch_add(1, std::memory_order_seq_cst);
+
+    if(tl_pCurrentPool == this || m_workers.empty())
+    {
+        // Spawned from one of our workers: keep it local, thieves will balance the load. With both queues full the
+        // worker helps draining them instead of blocking, as every worker blocking at once would never resume.
+        if(tl_pCurrentPool != this || !m_workers[tl_workerIndex]->queue.Push(pJob))
+        {
+            while(!m_injectionQueue.TryPush(pJob))
+            {
+                if(!TryRunPendingTask())
+                    std::this_thread::yield();
             }
-        });
+        }
+    }
+    else
+    {
+        // Any other thread, like the frame graph's main thread, blocks while the injection queue is full instead of
+        // running someone else's task inline, the workers free a slot with every task they take.
+        m_injectionQueue.Push(pJob);
+    }
+
+    if(m_sleepingThreads.load(std::memory_order_seq_cst) > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.notify_one();
     }
 }
 
-ThreadPool::~ThreadPool()
+bool ThreadPool::FindTask(Job*& pJob)
+{
+    // Own deque first (LIFO keeps the working set hot).
+    if(tl_pCurrentPool == this && m_workers[tl_workerIndex]->queue.Pop(pJob))
+    {
+        return true;
+    }
+
+    // Then the shared injection queue.
+    if(m_injectionQueue.TryPop(pJob))
+    {
+        return true;
+    }
+
+    // Finally try to steal from a random victim.
+    const auto workerCount = static_cast<uint32_t>(m_workers.size());
+    if(workerCount > 0)
+    {
+        uint32_t start = nextRandom() % workerCount;
+        for(uint32_t i = 0; i < workerCount; ++i)
+        {
+            uint32_t victim = (start + i) % workerCount;
+            if(tl_pCurrentPool == this && victim == tl_workerIndex)
+                continue;
+            if(m_workers[victim]->queue.Steal(pJob))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::RunJob(Job* pJob)
 {
-    // Invalidate task queue so threads stop waiting on new tasks but finish remaining tasks in queue.
-    m_tasks.Invalidate();
+    m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+    WaitGroup* pGroup = pJob->GetGroup();
+    pJob->Execute();
+    pJob->Discard();
+    FreeJob(pJob);
 
-    // Join all active threads.
-    while(!m_threads.empty())
+    if(pGroup)
     {
-        auto& thread = m_threads.top();
-        thread.join();
-        m_threads.pop();
+        pGroup->Done();
     }
+    m_unfinishedTasks.fetch_sub(1, std::memory_order_acq_rel);
 }
 
-std::shared_future<void> ThreadPool::AddTask(Task&& task)
+void ThreadPool::DiscardJob(Job* pJob)
 {
-    std::packaged_task<void()> packagedTask(std::move(task));
-    auto                       future = packagedTask.get_future();
-    m_tasks.Push(std::move(packagedTask));
-    return future.share();
+    m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+    WaitGroup* pGroup = pJob->GetGroup();
+    pJob->Discard();
+    FreeJob(pJob);
+
+    if(pGroup)
+    {
+        pGroup->Done();
+    }
+    m_unfinishedTasks.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool ThreadPool::TryRunPendingTask()
+{
+    Job* pJob = nullptr;
+    if(FindTask(pJob))
+    {
+        RunJob(pJob);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::WorkerLoop(uint32_t workerIndex)
+{
+    tl_pCurrentPool = this;
+    tl_workerIndex  = workerIndex;
+    tl_stealSeed    = 0x9E3779B9U * (workerIndex + 1);
+    Profiler::SetThreadName("Worker " + std::to_string(workerIndex));
+
+    while(true)
+    {
+        if(TryRunPendingTask())
+            continue;
+
+        // Spin a little before parking, new work usually shows up quickly.
+        bool found = false;
+        for(uint32_t spin = 0; spin < SPIN_COUNT_BEFORE_PARK && !found; ++spin)
+        {
+            APH_CPU_PAUSE();
+            found = m_queuedTasks.load(std::memory_order_relaxed) > 0;
+        }
+        if(found)
+            continue;
+
+        // Announce ourselves as sleeping before re-checking the queued counter. Submit() increments the counter
+        // before reading the sleeping count, so at least one side always observes the other.
+        m_sleepingThreads.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleepCondition.wait(lock, [this]() {
+                return m_queuedTasks.load(std::memory_order_seq_cst) > 0 || m_stopping;
+            });
+        }
+        m_sleepingThreads.fetch_sub(1, std::memory_order_relaxed);
+
+        if(m_stopping && m_queuedTasks.load(std::memory_order_acquire) == 0)
+            break;
+    }
+
+    tl_pCurrentPool = nullptr;
 }
 
 void ThreadPool::ClearPendingTasks()
 {
-    m_tasks.Clear();
+    Job* pJob = nullptr;
+    while(m_injectionQueue.TryPop(pJob))
+    {
+        DiscardJob(pJob);
+    }
+
+    for(auto& worker : m_workers)
+    {
+        while(worker->queue.Steal(pJob))
+        {
+            DiscardJob(pJob);
+        }
+    }
 }
 
 void ThreadPool::Wait()
 {
-    std::unique_lock<std::mutex> lock(m_threadsCompleteMutex);
-    m_threadsCompleteCondition.wait(lock, [this]() { return !m_activeThreads && m_tasks.Empty(); });
+    // The calling task is unfinished itself, so this would never return.
+    assert(tl_pCurrentPool != this && "Wait() called from a task of the same pool, use Wait(WaitGroup&).");
+    while(m_unfinishedTasks.load(std::memory_order_acquire) > 0)
+    {
+        if(!TryRunPendingTask())
+            std::this_thread::yield();
+    }
+}
+
+void ThreadPool::Wait(const WaitGroup& group)
+{
+    while(!group.IsDone())
+    {
+        if(!TryRunPendingTask())
+            std::this_thread::yield();
+    }
 }
 
 void ThreadPool::Abort()
 {
     // Clear any pending items.
-    m_tasks.Clear();
-
-    // Invalidate task queue so threads stop waiting on new items.
-    m_tasks.Invalidate();
+    ClearPendingTasks();
 
-    // Wait for running threads to complete.
+    // Wait for running tasks to complete.
     Wait();
 }
 }  // namespace aph
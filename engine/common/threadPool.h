@@ -2,107 +2,134 @@
 #define THREADPOOL_H_
 
 #include "common/common.h"
+#include "common/mpmcQueue.h"
+#include "common/workStealingQueue.h"
 
 namespace aph
 {
-// A thread-safe queue class.
-template <typename T>
-class ThreadSafeQueue
+// Counts outstanding tasks so a caller can wait on a subset of the work in flight.
+class WaitGroup
 {
 public:
-    bool Empty()
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_queue.empty();
-    }
+    void Add(uint32_t count = 1) { m_counter.fetch_add(count, std::memory_order_relaxed); }
+    void Done() { m_counter.fetch_sub(1, std::memory_order_acq_rel); }
+    bool IsDone() const { return m_counter.load(std::memory_order_acquire) == 0; }
 
-    void Clear()
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        while(!m_queue.empty())
-            m_queue.pop();
-        m_condition.notify_all();
-    }
-
-    void Invalidate()
-    {
-        m_valid = false;
-        m_condition.notify_all();
-    }
+private:
+    std::atomic<uint32_t> m_counter{ 0 };
+};
 
-    void Push(const T& item)
-    {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        assert(m_valid);
-        m_queue.push(item);
-        lock.unlock();
-        m_condition.notify_one();
-    }
+// A type-erased task. Callables up to INLINE_SIZE bytes are stored in place, larger ones fall back to the heap.
+class alignas(64) Job
+{
+public:
+    static constexpr size_t INLINE_SIZE = 40;
 
-    void Push(T&& item)
+    template <typename F>
+    void Set(F&& func, WaitGroup* pGroup)
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        assert(m_valid);
-        m_queue.push(std::move(item));
-        lock.unlock();
-        m_condition.notify_one();
+        using Functor = std::decay_t<F>;
+        if constexpr(sizeof(Functor) <= INLINE_SIZE && alignof(Functor) <= alignof(std::max_align_t))
+        {
+            new(m_storage) Functor(std::forward<F>(func));
+            m_invoke  = [](void* storage) { (*static_cast<Functor*>(storage))(); };
+            m_destroy = [](void* storage) { static_cast<Functor*>(storage)->~Functor(); };
+        }
+        else
+        {
+            auto* pFunctor = new Functor(std::forward<F>(func));
+            std::memcpy(m_storage, &pFunctor, sizeof(pFunctor));
+            m_invoke  = [](void* storage) { (**static_cast<Functor**>(storage))(); };
+            m_destroy = [](void* storage) { delete *static_cast<Functor**>(storage); };
+        }
+        m_pGroup = pGroup;
     }
 
-    bool Pop(T& item)
-    {
-        // Wait for an item to be in the queue or the queue to be invalidated.
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_condition.wait(lock, [this](void) { return !m_queue.empty() || !m_valid; });
-
-        // Ensure queue is still valid since above predicate could fall through.
-        if(!m_valid)
-            return false;
-
-        // Get the item out of the queue.
-        item = std::move(m_queue.front());
-        m_queue.pop();
-        return true;
-    }
+    void       Execute() { m_invoke(m_storage); }
+    void       Discard() { m_destroy(m_storage); }
+    WaitGroup* GetGroup() const { return m_pGroup; }
 
 private:
-    std::atomic_bool        m_valid{ true };
-    std::queue<T>           m_queue;
-    std::mutex              m_mutex;
-    std::condition_variable m_condition;
+    alignas(std::max_align_t) uint8_t m_storage[INLINE_SIZE];
+    void (*m_invoke)(void*)  = {};
+    void (*m_destroy)(void*) = {};
+    WaitGroup* m_pGroup      = {};
 };
 
-// A ThreadPool class for parallel executions of tasks on across one or more threads.
+// A work-stealing ThreadPool for parallel executions of tasks on across one or more threads.
+// Every worker owns a lock-free deque; tasks spawned from a worker go to its own deque, tasks from any other
+// thread go to a shared lock-free injection queue. Idle workers steal from each other before parking.
+// Once the injection queue is full, AddTask() blocks threads outside the pool until a worker takes a task, while
+// workers run pending tasks inline until there is room.
 class ThreadPool
 {
 public:
-    // Task definition for code simplicity purposes.
-    using Task = std::function<void()>;
+    // Engine-wide pool sized to the hardware thread count (minus the calling thread).
+    static ThreadPool* GetDefault();
 
-    // Constructs the thread pool and sets the max thread count.
-    // No threads are allocated until tasks are added to the queue.
+    // Constructs the thread pool and spawns threadCount workers.
     ThreadPool(uint32_t threadCount);
 
-    // Blocks until all threads have completed.
+    // Blocks until all tasks have completed.
     ~ThreadPool();
 
-    // Adds a new task to the thread pool and returns a future handle.
-    std::shared_future<void> AddTask(Task&& task);
+    // Adds a new task to the thread pool, pGroup (if any) is signaled once the task has run.
+    template <typename F>
+    void AddTask(F&& func, WaitGroup* pGroup = nullptr)
+    {
+        Job* pJob = AllocateJob();
+        pJob->Set(std::forward<F>(func), pGroup);
+        if(pGroup)
+        {
+            pGroup->Add();
+        }
+        Submit(pJob);
+    }
 
     // Clear any pending tasks.
     void ClearPendingTasks();
 
-    // Waits on all threads to complete (blocking call).
+    // Waits on all tasks to complete. The calling thread executes pending tasks while waiting.
+    // Must not be called from a task of this pool, which would wait on itself: nested code waits on a WaitGroup.
     void Wait();
 
+    // Waits on the tasks tracked by the group. The calling thread executes pending tasks while waiting.
+    void Wait(const WaitGroup& group);
+
     // Cancels all pending tasks and waits for threads to complete current tasks.
     void Abort();
 
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
 private:
-    std::stack<std::thread>                     m_threads;
-    ThreadSafeQueue<std::packaged_task<void()>> m_tasks;
-    std::atomic<uint32_t>                       m_activeThreads{ 0U };
-    std::mutex                                  m_threadsCompleteMutex;
-    std::condition_variable                     m_threadsCompleteCondition;
+    struct Worker
+    {
+        WorkStealingQueue<Job*> queue;
+        std::thread             thread;
+    };
+
+    static Job* AllocateJob();
+    static void FreeJob(Job* pJob);
+
+    void Submit(Job* pJob);
+    void WorkerLoop(uint32_t workerIndex);
+    bool TryRunPendingTask();
+    bool FindTask(Job*& pJob);
+    void RunJob(Job* pJob);
+    void DiscardJob(Job* pJob);
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    static constexpr size_t INJECTION_QUEUE_CAPACITY = 16384;
+    BlockingMPMCQueue<Job*> m_injectionQueue{ INJECTION_QUEUE_CAPACITY };
+
+    alignas(64) std::atomic<uint32_t> m_queuedTasks{ 0U };
+    alignas(64) std::atomic<uint32_t> m_unfinishedTasks{ 0U };
+    alignas(64) std::atomic<uint32_t> m_sleepingThreads{ 0U };
+    std::atomic_bool                  m_stopping{ false };
+    std::mutex                        m_sleepMutex;
+    std::condition_variable           m_sleepCondition;
 };
 }  // namespace aph
 
@@ -13,7 +13,7 @@ public:
     {
         using ms   = std::chrono::duration<float, std::milli>;
         auto end   = std::chrono::steady_clock::now();
-        m_interval = std::chrono::duration_cast<ms>(m_start - end).count() / 1000.0f;
+        m_interval = std::chrono::duration_cast<ms>(end - m_start).count() / 1000.0f;
     }
 
 private:
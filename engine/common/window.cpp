@@ -3,16 +3,21 @@
 
 namespace aph
 {
-std::shared_ptr<Window> Window::Create(uint32_t width, uint32_t height)
+std::shared_ptr<Window> Window::Create(uint32_t width, uint32_t height, bool headless)
 {
-    auto instance = std::make_shared<Window>(width, height);
+    auto instance = std::make_shared<Window>(width, height, headless);
     return instance;
 }
 
-Window::Window(uint32_t width, uint32_t height)
+Window::Window(uint32_t width, uint32_t height, bool headless) : m_headless(headless)
 {
     m_windowData = std::make_shared<WindowData>(width, height);
     m_cursorData = std::make_shared<CursorData>(width / 2.0f, height / 2.0f);
+    if(m_headless)
+    {
+        return;
+    }
+
     assert(glfwInit());
     assert(glfwVulkanSupported());
 
@@ -27,6 +32,10 @@ Window::Window(uint32_t width, uint32_t height)
 
 Window::~Window()
 {
+    if(m_headless)
+    {
+        return;
+    }
     glfwDestroyWindow(m_windowData->window);
     glfwTerminate();
 }
@@ -34,6 +43,10 @@ Window::~Window()
 void Window::setFramebufferSizeCallback(const FramebufferSizeFunc& cbFunc)
 {
     m_framebufferResizeCB = cbFunc;
+    if(m_headless)
+    {
+        return;
+    }
     glfwSetFramebufferSizeCallback(getHandle(), [](GLFWwindow* window, int width, int height) {
         auto* ptr = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
         ptr->setWidth(width);
@@ -45,6 +58,10 @@ void Window::setFramebufferSizeCallback(const FramebufferSizeFunc& cbFunc)
 void Window::setCursorPosCallback(const CursorPosFunc& cbFunc)
 {
     m_cursorPosCB = cbFunc;
+    if(m_headless)
+    {
+        return;
+    }
 
     glfwSetCursorPosCallback(getHandle(), [](GLFWwindow* window, double xposIn, double yposIn) {
         Window* ptr = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
@@ -69,6 +86,10 @@ void Window::setCursorPosCallback(const CursorPosFunc& cbFunc)
 void Window::setKeyCallback(const KeyFunc& cbFunc)
 {
     m_keyCB = cbFunc;
+    if(m_headless)
+    {
+        return;
+    }
     glfwSetKeyCallback(getHandle(), [](GLFWwindow* window, int key, int scancode, int action, int mods) {
         auto* ptr = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
         ptr->m_keyCB(key, scancode, action, mods);
@@ -78,6 +99,10 @@ void Window::setKeyCallback(const KeyFunc& cbFunc)
 void Window::setMouseButtonCallback(const MouseButtonFunc& cbFunc)
 {
     m_mouseButtonCB = cbFunc;
+    if(m_headless)
+    {
+        return;
+    }
     glfwSetMouseButtonCallback(getHandle(), [](GLFWwindow* window, int button, int action, int mods) {
         auto* ptr = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
         ptr->m_mouseButtonCB(button, action, mods);
@@ -86,15 +111,41 @@ void Window::setMouseButtonCallback(const MouseButtonFunc& cbFunc)
 
 void Window::setCursorVisibility(bool flag)
 {
-    glfwSetInputMode(getHandle(), GLFW_CURSOR, flag ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
+    if(!m_headless)
+    {
+        glfwSetInputMode(getHandle(), GLFW_CURSOR, flag ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
+    }
     m_cursorData->isCursorVisible = flag;
 }
 
-void     Window::close() { glfwSetWindowShouldClose(getHandle(), true); }
-bool     Window::shouldClose() { return glfwWindowShouldClose(getHandle()); }
-void     Window::pollEvents() { glfwPollEvents(); }
+void Window::close()
+{
+    m_closed = true;
+    if(!m_headless)
+    {
+        glfwSetWindowShouldClose(getHandle(), true);
+    }
+}
+
+bool Window::shouldClose()
+{
+    return m_headless ? m_closed : glfwWindowShouldClose(getHandle());
+}
+
+void Window::pollEvents()
+{
+    if(!m_headless)
+    {
+        glfwPollEvents();
+    }
+}
+
 uint32_t Window::getKeyInputStatus(KeyCodeType keycode)
 {
+    if(m_headless)
+    {
+        return APH_RELEASE;
+    }
     auto status = glfwGetKey(getHandle(), keycode);
     // std::cout << "input status: " << keycode << " " << status << std::endl;
     return status;
@@ -102,6 +153,10 @@ uint32_t Window::getKeyInputStatus(KeyCodeType keycode)
 
 uint32_t Window::getMouseButtonStatus(KeyCodeType mouseButton)
 {
+    if(m_headless)
+    {
+        return APH_RELEASE;
+    }
     auto status = glfwGetMouseButton(getHandle(), GLFW_MOUSE_BUTTON_LEFT);
     // std::cout << "input status: " << mouseButton << " " << status << std::endl;
     return status;
@@ -37,9 +37,10 @@ using MouseButtonFunc     = std::function<void(int button, int action, int mods)
 class Window
 {
 public:
-    static std::shared_ptr<Window> Create(uint32_t width = 800, uint32_t height = 600);
+    // A headless window never touches GLFW: it only carries the size, reports no input and closes on close().
+    static std::shared_ptr<Window> Create(uint32_t width = 800, uint32_t height = 600, bool headless = false);
 
-    Window(uint32_t width, uint32_t height);
+    Window(uint32_t width, uint32_t height, bool headless = false);
     ~Window();
 
 public:
@@ -54,6 +55,7 @@ public:
     uint32_t                    getWidth() { return m_windowData->width; }
     uint32_t                    getHeight() { return m_windowData->height; }
     GLFWwindow*                 getHandle() { return m_windowData->window; }
+    bool                        isHeadless() const { return m_headless; }
     uint32_t                    getKeyInputStatus(KeyCodeType keycode);
     uint32_t                    getMouseButtonStatus(KeyCodeType mouseButton);
 
@@ -70,6 +72,8 @@ public:
 private:
     std::shared_ptr<WindowData> m_windowData = {};
     std::shared_ptr<CursorData> m_cursorData = {};
+    bool                        m_headless   = {};
+    bool                        m_closed     = {};
 
     FramebufferSizeFunc m_framebufferResizeCB;
     CursorPosFunc       m_cursorPosCB;
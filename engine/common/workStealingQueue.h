@@ -0,0 +1,89 @@
+#ifndef WORKSTEALINGQUEUE_H_
+#define WORKSTEALINGQUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace aph
+{
+// Bounded Chase-Lev work-stealing deque.
+// The owning thread pushes and pops at the bottom (LIFO), any other thread steals from the top (FIFO).
+// Elements are read racily before the claiming CAS, so T must be trivially copyable (usually a pointer).
+template <typename T, uint32_t Capacity = 4096>
+class WorkStealingQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "work stealing queue elements must be trivially copyable.");
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two.");
+
+public:
+    // Owner only. Returns false if the queue is full.
+    bool Push(T item)
+    {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t top    = m_top.load(std::memory_order_acquire);
+        if(bottom - top >= static_cast<int64_t>(Capacity))
+            return false;
+
+        m_buffer[bottom & MASK].store(item, std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Owner only.
+    bool Pop(T& item)
+    {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if(top > bottom)
+        {
+            // Queue was already empty.
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = m_buffer[bottom & MASK].load(std::memory_order_relaxed);
+        if(top == bottom)
+        {
+            // Last element, race against thieves for it.
+            bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread.
+    bool Steal(T& item)
+    {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if(top >= bottom)
+            return false;
+
+        item = m_buffer[top & MASK].load(std::memory_order_relaxed);
+        return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // Approximate when called concurrently.
+    bool Empty() const
+    {
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int64_t MASK = Capacity - 1;
+
+    alignas(64) std::atomic<int64_t> m_top{ 0 };
+    alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+    alignas(64) std::atomic<T> m_buffer[Capacity]{};
+};
+}  // namespace aph
+
+#endif  // WORKSTEALINGQUEUE_H_
@@ -1,26 +1,44 @@
 #include "renderer.h"
 
+#include <cstdlib>
 #include <utility>
 #include "sceneRenderer.h"
 #include "api/vulkan/device.h"
 
+#include "common/allocationTracker.h"
+#include "common/profiler.h"
 #include "scene/mesh.h"
 
 namespace aph
 {
 VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window, const RenderConfig& config) :
-    IRenderer(std::move(window), config)
+    IRenderer(std::move(window), config),
+    m_frameAllocator(config.maxFrames)
 {
+    Profiler::SetThreadName("Main");
+    // Headless and benchmark runs point this at a file to capture a Chrome trace of the whole run.
+    if(std::getenv("APH_PROFILE_TRACE"))
+    {
+        Profiler::StartCapture();
+    }
+    if(std::getenv("APH_FRAME_STATS_CSV"))
+    {
+        m_frameStats.setRecordHistory(true);
+    }
+
     // create instance
     {
         volkInitialize();
 
         std::vector<const char*> extensions{};
         {
-            uint32_t     glfwExtensionCount = 0;
-            const char** glfwExtensions;
-            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-            extensions     = std::vector<const char*>(glfwExtensions, glfwExtensions + glfwExtensionCount);
+            if(!m_config.headless)
+            {
+                uint32_t     glfwExtensionCount = 0;
+                const char** glfwExtensions;
+                glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+                extensions     = std::vector<const char*>(glfwExtensions, glfwExtensions + glfwExtensionCount);
+            }
 
             if(m_config.enableDebug)
             {
@@ -45,12 +63,15 @@ VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window, const RenderConfi
 
     // create device
     {
-        const std::vector<const char*> deviceExtensions = {
-            VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+        std::vector<const char*> deviceExtensions = {
             VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
             VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME,
             VK_KHR_MAINTENANCE_4_EXTENSION_NAME,
         };
+        if(!m_config.headless)
+        {
+            deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
 
         DeviceCreateInfo createInfo{
             .enabledExtensions = deviceExtensions,
@@ -87,10 +108,16 @@ VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window, const RenderConfi
 
     // setup swapchain
     {
-        VK_CHECK_RESULT(glfwCreateWindowSurface(m_pInstance->getHandle(), m_window->getHandle(), nullptr, &m_surface));
+        if(!m_config.headless)
+        {
+            VK_CHECK_RESULT(
+                glfwCreateWindowSurface(m_pInstance->getHandle(), m_window->getHandle(), nullptr, &m_surface));
+        }
         SwapChainCreateInfo createInfo{
             .surface      = m_surface,
             .windowHandle = m_window->getHandle(),
+            .width        = m_window->getWidth(),
+            .height       = m_window->getHeight(),
         };
         VK_CHECK_RESULT(m_pDevice->createSwapchain(createInfo, &m_pSwapChain));
     }
@@ -112,6 +139,10 @@ VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window, const RenderConfi
             m_pDevice->allocateCommandBuffers(m_commandBuffers.size(), m_commandBuffers.data(), getGraphicsQueue());
         }
 
+        {
+            m_pGpuProfiler = new VulkanGpuProfiler(m_pDevice, getGraphicsQueue(), m_config.maxFrames);
+        }
+
         {
             VkSemaphoreCreateInfo semaphoreInfo = aph::init::semaphoreCreateInfo();
             VkFenceCreateInfo     fenceInfo     = aph::init::fenceCreateInfo(VK_FENCE_CREATE_SIGNALED_BIT);
@@ -136,10 +167,27 @@ VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window, const RenderConfi
 
 void VulkanRenderer::beginFrame()
 {
-    VK_CHECK_RESULT(m_pDevice->waitForFence({ m_frameFences[m_frameIdx] }));
-    VK_CHECK_RESULT(m_pSwapChain->acquireNextImage(&m_imageIdx, m_renderSemaphore[m_frameIdx]));
+    Profiler::BeginFrame();
+    AllocationTracker::BeginFrame();
+    APH_PROFILE_FUNCTION();
+    AllocationScope allocationScope(AllocationTag::RENDERER);
+
+    using ms = std::chrono::duration<double, std::milli>;
+    {
+        auto waitStart = std::chrono::steady_clock::now();
+        VK_CHECK_RESULT(m_pDevice->waitForFence({ &m_frameFences[m_frameIdx], 1 }));
+        m_frameStats.record(FrameMetric::FENCE_WAIT, ms(std::chrono::steady_clock::now() - waitStart).count());
+    }
+    {
+        auto acquireStart = std::chrono::steady_clock::now();
+        VK_CHECK_RESULT(m_pSwapChain->acquireNextImage(&m_imageIdx, m_renderSemaphore[m_frameIdx]));
+        m_frameStats.record(FrameMetric::ACQUIRE_WAIT, ms(std::chrono::steady_clock::now() - acquireStart).count());
+    }
     VK_CHECK_RESULT(m_pSyncPrimitivesPool->releaseFence(m_frameFences[m_frameIdx]));
 
+    // The fence signalled, the GPU is done with everything this frame index allocated last time around.
+    m_frameAllocator.beginFrame(m_frameIdx);
+
     {
         m_timer = std::chrono::high_resolution_clock::now();
     }
@@ -147,17 +195,28 @@ void VulkanRenderer::beginFrame()
 
 void VulkanRenderer::endFrame()
 {
-    auto* queue = getGraphicsQueue();
+    APH_PROFILE_FUNCTION();
+    AllocationScope allocationScope(AllocationTag::RENDERER);
+
+    auto* queue     = getGraphicsQueue();
+    auto* pResource = m_frameAllocator.getResource();
 
     QueueSubmitInfo submitInfo{
-        .commandBuffers   = { m_commandBuffers[m_frameIdx] },
-        .waitStages       = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT },
-        .waitSemaphores   = { m_renderSemaphore[m_frameIdx] },
-        .signalSemaphores = { m_presentSemaphore[m_frameIdx] },
+        .commandBuffers   = { { m_commandBuffers[m_frameIdx] }, pResource },
+        .waitStages       = { { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT }, pResource },
+        .waitSemaphores   = { { m_renderSemaphore[m_frameIdx] }, pResource },
+        .signalSemaphores = { { m_presentSemaphore[m_frameIdx] }, pResource },
     };
+    // Nothing signals or waits on the semaphores without a real swapchain, the frame fence alone paces the frames.
+    if(m_pSwapChain->isHeadless())
+    {
+        submitInfo.waitStages.clear();
+        submitInfo.waitSemaphores.clear();
+        submitInfo.signalSemaphores.clear();
+    }
 
-    VK_CHECK_RESULT(queue->submit({ submitInfo }, m_frameFences[m_frameIdx]));
-    VK_CHECK_RESULT(m_pSwapChain->presentImage(m_imageIdx, queue, { m_presentSemaphore[m_frameIdx] }));
+    VK_CHECK_RESULT(queue->submit({ &submitInfo, 1 }, m_frameFences[m_frameIdx]));
+    VK_CHECK_RESULT(m_pSwapChain->presentImage(m_imageIdx, queue, { &m_presentSemaphore[m_frameIdx], 1 }));
 
     m_frameIdx = (m_frameIdx + 1) % m_config.maxFrames;
 
@@ -173,12 +232,46 @@ void VulkanRenderer::endFrame()
             m_frameCounter  = 0;
             m_lastTimestamp = tEnd;
         }
+
+        // The interval between two frame ends, so everything the application does in between is accounted for.
+        if(m_tPrevEnd.time_since_epoch().count() != 0)
+        {
+            m_frameStats.record(FrameMetric::CPU_FRAME,
+                                std::chrono::duration<double, std::milli>(tEnd - m_tPrevEnd).count());
+        }
+        if(m_pGpuProfiler && m_pGpuProfiler->getResolvedFrameCount() != m_gpuFramesRecorded)
+        {
+            m_gpuFramesRecorded = m_pGpuProfiler->getResolvedFrameCount();
+            m_frameStats.record(FrameMetric::GPU_FRAME, m_pGpuProfiler->getLastFrameTimeMs());
+        }
+        m_frameStats.endFrame();
         m_tPrevEnd = tEnd;
     }
 }
 
 void VulkanRenderer::cleanup()
 {
+    // Headless and benchmark runs point this at a file to keep the per-frame allocation history.
+    if(const char* pReportPath = std::getenv("APH_ALLOCATION_REPORT"); AllocationTracker::IsEnabled() && pReportPath)
+    {
+        AllocationTracker::WriteJson(pReportPath);
+    }
+    if(const char* pStatsPath = std::getenv("APH_FRAME_STATS_CSV"); pStatsPath)
+    {
+        m_frameStats.writeCsv(pStatsPath);
+    }
+    if(const char* pStatsPath = std::getenv("APH_FRAME_STATS_JSON"); pStatsPath)
+    {
+        m_frameStats.writeJson(pStatsPath);
+    }
+    if(const char* pTracePath = std::getenv("APH_PROFILE_TRACE"); pTracePath)
+    {
+        // Collects the zones of the last frame into the capture first.
+        Profiler::BeginFrame();
+        Profiler::StopCapture();
+        Profiler::WriteChromeTrace(pTracePath);
+    }
+
     for(auto& [key, shaderModule] : shaderModuleCaches)
     {
         vkDestroyShaderModule(m_pDevice->getHandle(), shaderModule->getHandle(), nullptr);
@@ -190,11 +283,19 @@ void VulkanRenderer::cleanup()
         delete m_pSyncPrimitivesPool;
     }
 
+    if(m_pGpuProfiler)
+    {
+        delete m_pGpuProfiler;
+    }
+
     vkDestroyPipelineCache(m_pDevice->getHandle(), m_pipelineCache, nullptr);
 
     m_pDevice->destroySwapchain(m_pSwapChain);
     VulkanDevice::Destroy(m_pDevice);
-    vkDestroySurfaceKHR(m_pInstance->getHandle(), m_surface, nullptr);
+    if(m_surface)
+    {
+        vkDestroySurfaceKHR(m_pInstance->getHandle(), m_surface, nullptr);
+    }
     VulkanInstance::Destroy(m_pInstance);
 }
 
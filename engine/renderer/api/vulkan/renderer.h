@@ -2,7 +2,10 @@
 #define VULKAN_RENDERER_H_
 
 #include "api/vulkan/device.h"
+#include "api/vulkan/gpuProfiler.h"
 #include "api/vulkan/shader.h"
+#include "common/frameAllocator.h"
+#include "common/frameStats.h"
 #include "renderer/renderer.h"
 
 namespace aph
@@ -28,8 +31,13 @@ public:
     VkPipelineCache     getPipelineCache() { return m_pipelineCache; }
     VulkanSwapChain*    getSwapChain() { return m_pSwapChain; }
     VulkanShaderModule* getShaders(const std::filesystem::path& path);
+    // Transient CPU memory of the frame being recorded, valid until the frame index comes around again.
+    FrameAllocator*     getFrameAllocator() { return &m_frameAllocator; }
+    const FrameStats&   getFrameStats() const { return m_frameStats; }
 
     VulkanSyncPrimitivesPool* getSyncPrimitiviesPool() { return m_pSyncPrimitivesPool; }
+    // Times the passes of the default command buffers, null without default resources.
+    VulkanGpuProfiler*        getGpuProfiler() const { return m_pGpuProfiler; }
     VulkanCommandBuffer*      getDefaultCommandBuffer(uint32_t idx) const { return m_commandBuffers[idx]; }
     uint32_t                  getCommandBufferCount() const { return m_commandBuffers.size(); }
 
@@ -39,6 +47,7 @@ public:
 
 protected:
     VulkanSyncPrimitivesPool* m_pSyncPrimitivesPool = {};
+    VulkanGpuProfiler*        m_pGpuProfiler        = {};
 
 protected:
     VulkanInstance*  m_pInstance  = {};
@@ -61,6 +70,11 @@ protected:
     std::vector<VkFence>              m_frameFences      = {};
     std::vector<VulkanCommandBuffer*> m_commandBuffers   = {};
 
+protected:
+    FrameAllocator m_frameAllocator;
+    FrameStats     m_frameStats;
+    uint64_t       m_gpuFramesRecorded = {};
+
 protected:
     uint32_t m_frameIdx = {};
     uint32_t m_imageIdx = {};
@@ -1,6 +1,10 @@
 #include "sceneRenderer.h"
 
+#include "common/allocationTracker.h"
 #include "common/assetManager.h"
+#include "common/logger.h"
+#include "common/parallel.h"
+#include "common/profiler.h"
 
 #include "scene/camera.h"
 #include "scene/light.h"
@@ -18,6 +22,23 @@
 
 namespace aph
 {
+// Lines of the profiler flame list shown in the overlay.
+constexpr uint32_t MAX_PROFILER_UI_ZONES = 128;
+// Moved mesh nodes per parallel chunk when refreshing draw bounds, each one transforms a box per subset.
+constexpr size_t   DRAW_BOUNDS_GRAIN_SIZE = 64;
+// Draws per parallel chunk of the occlusion test, each one projects the eight corners of its box.
+constexpr size_t   OCCLUSION_TEST_GRAIN_SIZE = 256;
+// Visible draws per parallel chunk of the level of detail selection.
+constexpr size_t   LOD_SELECT_GRAIN_SIZE = 256;
+// Occluders kept from the load-time selection, the ones past OcclusionSettings::maxOccluders stay disabled.
+constexpr uint32_t MAX_OCCLUDER_CANDIDATES = 256;
+// Depth buffer sizes offered in the overlay.
+constexpr std::array<std::pair<uint32_t, uint32_t>, 3> OCCLUSION_RESOLUTIONS = { {
+    { 128, 64 },
+    { 256, 128 },
+    { 512, 256 },
+} };
+
 struct SceneInfo
 {
     glm::vec4 ambient{0.04f};
@@ -58,6 +79,8 @@ void VulkanSceneRenderer::loadResources()
 {
     _loadScene();
     _initGpuResources();
+    _initDraws();
+    _initOccluders();
 
     _initSetLayout();
     _initSet();
@@ -102,35 +125,209 @@ void VulkanSceneRenderer::cleanupResources()
 
 void VulkanSceneRenderer::recordDrawSceneCommands()
 {
+    APH_PROFILE_FUNCTION();
+    AllocationScope allocationScope(AllocationTag::RENDERER);
+
     uint32_t frameIdx      = getCurrentFrameIndex();
     auto*    commandBuffer = getDefaultCommandBuffer(getCurrentFrameIndex());
 
     commandBuffer->begin();
+    getGpuProfiler()->beginFrame(commandBuffer, frameIdx);
 
     recordDrawSceneCommands(commandBuffer);
     recordPostFxCommands(commandBuffer);
 
+    getGpuProfiler()->endFrame(commandBuffer);
     commandBuffer->end();
 }
 
-void VulkanSceneRenderer::update(float deltaTime)
+void VulkanSceneRenderer::updateTransforms()
 {
+    APH_PROFILE_FUNCTION();
+    AllocationScope allocationScope(AllocationTag::SCENE);
+    // The world transforms of the whole tree are one array indexed like the transform buffer, a single copy uploads
+    // them once anything moved.
+    m_scene->updateTransforms();
+    if(!m_scene->getRootNode()->getChangedNodes().empty())
     {
-        SceneInfo sceneInfo = {
-            .ambient     = glm::vec4(m_scene->getAmbient(), 0.0f),
-            .cameraCount = static_cast<uint32_t>(m_cameraNodeList.size()),
-            .lightCount  = static_cast<uint32_t>(m_lightNodeList.size()),
-        };
-        m_buffers[BUFFER_SCENE_INFO]->write(&sceneInfo, 0, sizeof(SceneInfo));
+        writeTransforms();
+        updateDrawBounds();
+    }
+}
+
+void VulkanSceneRenderer::updateDrawBounds()
+{
+    const auto& changedNodes = m_scene->getRootNode()->getChangedNodes();
+    // Every moved node owns a disjoint range of draws.
+    parallelFor(
+        0, changedNodes.size(),
+        [this, &changedNodes](size_t idx) {
+            const SceneNode* pNode = changedNodes[idx];
+            uint32_t         slot  = pNode->getTransformIndex();
+            if(slot >= m_slotMeshNodes.size() || m_slotMeshNodes[slot] == UINT32_MAX)
+            {
+                return;
+            }
+            uint32_t    meshNode  = m_slotMeshNodes[slot];
+            const auto& subsets   = m_meshNodeList[meshNode]->getObject<Mesh>()->m_subsets;
+            glm::mat4   transform = pNode->getTransform();
+            for(uint32_t drawIdx = m_meshNodeDraws[meshNode]; drawIdx < m_meshNodeDraws[meshNode + 1]; drawIdx++)
+            {
+                m_culler.set(drawIdx, subsets[m_draws[drawIdx].subset].bounds.transform(transform));
+            }
+        },
+        DRAW_BOUNDS_GRAIN_SIZE);
+}
+
+void VulkanSceneRenderer::cullDraws()
+{
+    APH_PROFILE_FUNCTION();
+    AllocationScope allocationScope(AllocationTag::SCENE);
+    // The forward pass only renders from the first camera.
+    if(m_cameraNodeList.empty())
+    {
+        m_visibleDraws.clear();
+        m_drawStats = {.tested = m_culler.getCount()};
+        return;
+    }
+    const auto& camera   = m_cameraNodeList[0]->getObject<Camera>();
+    glm::mat4   viewProj = camera->getProjMatrix() * camera->getViewMatrix();
+    auto        visible  = m_culler.cull(Frustum::FromMatrix(viewProj));
+    m_visibleDraws.assign(visible.begin(), visible.end());
+
+    uint32_t occluded = 0;
+    if(m_occlusionSettings.enabled && m_occlusionSettings.maxOccluders > 0 && !m_occluderDraws.empty())
+    {
+        occluded = cullOccludedDraws(viewProj);
+    }
+    selectDrawLods(camera->getPosition(), camera->getProjMatrix());
+
+    m_drawStats = {
+        .tested   = m_culler.getCount(),
+        .visible  = static_cast<uint32_t>(m_visibleDraws.size()),
+        .occluded = occluded,
+    };
+    for(uint32_t drawIdx : m_visibleDraws)
+    {
+        const auto& mesh   = m_meshNodeList[m_draws[drawIdx].meshNode]->getObject<Mesh>();
+        const auto& subset = mesh->m_subsets[m_draws[drawIdx].subset];
+        uint32_t    lod    = m_drawLods[drawIdx];
+        m_drawStats.triangles += (lod > 0 ? subset.lods[lod - 1].indexCount : subset.indexCount) / 3;
+        m_drawStats.fullDetailTriangles += subset.indexCount / 3;
     }
+}
+
+void VulkanSceneRenderer::selectDrawLods(const glm::vec3& eye, const glm::mat4& proj)
+{
+    APH_PROFILE_FUNCTION();
+    auto transforms = m_scene->getRootNode()->getWorldTransforms();
+    // Pixels covered by a unit length facing the camera at unit distance.
+    float pixelScale = std::abs(proj[1][1]) * 0.5f * getWindowHeight();
+    parallelFor(
+        0, m_visibleDraws.size(),
+        [&](size_t idx) {
+            uint32_t    drawIdx = m_visibleDraws[idx];
+            const Draw& draw    = m_draws[drawIdx];
+            const auto& node    = m_meshNodeList[draw.meshNode];
+            const auto& lods    = node->getObject<Mesh>()->m_subsets[draw.subset].lods;
+            if(!m_lodSettings.enabled || lods.empty())
+            {
+                m_drawLods[drawIdx] = 0;
+                return;
+            }
 
-    for(uint32_t idx = 0; idx < m_meshNodeList.size(); idx++)
+            // Errors are in local space, scaled by the largest axis of the node and measured at the nearest point of
+            // the draw's bounds. From inside the bounds every level is too coarse.
+            const glm::mat4& transform = transforms[node->getTransformIndex()];
+            float            scale     = std::max({ glm::length(glm::vec3(transform[0])),
+                                                    glm::length(glm::vec3(transform[1])),
+                                                    glm::length(glm::vec3(transform[2])) });
+            AABB             bounds    = m_culler.getBounds(drawIdx);
+            float            distance  = glm::distance(eye, glm::clamp(eye, bounds.min, bounds.max));
+            auto             pixelError = [&](uint32_t lod) {
+                if(lod == 0)
+                {
+                    return 0.0f;
+                }
+                return distance > 0.0f ? lods[lod - 1].error * scale * pixelScale / distance
+                                       : std::numeric_limits<float>::max();
+            };
+
+            uint32_t lod = std::min<uint32_t>(m_drawLods[drawIdx], lods.size());
+            while(lod > 0 && pixelError(lod) > m_lodSettings.maxPixelError)
+            {
+                --lod;
+            }
+            while(lod < lods.size() &&
+                  pixelError(lod + 1) <= m_lodSettings.maxPixelError * (1.0f - m_lodSettings.hysteresis))
+            {
+                ++lod;
+            }
+            m_drawLods[drawIdx] = lod;
+        },
+        LOD_SELECT_GRAIN_SIZE);
+}
+
+uint32_t VulkanSceneRenderer::cullOccludedDraws(const glm::mat4& viewProj)
+{
+    APH_PROFILE_FUNCTION();
+    auto transforms = m_scene->getRootNode()->getWorldTransforms();
+    for(uint32_t occluder = 0; occluder < m_occluderDraws.size(); occluder++)
+    {
+        const auto& node = m_meshNodeList[m_draws[m_occluderDraws[occluder]].meshNode];
+        m_occlusionCuller.setOccluderTransform(occluder, transforms[node->getTransformIndex()]);
+    }
+    m_occlusionCuller.render(viewProj);
+
+    m_drawOccluded.resize(m_visibleDraws.size());
+    parallelFor(
+        0, m_visibleDraws.size(),
+        [this](size_t idx) {
+            m_drawOccluded[idx] = !m_occlusionCuller.isVisible(m_culler.getBounds(m_visibleDraws[idx]));
+        },
+        OCCLUSION_TEST_GRAIN_SIZE);
+
+    uint32_t kept = 0;
+    for(uint32_t idx = 0; idx < m_visibleDraws.size(); idx++)
     {
-        const auto& node = m_meshNodeList[idx];
-        auto        data = node->getTransform();
-        m_buffers[BUFFER_SCENE_TRANSFORM]->write(&data, sizeof(glm::mat4) * idx, sizeof(glm::mat4));
+        if(!m_drawOccluded[idx])
+        {
+            m_visibleDraws[kept++] = m_visibleDraws[idx];
+        }
     }
+    uint32_t occluded = m_visibleDraws.size() - kept;
+    m_visibleDraws.resize(kept);
+    return occluded;
+}
 
+void VulkanSceneRenderer::setOcclusionSettings(const OcclusionSettings& settings)
+{
+    m_occlusionSettings = settings;
+    m_occlusionCuller.setResolution(settings.width, settings.height);
+    for(uint32_t occluder = 0; occluder < m_occlusionCuller.getOccluderCount(); occluder++)
+    {
+        m_occlusionCuller.setOccluderEnabled(occluder, occluder < settings.maxOccluders);
+    }
+}
+
+void VulkanSceneRenderer::writeTransforms()
+{
+    // Sized for the tree at load time. Slots move once nodes are added, drawn nodes could then index past the end.
+    auto   transforms = m_scene->getRootNode()->getWorldTransforms();
+    size_t size       = m_buffers[BUFFER_SCENE_TRANSFORM]->getSize();
+    if(transforms.size_bytes() > size)
+    {
+        LOG_ASYNC_ERROR("scene has {} nodes, the transform buffer was sized for {} by loadResources()",
+                        transforms.size(), size / sizeof(glm::mat4));
+        assert(false && "scene nodes added after loadResources()");
+    }
+    m_buffers[BUFFER_SCENE_TRANSFORM]->write(transforms.data(), 0, std::min(transforms.size_bytes(), size));
+}
+
+void VulkanSceneRenderer::updateCameras(float deltaTime)
+{
+    APH_PROFILE_FUNCTION();
+    AllocationScope allocationScope(AllocationTag::SCENE);
     for(uint32_t idx = 0; idx < m_cameraNodeList.size(); idx++)
     {
         const auto& camera = m_cameraNodeList[idx]->getObject<Camera>();
@@ -142,6 +339,20 @@ void VulkanSceneRenderer::update(float deltaTime)
         };
         m_buffers[BUFFER_SCENE_CAMERA]->write(&cameraData, sizeof(CameraInfo) * idx, sizeof(CameraInfo));
     }
+}
+
+void VulkanSceneRenderer::updateLights()
+{
+    APH_PROFILE_FUNCTION();
+    AllocationScope allocationScope(AllocationTag::SCENE);
+    {
+        SceneInfo sceneInfo = {
+            .ambient     = glm::vec4(m_scene->getAmbient(), 0.0f),
+            .cameraCount = static_cast<uint32_t>(m_cameraNodeList.size()),
+            .lightCount  = static_cast<uint32_t>(m_lightNodeList.size()),
+        };
+        m_buffers[BUFFER_SCENE_INFO]->write(&sceneInfo, 0, sizeof(SceneInfo));
+    }
 
     for(uint32_t idx = 0; idx < m_lightNodeList.size(); idx++)
     {
@@ -154,8 +365,6 @@ void VulkanSceneRenderer::update(float deltaTime)
         };
         m_buffers[BUFFER_SCENE_LIGHT]->write(&lightData, sizeof(LightInfo) * idx, sizeof(LightInfo));
     }
-
-    _updateUI(deltaTime);
 }
 
 void VulkanSceneRenderer::_initSet()
@@ -196,7 +405,7 @@ void VulkanSceneRenderer::_initSet()
 
     std::vector<VkWriteDescriptorSet> writes{
         aph::init::writeDescriptorSet(m_sceneSet, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &sceneBufferInfo, 1),
-        aph::init::writeDescriptorSet(m_sceneSet, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, &transformBufferInfo, 1),
+        aph::init::writeDescriptorSet(m_sceneSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, &transformBufferInfo, 1),
         aph::init::writeDescriptorSet(m_sceneSet, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2, &cameraBufferInfo, 1),
         aph::init::writeDescriptorSet(m_sceneSet, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3, &lightBufferInfo, 1),
         aph::init::writeDescriptorSet(m_sceneSet, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 4, textureInfos.data(),
@@ -244,6 +453,120 @@ void VulkanSceneRenderer::_loadScene()
     }
 }
 
+void VulkanSceneRenderer::_initDraws()
+{
+    // Transform slots are assigned by the update in _initGpuResources().
+    auto transforms = m_scene->getRootNode()->getWorldTransforms();
+    m_slotMeshNodes.assign(transforms.size(), UINT32_MAX);
+    for(uint32_t nodeIdx = 0; nodeIdx < m_meshNodeList.size(); nodeIdx++)
+    {
+        const auto& node = m_meshNodeList[nodeIdx];
+        const auto& mesh = node->getObject<Mesh>();
+        uint32_t    slot = node->getTransformIndex();
+        m_slotMeshNodes[slot] = nodeIdx;
+        m_meshNodeDraws.push_back(m_draws.size());
+        for(uint32_t subsetIdx = 0; subsetIdx < mesh->m_subsets.size(); subsetIdx++)
+        {
+            // The forward pipeline takes triangle lists, strips and fans were converted at import. Points and lines
+            // are not drawn.
+            const auto& subset = mesh->m_subsets[subsetIdx];
+            if(!subset.isTriangleList())
+            {
+                LOG_ASYNC_WARN("mesh node '{}': subset {} is not a triangle list, it is not drawn", node->getName(),
+                               subsetIdx);
+                continue;
+            }
+            m_draws.push_back({.meshNode = nodeIdx, .subset = subsetIdx});
+            m_culler.add(subset.bounds.transform(transforms[slot]));
+        }
+    }
+    m_meshNodeDraws.push_back(m_draws.size());
+    m_drawLods.assign(m_draws.size(), 0);
+}
+
+void VulkanSceneRenderer::_initOccluders()
+{
+    auto vertices   = m_scene->getVertices();
+    auto indices    = m_scene->getIndices();
+    auto materials  = m_scene->getMaterials();
+    auto transforms = m_scene->getRootNode()->getWorldTransforms();
+
+    // Large solid surfaces hide the most, anything alpha tested or blended can be seen through.
+    std::vector<std::pair<float, uint32_t>> candidates;
+    for(uint32_t drawIdx = 0; drawIdx < m_draws.size(); drawIdx++)
+    {
+        const auto& node   = m_meshNodeList[m_draws[drawIdx].meshNode];
+        const auto& mesh   = node->getObject<Mesh>();
+        const auto& subset = mesh->m_subsets[m_draws[drawIdx].subset];
+        bool        opaque = subset.materialIndex < 0 ||
+                      static_cast<size_t>(subset.materialIndex) >= materials.size() ||
+                      materials[subset.materialIndex].alphaMode == AlphaMode::OPAQUE;
+        if(!opaque || !subset.hasIndices || subset.indexCount / 3 > m_occlusionSettings.maxOccluderTriangles)
+        {
+            continue;
+        }
+        AABB bounds = subset.bounds.transform(transforms[node->getTransformIndex()]);
+        candidates.push_back({bounds.getSurfaceArea(), drawIdx});
+    }
+    std::sort(candidates.begin(), candidates.end(), std::greater<>());
+    candidates.resize(std::min<size_t>(candidates.size(), MAX_OCCLUDER_CANDIDATES));
+
+    // Read back the way the GPU draws them: indices of the mesh's type counted from the start of the index buffer,
+    // offset by the mesh's first vertex.
+    for(const auto& [area, drawIdx] : candidates)
+    {
+        const auto& mesh      = m_meshNodeList[m_draws[drawIdx].meshNode]->getObject<Mesh>();
+        const auto& subset    = mesh->m_subsets[m_draws[drawIdx].subset];
+        size_t      indexSize = mesh->m_indexType == IndexType::UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        size_t      first     = mesh->m_indexOffset + subset.firstIndex;
+        if((first + subset.indexCount) * indexSize > indices.size())
+        {
+            continue;
+        }
+
+        std::vector<glm::vec3>               positions;
+        std::vector<uint32_t>                occluderIndices;
+        std::unordered_map<size_t, uint32_t> remap;
+        bool                                 valid = true;
+        for(uint32_t idx = 0; idx < subset.indexCount && valid; idx++)
+        {
+            const uint8_t* pIndex = &indices[(first + idx) * indexSize];
+            size_t         vertex = mesh->m_vertexOffset;
+            if(mesh->m_indexType == IndexType::UINT16)
+            {
+                uint16_t index;
+                memcpy(&index, pIndex, sizeof(index));
+                vertex += index;
+            }
+            else
+            {
+                uint32_t index;
+                memcpy(&index, pIndex, sizeof(index));
+                vertex += index;
+            }
+            valid = (vertex + 1) * sizeof(Vertex) <= vertices.size();
+            if(valid)
+            {
+                auto [it, inserted] = remap.try_emplace(vertex, positions.size());
+                if(inserted)
+                {
+                    glm::vec3 position;
+                    memcpy(&position, &vertices[vertex * sizeof(Vertex) + offsetof(Vertex, pos)], sizeof(position));
+                    positions.push_back(position);
+                }
+                occluderIndices.push_back(it->second);
+            }
+        }
+        if(valid)
+        {
+            m_occlusionCuller.addOccluder(std::move(positions), std::move(occluderIndices));
+            m_occluderDraws.push_back(drawIdx);
+        }
+    }
+
+    setOcclusionSettings(m_occlusionSettings);
+}
+
 void VulkanSceneRenderer::_initPostFx()
 {
     // build pipeline
@@ -339,7 +662,7 @@ void VulkanSceneRenderer::_initSetLayout()
         std::vector<VkDescriptorSetLayoutBinding> bindings{
             aph::init::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
                                                   VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, 1),
-            aph::init::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            aph::init::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                                                   VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 1),
             aph::init::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
                                                   VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 2),
@@ -410,6 +733,7 @@ void VulkanSceneRenderer::_initSetLayout()
 
 void VulkanSceneRenderer::_initGpuResources()
 {
+    APH_PROFILE_FUNCTION();
     // create scene info buffer
     {
         BufferCreateInfo createInfo{
@@ -444,49 +768,65 @@ void VulkanSceneRenderer::_initGpuResources()
 
     // create transform buffer
     {
+        // One slot per node of the tree, meshes or not. A storage buffer, a uniform one is only guaranteed to hold
+        // 256 matrices.
+        m_scene->updateTransforms();
         BufferCreateInfo createInfo{
-            .size     = static_cast<uint32_t>(m_meshNodeList.size() * sizeof(glm::mat4)),
-            .usage    = BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            .size     = static_cast<uint32_t>(m_scene->getRootNode()->getWorldTransforms().size_bytes()),
+            .usage    = BUFFER_USAGE_STORAGE_BUFFER_BIT,
             .property = MEMORY_PROPERTY_HOST_VISIBLE_BIT | MEMORY_PROPERTY_HOST_COHERENT_BIT,
         };
         m_pDevice->createBuffer(createInfo, &m_buffers[BUFFER_SCENE_TRANSFORM]);
         m_pDevice->mapMemory(m_buffers[BUFFER_SCENE_TRANSFORM]);
+
+        writeTransforms();
     }
 
+    // The scene's buffers and textures upload concurrently, each one is recorded and waited for on the default pool.
+    auto                        indicesList  = m_scene->getIndices();
+    auto                        verticesList = m_scene->getVertices();
+    auto                        materials    = m_scene->getMaterials();
+    auto                        images       = m_scene->getImages();
+    std::vector<Task<VkResult>> uploads;
+    uploads.reserve(3 + images.size());
+
     // create index buffer
     {
-        auto             indicesList = m_scene->getIndices();
         BufferCreateInfo createInfo{
             .size  = static_cast<uint32_t>(indicesList.size()),
             .usage = BUFFER_USAGE_INDEX_BUFFER_BIT,
         };
-        m_pDevice->createDeviceLocalBuffer(createInfo, &m_buffers[BUFFER_SCENE_INDEX], indicesList.data());
+        uploads.push_back(m_pDevice->createDeviceLocalBufferAsync(createInfo, &m_buffers[BUFFER_SCENE_INDEX],
+                                                                  indicesList.data()));
     }
 
     // create vertex buffer
     {
-        auto             verticesList = m_scene->getVertices();
         BufferCreateInfo createInfo{
             .size  = static_cast<uint32_t>(verticesList.size()),
             .usage = BUFFER_USAGE_VERTEX_BUFFER_BIT,
         };
-        m_pDevice->createDeviceLocalBuffer(createInfo, &m_buffers[BUFFER_SCENE_VERTEX], verticesList.data());
+        uploads.push_back(m_pDevice->createDeviceLocalBufferAsync(createInfo, &m_buffers[BUFFER_SCENE_VERTEX],
+                                                                  verticesList.data()));
     }
 
     // create material buffer
     {
-        auto             materials = m_scene->getMaterials();
         BufferCreateInfo createInfo{
             .size  = static_cast<uint32_t>(materials.size() * sizeof(Material)),
             .usage = BUFFER_USAGE_UNIFORM_BUFFER_BIT,
         };
-        m_pDevice->createDeviceLocalBuffer(createInfo, &m_buffers[BUFFER_SCENE_MATERIAL], materials.data());
+        uploads.push_back(m_pDevice->createDeviceLocalBufferAsync(createInfo, &m_buffers[BUFFER_SCENE_MATERIAL],
+                                                                  materials.data()));
     }
 
-    // load scene image to gpu
-    auto images = m_scene->getImages();
-    for(const auto& image : images)
+    // load scene image to gpu, sized up front so the tasks write to stable slots
+    auto&  textures     = m_images[IMAGE_SCENE_TEXTURES];
+    size_t firstTexture = textures.size();
+    textures.resize(firstTexture + images.size());
+    for(size_t i = 0; i < images.size(); ++i)
     {
+        const auto&     image = images[i];
         ImageCreateInfo createInfo{
             .extent    = {image->width, image->height, 1},
             .mipLevels = aph::utils::calculateFullMipLevels(image->width, image->height),
@@ -494,10 +834,21 @@ void VulkanSceneRenderer::_initGpuResources()
             .format    = Format::R8G8B8A8_UNORM,
             .tiling    = ImageTiling::OPTIMAL,
         };
+        uploads.push_back(
+            m_pDevice->createDeviceLocalImageAsync(createInfo, &textures[firstTexture + i], image->data));
+    }
 
-        VulkanImage* texture{};
-        m_pDevice->createDeviceLocalImage(createInfo, &texture, image->data);
-        m_images[IMAGE_SCENE_TEXTURES].push_back(texture);
+    for(auto& upload : uploads)
+    {
+        upload.start();
+    }
+    for(auto& upload : uploads)
+    {
+        VkResult result = syncWait(upload);
+        if(result != VK_SUCCESS)
+        {
+            LOG_ASYNC_ERROR("scene upload failed: {}", static_cast<int>(result));
+        }
     }
 
     // create skybox cubemap
@@ -590,6 +941,8 @@ void VulkanSceneRenderer::recordDrawSceneCommands(VulkanCommandBuffer* pCommandB
 
     // forward pass
     {
+        GpuProfileScope gpuScope(getGpuProfiler(), pCommandBuffer, "forward pass");
+
         VulkanImageView*          pColorAttachment   = m_images[IMAGE_FORWARD_COLOR][imageIdx]->getImageView();
         VulkanImageView*          pColorAttachmentMS = m_images[IMAGE_FORWARD_COLOR_MS][imageIdx]->getImageView();
         VkRenderingAttachmentInfo forwardColorAttachmentInfo{
@@ -652,6 +1005,7 @@ void VulkanSceneRenderer::recordDrawSceneCommands(VulkanCommandBuffer* pCommandB
 
         // skybox
         {
+            GpuProfileScope gpuScope(getGpuProfiler(), pCommandBuffer, "skybox");
             pCommandBuffer->bindPipeline(m_pipelines[PIPELINE_GRAPHICS_SKYBOX]);
             pCommandBuffer->bindDescriptorSet(m_pipelines[PIPELINE_GRAPHICS_SKYBOX], 0, 1, &m_sceneSet);
             pCommandBuffer->bindDescriptorSet(m_pipelines[PIPELINE_GRAPHICS_SKYBOX], 1, 1, &m_samplerSet);
@@ -661,50 +1015,61 @@ void VulkanSceneRenderer::recordDrawSceneCommands(VulkanCommandBuffer* pCommandB
 
         // draw scene object
         {
+            GpuProfileScope gpuScope(getGpuProfiler(), pCommandBuffer, "opaque");
             pCommandBuffer->bindPipeline(m_pipelines[PIPELINE_GRAPHICS_FORWARD]);
             pCommandBuffer->bindDescriptorSet(m_pipelines[PIPELINE_GRAPHICS_FORWARD], 0, 1, &m_sceneSet);
             pCommandBuffer->bindDescriptorSet(m_pipelines[PIPELINE_GRAPHICS_FORWARD], 1, 1, &m_samplerSet);
             pCommandBuffer->bindVertexBuffers(0, 1, m_buffers[BUFFER_SCENE_VERTEX], {0});
 
-            for(uint32_t nodeId = 0; nodeId < m_meshNodeList.size(); nodeId++)
+            // Visible draws from the last cullDraws(), ascending, so the draws of a node follow each other and its
+            // transform and index buffer are only bound once.
+            uint32_t              currentNode = UINT32_MAX;
+            std::shared_ptr<Mesh> mesh        = {};
+            for(uint32_t drawIdx : m_visibleDraws)
             {
-                const auto& node = m_meshNodeList[nodeId];
-                auto        mesh = node->getObject<Mesh>();
-                pCommandBuffer->pushConstants(m_pipelines[PIPELINE_GRAPHICS_FORWARD],
-                                              VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                                              offsetof(ObjectInfo, nodeId), sizeof(ObjectInfo::nodeId), &nodeId);
-                if(mesh->m_indexOffset > -1)
-                {
-                    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
-                    switch(mesh->m_indexType)
-                    {
-                    case IndexType::UINT16: indexType = VK_INDEX_TYPE_UINT16; break;
-                    case IndexType::UINT32: indexType = VK_INDEX_TYPE_UINT32; break;
-                    default: assert("undefined behavior."); break;
-                    }
-                    pCommandBuffer->bindIndexBuffers(m_buffers[BUFFER_SCENE_INDEX], 0, indexType);
-                }
-                for(const auto& subset : mesh->m_subsets)
+                const Draw& draw = m_draws[drawIdx];
+                if(draw.meshNode != currentNode)
                 {
-                    if(subset.indexCount > 0)
+                    currentNode     = draw.meshNode;
+                    mesh            = m_meshNodeList[currentNode]->getObject<Mesh>();
+                    uint32_t nodeId = m_meshNodeList[currentNode]->getTransformIndex();
+                    pCommandBuffer->pushConstants(m_pipelines[PIPELINE_GRAPHICS_FORWARD],
+                                                  VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                                  offsetof(ObjectInfo, nodeId), sizeof(ObjectInfo::nodeId), &nodeId);
+                    if(mesh->m_indexOffset > -1)
                     {
-                        pCommandBuffer->pushConstants(m_pipelines[PIPELINE_GRAPHICS_FORWARD],
-                                                      VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                                                      offsetof(ObjectInfo, materialId), sizeof(ObjectInfo::materialId),
-                                                      &subset.materialIndex);
-                        if(subset.hasIndices)
+                        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+                        switch(mesh->m_indexType)
                         {
-                            pCommandBuffer->drawIndexed(subset.indexCount, 1, mesh->m_indexOffset + subset.firstIndex,
-                                                        mesh->m_vertexOffset, 0);
+                        case IndexType::UINT16: indexType = VK_INDEX_TYPE_UINT16; break;
+                        case IndexType::UINT32: indexType = VK_INDEX_TYPE_UINT32; break;
+                        default: assert("undefined behavior."); break;
                         }
-                        else { pCommandBuffer->draw(subset.vertexCount, 1, subset.firstVertex, 0); }
+                        pCommandBuffer->bindIndexBuffers(m_buffers[BUFFER_SCENE_INDEX], 0, indexType);
                     }
                 }
+
+                const auto& subset = mesh->m_subsets[draw.subset];
+                pCommandBuffer->pushConstants(m_pipelines[PIPELINE_GRAPHICS_FORWARD],
+                                              VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                              offsetof(ObjectInfo, materialId), sizeof(ObjectInfo::materialId),
+                                              &subset.materialIndex);
+                if(subset.hasIndices)
+                {
+                    // Levels of detail index the same vertices, only their index range differs.
+                    uint32_t lod        = m_drawLods[drawIdx];
+                    auto     firstIndex = lod > 0 ? subset.lods[lod - 1].firstIndex : subset.firstIndex;
+                    auto     indexCount = lod > 0 ? subset.lods[lod - 1].indexCount : subset.indexCount;
+                    pCommandBuffer->drawIndexed(indexCount, 1, mesh->m_indexOffset + firstIndex, mesh->m_vertexOffset,
+                                                0);
+                }
+                else { pCommandBuffer->draw(subset.vertexCount, 1, subset.firstVertex, 0); }
             }
         }
 
         // draw ui
         {
+            GpuProfileScope gpuScope(getGpuProfiler(), pCommandBuffer, "ui");
             if(m_pUIRenderer) { m_pUIRenderer->draw(pCommandBuffer); }
         }
 
@@ -723,6 +1088,8 @@ void VulkanSceneRenderer::recordPostFxCommands(VulkanCommandBuffer* pCommandBuff
     uint32_t imageIdx = getCurrentImageIndex();
     // post fx
     {
+        GpuProfileScope gpuScope(getGpuProfiler(), pCommandBuffer, "postFx");
+
         VulkanImageView* pColorAttachment = getSwapChain()->getImage(imageIdx)->getImageView();
 
         pCommandBuffer->transitionImageLayout(pColorAttachment->getImage(), VK_IMAGE_LAYOUT_UNDEFINED,
@@ -736,7 +1103,7 @@ void VulkanSceneRenderer::recordPostFxCommands(VulkanCommandBuffer* pCommandBuff
             VkDescriptorImageInfo outputImageInfo{.imageView   = pColorAttachment->getHandle(),
                                                   .imageLayout = VK_IMAGE_LAYOUT_GENERAL};
 
-            std::vector<VkWriteDescriptorSet> writes{
+            std::array<VkWriteDescriptorSet, 2> writes{
                 aph::init::writeDescriptorSet(nullptr, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0, &inputImageInfo),
                 aph::init::writeDescriptorSet(nullptr, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, &outputImageInfo),
             };
@@ -747,27 +1114,37 @@ void VulkanSceneRenderer::recordPostFxCommands(VulkanCommandBuffer* pCommandBuff
         pCommandBuffer->dispatch(pColorAttachment->getImage()->getWidth(), pColorAttachment->getImage()->getHeight(),
                                  1);
         pCommandBuffer->transitionImageLayout(pColorAttachment->getImage(), VK_IMAGE_LAYOUT_GENERAL,
-                                              VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+                                              getSwapChain()->getPresentLayout());
     }
 }
 
-void VulkanSceneRenderer::_updateUI(float deltaTime)
+void VulkanSceneRenderer::updateUIInput()
 {
+    AllocationScope allocationScope(AllocationTag::UI);
     ImGuiIO& io = ImGui::GetIO();
 
-    io.DisplaySize = ImVec2(m_window->getWidth(), m_window->getHeight());
-    io.DeltaTime   = 1.0f;
-
     io.AddMousePosEvent(m_window->getCursorXpos(), m_window->getCursorYpos());
     io.AddMouseButtonEvent(0, m_window->getMouseButtonStatus(APH_MOUSE_BUTTON_LEFT) == APH_PRESS);
     io.AddMouseButtonEvent(1, m_window->getMouseButtonStatus(APH_MOUSE_BUTTON_RIGHT) == APH_PRESS);
     io.AddMouseButtonEvent(2, m_window->getMouseButtonStatus(APH_MOUSE_BUTTON_MIDDLE) == APH_PRESS);
+}
+
+void VulkanSceneRenderer::updateUI(float deltaTime)
+{
+    APH_PROFILE_FUNCTION();
+    AllocationScope allocationScope(AllocationTag::UI);
+    ImGuiIO& io = ImGui::GetIO();
+
+    io.DisplaySize = ImVec2(m_window->getWidth(), m_window->getHeight());
+    io.DeltaTime   = 1.0f;
 
     ImGui::NewFrame();
 
     m_pUIRenderer->drawWindow("Aphrodite - Info", {10, 10}, {0, 0}, [this]() {
         m_pUIRenderer->text("%s", m_pDevice->getPhysicalDevice()->getProperties().deviceName);
         m_pUIRenderer->text("%.2f ms/frame (%.1d fps)", (1000.0f / m_lastFPS), m_lastFPS);
+        m_pUIRenderer->text("draws : %u visible / %u tested, %u occluded", m_drawStats.visible, m_drawStats.tested,
+                            m_drawStats.occluded);
         m_pUIRenderer->drawWithItemWidth(110.0f, [this]() {
             if(m_pUIRenderer->header("Scene"))
             {
@@ -812,6 +1189,150 @@ void VulkanSceneRenderer::_updateUI(float deltaTime)
                                     camera->getPosition().z);
                 m_pUIRenderer->text("fov : %f", camera->getFov());
             }
+
+            if(m_pUIRenderer->header("Occlusion"))
+            {
+                OcclusionSettings settings = m_occlusionSettings;
+                bool              changed  = m_pUIRenderer->checkBox("enabled", &settings.enabled);
+
+                // The list is fixed, its names are only built once.
+                if(m_occlusionResolutionNames.empty())
+                {
+                    for(auto [width, height] : OCCLUSION_RESOLUTIONS)
+                    {
+                        m_occlusionResolutionNames.push_back(std::to_string(width) + "x" + std::to_string(height));
+                    }
+                }
+                int32_t resolution = -1;
+                for(uint32_t idx = 0; idx < OCCLUSION_RESOLUTIONS.size(); idx++)
+                {
+                    auto [width, height] = OCCLUSION_RESOLUTIONS[idx];
+                    if(width == m_occlusionCuller.getWidth() && height == m_occlusionCuller.getHeight())
+                    {
+                        resolution = idx;
+                    }
+                }
+                if(m_pUIRenderer->comboBox("depth buffer", &resolution, m_occlusionResolutionNames) && resolution >= 0)
+                {
+                    std::tie(settings.width, settings.height) = OCCLUSION_RESOLUTIONS[resolution];
+                    changed                                   = true;
+                }
+
+                int32_t maxOccluders = std::min(settings.maxOccluders, m_occlusionCuller.getOccluderCount());
+                if(m_pUIRenderer->sliderInt("occluders", &maxOccluders, 0, m_occlusionCuller.getOccluderCount()))
+                {
+                    settings.maxOccluders = maxOccluders;
+                    changed               = true;
+                }
+                if(changed)
+                {
+                    setOcclusionSettings(settings);
+                }
+
+                m_pUIRenderer->text("%ux%u, %u triangles rasterized", m_occlusionCuller.getWidth(),
+                                    m_occlusionCuller.getHeight(), m_occlusionCuller.getRasterizedTriangleCount());
+                m_pUIRenderer->text("occluded : %u draws", m_drawStats.occluded);
+            }
+
+            if(m_pUIRenderer->header("LOD"))
+            {
+                m_pUIRenderer->checkBox("enabled", &m_lodSettings.enabled);
+                m_pUIRenderer->sliderFloat("max pixel error", &m_lodSettings.maxPixelError, 0.25f, 8.0f);
+                m_pUIRenderer->sliderFloat("hysteresis", &m_lodSettings.hysteresis, 0.0f, 0.9f);
+                m_pUIRenderer->text("triangles : %llu / %llu at full detail",
+                                    static_cast<unsigned long long>(m_drawStats.triangles),
+                                    static_cast<unsigned long long>(m_drawStats.fullDetailTriangles));
+            }
+
+            if(AllocationTracker::IsEnabled() && m_pUIRenderer->header("Allocations"))
+            {
+                auto report = AllocationTracker::GetLastFrameReport();
+                m_pUIRenderer->text("last frame : %llu allocations",
+                                    static_cast<unsigned long long>(report.getTotalAllocations()));
+                for(uint32_t idx = 0; idx < report.tags.size(); idx++)
+                {
+                    auto tag   = static_cast<AllocationTag>(idx);
+                    auto stats = AllocationTracker::GetStats(tag);
+                    m_pUIRenderer->text("%-8s : %llu allocs, %llu B, live %lld B, peak %lld B",
+                                        AllocationTracker::GetTagName(tag),
+                                        static_cast<unsigned long long>(report.tags[idx].allocations),
+                                        static_cast<unsigned long long>(report.tags[idx].bytes),
+                                        static_cast<long long>(stats.liveBytes),
+                                        static_cast<long long>(stats.peakBytes));
+                }
+            }
+
+            if(m_pUIRenderer->header("Frame stats"))
+            {
+                const auto& stats = getFrameStats();
+                for(uint32_t idx = 0; idx < static_cast<uint32_t>(FrameMetric::COUNT); idx++)
+                {
+                    auto metric  = static_cast<FrameMetric>(idx);
+                    auto summary = stats.getSummary(metric);
+                    m_pUIRenderer->text("%-12s p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms",
+                                        FrameStats::GetMetricName(metric), summary.p50Ms, summary.p95Ms, summary.p99Ms,
+                                        summary.maxMs);
+                }
+
+                auto                                             histogram = stats.getHistogram(FrameMetric::CPU_FRAME);
+                std::array<float, FrameStats::HISTOGRAM_BUCKETS> buckets;
+                std::copy(histogram.begin(), histogram.end(), buckets.begin());
+                m_pUIRenderer->plotHistogram("cpu frame (1 ms buckets)", buckets);
+
+                m_pUIRenderer->text("spikes : %llu", static_cast<unsigned long long>(stats.getSpikeCount()));
+                if(!stats.getSpikes().empty())
+                {
+                    const auto& spike = stats.getSpikes().back();
+                    m_pUIRenderer->text("last spike : frame %llu, %.2f ms (median %.2f ms)",
+                                        static_cast<unsigned long long>(spike.frame), spike.valueMs, spike.medianMs);
+                }
+            }
+
+            if(getGpuProfiler()->isSupported() && m_pUIRenderer->header("GPU"))
+            {
+                m_pUIRenderer->text("%.3f ms/frame", getGpuProfiler()->getLastFrameTimeMs());
+                for(const auto& zone : getGpuProfiler()->getLastFrameZones())
+                {
+                    m_pUIRenderer->text("%*s%s %.3f ms", zone.depth * 2, "", zone.name, zone.durationMs);
+                }
+            }
+
+            if(Profiler::IsEnabled() && m_pUIRenderer->header("Profiler"))
+            {
+                bool capturing = Profiler::IsCapturing();
+                if(m_pUIRenderer->checkBox("capture trace", &capturing))
+                {
+                    if(capturing)
+                    {
+                        Profiler::StartCapture();
+                    }
+                    else
+                    {
+                        Profiler::StopCapture();
+                        Profiler::WriteChromeTrace("aphrodite_trace.json");
+                    }
+                }
+
+                // Flame list of the last frame, one block per thread with children indented below their parent.
+                Profiler::GetLastFrameZones(m_profilerZones);
+                Profiler::GetThreads(m_profilerThreads);
+                uint32_t lastThread = UINT32_MAX;
+                uint32_t lineCount  = 0;
+                for(const auto& zone : m_profilerZones)
+                {
+                    if(zone.threadIndex != lastThread)
+                    {
+                        lastThread = zone.threadIndex;
+                        m_pUIRenderer->text("[%s]", m_profilerThreads[zone.threadIndex].name.c_str());
+                    }
+                    if(++lineCount > MAX_PROFILER_UI_ZONES)
+                    {
+                        m_pUIRenderer->text("...");
+                        break;
+                    }
+                    m_pUIRenderer->text("%*s%s %.3f ms", zone.depth * 2, "", zone.name, zone.durationNs / 1e6);
+                }
+            }
         });
     });
 
@@ -2,12 +2,47 @@
 #define VKSCENERENDERER_H_
 
 #include "api/vulkan/device.h"
+#include "common/profiler.h"
 #include "renderer.h"
 #include "uiRenderer.h"
 #include "renderer/sceneRenderer.h"
+#include "scene/culling.h"
+#include "scene/occlusion.h"
 
 namespace aph
 {
+struct DrawStats
+{
+    uint32_t tested   = {};
+    uint32_t visible  = {};
+    // Inside the frustum but hidden by the occluders.
+    uint32_t occluded = {};
+    // Triangles of the visible draws at their selected level of detail, and at full detail.
+    uint64_t triangles           = {};
+    uint64_t fullDetailTriangles = {};
+};
+
+struct LodSettings
+{
+    bool  enabled       = { true };
+    // A draw uses the coarsest level whose error projects to at most this many pixels on screen.
+    float maxPixelError = { 1.0f };
+    // Share of maxPixelError a level has to stay under before a draw switches to it from a finer one, so draws near
+    // the threshold do not switch back and forth every frame.
+    float hysteresis    = { 0.25f };
+};
+
+struct OcclusionSettings
+{
+    bool     enabled              = { true };
+    uint32_t width                = { OcclusionCuller::DEFAULT_WIDTH };
+    uint32_t height               = { OcclusionCuller::DEFAULT_HEIGHT };
+    // Occluders are picked by loadResources() among the opaque indexed subsets of at most maxOccluderTriangles
+    // triangles, largest world bounds first. The first maxOccluders of them are rasterized.
+    uint32_t maxOccluders         = { 32 };
+    uint32_t maxOccluderTriangles = { 8192 };
+};
+
 class VulkanSceneRenderer final : public ISceneRenderer, public VulkanRenderer
 {
 public:
@@ -15,14 +50,42 @@ public:
 
     void loadResources() override;
     void cleanupResources() override;
-    void update(float deltaTime) override;
     void recordDrawSceneCommands() override;
     void recordDrawSceneCommands(VulkanCommandBuffer* pCommandBuffer);
     void recordPostFxCommands(VulkanCommandBuffer* pCommandBuffer);
     void setUIRenderer(const std::unique_ptr<VulkanUIRenderer>& renderer) { m_pUIRenderer = renderer.get(); }
 
+    // Per-frame stages, callable separately so a frame graph can run them concurrently.
+    // Each one writes its own buffer. cullDraws() reads the draw bounds and the camera, so it has to run after
+    // updateTransforms() and updateCameras(), and before recordDrawSceneCommands(). updateUI() reads camera, light and
+    // culling state and writes the ambient color, so it has to run after updateCameras(), updateLights() and
+    // cullDraws(). updateUIInput() polls the window and must stay on the main thread.
+    void updateTransforms();
+    void updateCameras(float deltaTime);
+    void updateLights();
+    void cullDraws();
+    void updateUIInput();
+    void updateUI(float deltaTime);
+
+    // Draws tested and kept by the last cullDraws().
+    const DrawStats& getDrawStats() const { return m_drawStats; }
+
+    void                     setOcclusionSettings(const OcclusionSettings& settings);
+    const OcclusionSettings& getOcclusionSettings() const { return m_occlusionSettings; }
+
+    void               setLodSettings(const LodSettings& settings) { m_lodSettings = settings; }
+    const LodSettings& getLodSettings() const { return m_lodSettings; }
+
 private:
-    void _updateUI(float deltaTime);
+    // Copies the world transforms of the whole scene tree into BUFFER_SCENE_TRANSFORM.
+    void     writeTransforms();
+    // Recomputes the world bounds of the draws of the mesh nodes that moved in the last transform update.
+    void     updateDrawBounds();
+    // Rasterizes the occluders and removes the draws they hide from m_visibleDraws, returns how many.
+    uint32_t cullOccludedDraws(const glm::mat4& viewProj);
+    // Picks the level of detail of every visible draw from its projected error, seen from eye through proj.
+    void     selectDrawLods(const glm::vec3& eye, const glm::mat4& proj);
+
     void _initSetLayout();
     void _initSet();
     void _initForward();
@@ -30,6 +93,8 @@ private:
     void _initPostFx();
     void _loadScene();
     void _initGpuResources();
+    void _initDraws();
+    void _initOccluders();
 
 private:
     enum SetLayoutIndex
@@ -102,8 +167,41 @@ private:
     std::vector<std::shared_ptr<SceneNode>> m_cameraNodeList;
     std::vector<std::shared_ptr<SceneNode>> m_lightNodeList;
 
+private:
+    // One per subset of every mesh node, the unit the forward pass culls and draws.
+    struct Draw
+    {
+        uint32_t meshNode = {};
+        uint32_t subset   = {};
+    };
+
+    // Indexed like the culler's boxes, the draws of a mesh node are contiguous and in subset order.
+    std::vector<Draw>     m_draws;
+    // Draws of mesh node i are [m_meshNodeDraws[i], m_meshNodeDraws[i + 1]).
+    std::vector<uint32_t> m_meshNodeDraws;
+    // Mesh node index per transform slot, UINT32_MAX for nodes without a mesh.
+    std::vector<uint32_t> m_slotMeshNodes;
+    FrustumCuller         m_culler;
+    // Draws to record this frame, ascending.
+    std::vector<uint32_t> m_visibleDraws;
+    std::vector<uint8_t>  m_drawOccluded;
+    DrawStats             m_drawStats;
+
+    OcclusionCuller       m_occlusionCuller;
+    OcclusionSettings     m_occlusionSettings;
+    // Draw of each occluder.
+    std::vector<uint32_t> m_occluderDraws;
+
+    LodSettings           m_lodSettings;
+    // Level of detail per draw, 0 is the subset itself, kept between frames for the hysteresis.
+    std::vector<uint8_t>  m_drawLods;
+
 private:
     VulkanUIRenderer* m_pUIRenderer = {};
+    // Kept between frames so updateUI() does not allocate once warmed up.
+    std::vector<std::string>   m_occlusionResolutionNames;
+    std::vector<ProfileZone>   m_profilerZones;
+    std::vector<ProfileThread> m_profilerThreads;
 };
 }  // namespace aph
 
@@ -306,6 +306,12 @@ void VulkanUIRenderer::text(const char* formatstr, ...)
     va_end(args);
 }
 
+void VulkanUIRenderer::plotHistogram(const char* caption, std::span<const float> values, float height)
+{
+    ImGui::PlotHistogram(caption, values.data(), static_cast<int>(values.size()), 0, nullptr, 0.0f, FLT_MAX,
+                         ImVec2(0.0f, height * m_scale));
+}
+
 bool VulkanUIRenderer::colorPicker(const char* caption, float* color)
 {
     bool res = ImGui::ColorEdit4(caption, color, ImGuiColorEditFlags_NoInputs);
@@ -324,20 +330,19 @@ bool VulkanUIRenderer::button(const char* caption)
     };
     return res;
 }
-bool VulkanUIRenderer::comboBox(const char* caption, int32_t* itemindex, std::vector<std::string> items)
+bool VulkanUIRenderer::comboBox(const char* caption, int32_t* itemindex, const std::vector<std::string>& items)
 {
     if(items.empty())
     {
         return false;
     }
-    std::vector<const char*> charitems;
-    charitems.reserve(items.size());
-    for(auto& item : items)
+    uint32_t     itemCount = static_cast<uint32_t>(items.size());
+    const char** charitems = m_pRenderer->getFrameAllocator()->allocate<const char*>(itemCount);
+    for(uint32_t idx = 0; idx < itemCount; idx++)
     {
-        charitems.push_back(item.c_str());
+        charitems[idx] = items[idx].c_str();
     }
-    uint32_t itemCount = static_cast<uint32_t>(charitems.size());
-    bool     res       = ImGui::Combo(caption, itemindex, &charitems[0], itemCount, itemCount);
+    bool res = ImGui::Combo(caption, itemindex, charitems, itemCount, itemCount);
     if(res)
     {
         updated = true;
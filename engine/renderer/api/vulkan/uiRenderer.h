@@ -37,10 +37,11 @@ public:
     bool inputFloat(const char* caption, float* value, float step, uint32_t precision);
     bool sliderFloat(const char* caption, float* value, float min, float max);
     bool sliderInt(const char* caption, int32_t* value, int32_t min, int32_t max);
-    bool comboBox(const char* caption, int32_t* itemindex, std::vector<std::string> items);
+    bool comboBox(const char* caption, int32_t* itemindex, const std::vector<std::string>& items);
     bool button(const char* caption);
     bool colorPicker(const char* caption, float* color);
     void text(const char* formatstr, ...);
+    void plotHistogram(const char* caption, std::span<const float> values, float height = 60.0f);
 
 private:
     struct PushConstBlock
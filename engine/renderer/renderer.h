@@ -16,6 +16,9 @@ struct RenderConfig
     bool             initDefaultResource = { true };
     uint32_t         maxFrames           = { 2 };
     SampleCountFlags sampleCount         = { SAMPLE_COUNT_1_BIT };
+    // Renders into offscreen images at the window size without a surface or presentation, the window may be
+    // headless as well. Runs on drivers without any window system, e.g. lavapipe.
+    bool             headless            = { false };
 };
 
 class VulkanSceneRenderer;
@@ -11,7 +11,6 @@ class ISceneRenderer
 {
 public:
     virtual void loadResources()           = 0;
-    virtual void update(float deltaTime)   = 0;
     virtual void recordDrawSceneCommands() = 0;
 
     virtual void cleanupResources() = 0;
@@ -0,0 +1,152 @@
+#ifndef BOUNDS_H_
+#define BOUNDS_H_
+
+#include "common/common.h"
+
+#include <limits>
+
+namespace aph
+{
+struct AABB
+{
+    // Empty: merging anything into it yields the other box.
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    bool      isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 getExtent() const { return (max - min) * 0.5f; }
+
+    float getSurfaceArea() const
+    {
+        if(!isValid())
+        {
+            return 0.0f;
+        }
+        glm::vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    void merge(glm::vec3 point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    void merge(const AABB& other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    bool contains(const AABB& other) const
+    {
+        return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+    }
+    bool overlaps(const AABB& other) const
+    {
+        return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+    }
+
+    // Bounds of the transformed box, from its transformed center and extent.
+    AABB transform(const glm::mat4& matrix) const
+    {
+        if(!isValid())
+        {
+            return {};
+        }
+        glm::vec3 center = matrix * glm::vec4(getCenter(), 1.0f);
+        glm::mat3 linear{ matrix };
+        glm::vec3 extent = glm::abs(linear[0]) * getExtent().x + glm::abs(linear[1]) * getExtent().y +
+                           glm::abs(linear[2]) * getExtent().z;
+        return { center - extent, center + extent };
+    }
+
+    static AABB Merge(AABB a, const AABB& b)
+    {
+        a.merge(b);
+        return a;
+    }
+};
+
+struct Sphere
+{
+    glm::vec3 center = {};
+    float     radius = {};
+
+    bool overlaps(const AABB& box) const
+    {
+        glm::vec3 offset = glm::clamp(center, box.min, box.max) - center;
+        return glm::dot(offset, offset) <= radius * radius;
+    }
+};
+
+struct Ray
+{
+    glm::vec3 origin    = {};
+    glm::vec3 direction = { 0.0f, 0.0f, 1.0f };
+
+    // Distance along the ray at which it enters the box, -1 if it misses it within maxDistance. Slab test, the ray
+    // starting inside counts as entering at 0.
+    float intersect(const AABB& box, float maxDistance) const
+    {
+        glm::vec3 inverse = 1.0f / direction;
+        glm::vec3 t0      = (box.min - origin) * inverse;
+        glm::vec3 t1      = (box.max - origin) * inverse;
+        glm::vec3 tNear   = glm::min(t0, t1);
+        glm::vec3 tFar    = glm::max(t0, t1);
+        float     enter   = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float     exit    = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+        return enter <= exit ? enter : -1.0f;
+    }
+};
+
+enum class Containment
+{
+    OUTSIDE,
+    INTERSECTS,
+    INSIDE,
+};
+
+struct Frustum
+{
+    // xyz the inward normal, w the distance: a point p is inside a plane if dot(xyz, p) + w >= 0.
+    std::array<glm::vec4, 6> planes = {};
+
+    // Planes of a view projection matrix with a [0, 1] depth range, see GLM_FORCE_DEPTH_ZERO_TO_ONE.
+    static Frustum FromMatrix(const glm::mat4& viewProj)
+    {
+        glm::mat4 m = glm::transpose(viewProj);
+        Frustum   frustum;
+        frustum.planes = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[2], m[3] - m[2] };
+        for(glm::vec4& plane : frustum.planes)
+        {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    Containment test(const AABB& box) const
+    {
+        glm::vec3   center = box.getCenter();
+        glm::vec3   extent = box.getExtent();
+        Containment result = Containment::INSIDE;
+        for(const glm::vec4& plane : planes)
+        {
+            glm::vec3 normal   = plane;
+            float     distance = glm::dot(normal, center) + plane.w;
+            float     radius   = glm::dot(glm::abs(normal), extent);
+            if(distance < -radius)
+            {
+                return Containment::OUTSIDE;
+            }
+            if(distance < radius)
+            {
+                result = Containment::INTERSECTS;
+            }
+        }
+        return result;
+    }
+};
+}  // namespace aph
+
+#endif  // BOUNDS_H_
@@ -0,0 +1,384 @@
+#include "bvh.h"
+
+#include "common/parallel.h"
+#include "common/profiler.h"
+
+namespace aph
+{
+namespace
+{
+constexpr uint32_t BIN_COUNT = 16;
+// Ranges of proxies a build pass bins serially, and below which a subtree is not worth a task.
+constexpr size_t   BUILD_GRAIN_SIZE     = 4 * 1024;
+constexpr size_t   PARALLEL_BUILD_COUNT = 2 * 1024;
+// Trees this small are rebuilt whenever they degrade at all, cheaper than tracking them.
+constexpr uint32_t MIN_REBUILD_COUNT = 8;
+
+struct RangeBounds
+{
+    AABB bounds    = {};
+    AABB centroids = {};
+};
+
+struct Bin
+{
+    AABB     bounds = {};
+    uint32_t count  = {};
+};
+using Bins = std::array<Bin, BIN_COUNT>;
+}  // namespace
+
+BVH::ProxyId BVH::createProxy(const AABB& bounds, Object* pObject)
+{
+    ProxyId proxy = m_freeProxy;
+    if(proxy == INVALID_INDEX)
+    {
+        proxy = m_proxies.size();
+        m_proxies.push_back({});
+    }
+    else
+    {
+        m_freeProxy = m_proxies[proxy].leaf;
+    }
+
+    uint32_t leaf        = allocateNode();
+    m_nodes[leaf].bounds = bounds;
+    m_nodes[leaf].proxy  = proxy;
+    m_proxies[proxy]     = { bounds, pObject, leaf, true };
+    ++m_proxyCount;
+    insertLeaf(leaf);
+    return proxy;
+}
+
+void BVH::destroyProxy(ProxyId proxy)
+{
+    uint32_t leaf = m_proxies[proxy].leaf;
+    removeLeaf(leaf);
+    freeNode(leaf);
+    // A pending refit of the leaf is dropped with it.
+    std::erase(m_movedLeaves, leaf);
+
+    m_proxies[proxy]      = {};
+    m_proxies[proxy].leaf = m_freeProxy;
+    m_freeProxy           = proxy;
+    --m_proxyCount;
+}
+
+void BVH::moveProxy(ProxyId proxy, const AABB& bounds)
+{
+    uint32_t leaf           = m_proxies[proxy].leaf;
+    m_proxies[proxy].bounds = bounds;
+    m_nodes[leaf].bounds    = bounds;
+    m_movedLeaves.push_back(leaf);
+}
+
+void BVH::refit()
+{
+    // Every walk stops at the first ancestor whose box stays the same, branches are only refit once per change.
+    for(uint32_t leaf : m_movedLeaves)
+    {
+        refitUpwards(m_nodes[leaf].parent);
+    }
+    m_movedLeaves.clear();
+
+    // Insertions degrade the tree as well, the first refit after a bulk insertion builds it properly.
+    float limit = m_proxyCount < MIN_REBUILD_COUNT ? m_builtCost : m_builtCost * REBUILD_COST_RATIO;
+    if(getCost() > limit)
+    {
+        rebuild();
+    }
+}
+
+void BVH::rebuild()
+{
+    APH_PROFILE_FUNCTION();
+    std::vector<ProxyId> proxies;
+    proxies.reserve(m_proxyCount);
+    for(ProxyId proxy = 0; proxy < m_proxies.size(); ++proxy)
+    {
+        if(m_proxies[proxy].alive)
+        {
+            proxies.push_back(proxy);
+        }
+    }
+
+    // A binary tree over n leaves has 2n - 1 nodes. Every subtree gets its range of them upfront, so the subtrees
+    // can be built concurrently without sharing an allocator.
+    m_nodes.assign(proxies.empty() ? 0 : 2 * proxies.size() - 1, Node{});
+    m_freeNodes.clear();
+    m_movedLeaves.clear();
+    m_root = proxies.empty() ? INVALID_INDEX : 0;
+    if(!proxies.empty())
+    {
+        buildRange(proxies, 0, INVALID_INDEX);
+    }
+
+    m_internalArea = 0.0;
+    for(const Node& node : m_nodes)
+    {
+        if(!node.isLeaf())
+        {
+            m_internalArea += node.bounds.getSurfaceArea();
+        }
+    }
+    m_builtCost = getCost();
+}
+
+float BVH::getCost() const
+{
+    float rootArea = getBounds().getSurfaceArea();
+    return rootArea > 0.0f ? static_cast<float>(m_internalArea / rootArea) : 0.0f;
+}
+
+uint32_t BVH::allocateNode()
+{
+    if(!m_freeNodes.empty())
+    {
+        uint32_t index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        m_nodes[index] = {};
+        return index;
+    }
+    m_nodes.push_back({});
+    return m_nodes.size() - 1;
+}
+
+void BVH::freeNode(uint32_t index)
+{
+    m_nodes[index] = {};
+    m_freeNodes.push_back(index);
+}
+
+void BVH::setBounds(uint32_t index, const AABB& bounds)
+{
+    Node& node = m_nodes[index];
+    if(!node.isLeaf())
+    {
+        m_internalArea += bounds.getSurfaceArea() - node.bounds.getSurfaceArea();
+    }
+    node.bounds = bounds;
+}
+
+void BVH::insertLeaf(uint32_t leaf)
+{
+    if(m_root == INVALID_INDEX)
+    {
+        m_root               = leaf;
+        m_nodes[leaf].parent = INVALID_INDEX;
+        return;
+    }
+
+    // Descends towards the sibling with the least area added to the tree, stops where pairing up with the current
+    // node is cheaper than going further down.
+    const AABB bounds = m_nodes[leaf].bounds;
+    uint32_t   index  = m_root;
+    while(!m_nodes[index].isLeaf())
+    {
+        const Node& node         = m_nodes[index];
+        float       area         = node.bounds.getSurfaceArea();
+        float       combinedArea = AABB::Merge(node.bounds, bounds).getSurfaceArea();
+        float       cost         = 2.0f * combinedArea;
+        float       inheritance  = 2.0f * (combinedArea - area);
+
+        auto childCost = [&](uint32_t child) {
+            const Node& childNode = m_nodes[child];
+            float       merged    = AABB::Merge(childNode.bounds, bounds).getSurfaceArea();
+            return (childNode.isLeaf() ? merged : merged - childNode.bounds.getSurfaceArea()) + inheritance;
+        };
+        float leftCost  = childCost(node.left);
+        float rightCost = childCost(node.right);
+        if(cost < leftCost && cost < rightCost)
+        {
+            break;
+        }
+        index = leftCost < rightCost ? node.left : node.right;
+    }
+
+    uint32_t sibling          = index;
+    uint32_t oldParent        = m_nodes[sibling].parent;
+    uint32_t newParent        = allocateNode();
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].left   = sibling;
+    m_nodes[newParent].right  = leaf;
+    setBounds(newParent, AABB::Merge(m_nodes[sibling].bounds, bounds));
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent    = newParent;
+
+    if(oldParent == INVALID_INDEX)
+    {
+        m_root = newParent;
+    }
+    else
+    {
+        (m_nodes[oldParent].left == sibling ? m_nodes[oldParent].left : m_nodes[oldParent].right) = newParent;
+        refitUpwards(oldParent);
+    }
+}
+
+void BVH::removeLeaf(uint32_t leaf)
+{
+    if(leaf == m_root)
+    {
+        m_root = INVALID_INDEX;
+        return;
+    }
+
+    uint32_t parent      = m_nodes[leaf].parent;
+    uint32_t grandParent = m_nodes[parent].parent;
+    uint32_t sibling     = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+    m_nodes[sibling].parent = grandParent;
+    setBounds(parent, {});
+    freeNode(parent);
+
+    if(grandParent == INVALID_INDEX)
+    {
+        m_root = sibling;
+    }
+    else
+    {
+        (m_nodes[grandParent].left == parent ? m_nodes[grandParent].left : m_nodes[grandParent].right) = sibling;
+        refitUpwards(grandParent);
+    }
+}
+
+void BVH::refitUpwards(uint32_t index)
+{
+    while(index != INVALID_INDEX)
+    {
+        const Node& node   = m_nodes[index];
+        AABB        bounds = AABB::Merge(m_nodes[node.left].bounds, m_nodes[node.right].bounds);
+        if(bounds.min == node.bounds.min && bounds.max == node.bounds.max)
+        {
+            break;
+        }
+        setBounds(index, bounds);
+        index = m_nodes[index].parent;
+    }
+}
+
+void BVH::buildRange(std::span<ProxyId> proxies, uint32_t index, uint32_t parent)
+{
+    Node& node  = m_nodes[index];
+    node.parent = parent;
+    if(proxies.size() == 1)
+    {
+        node.proxy                 = proxies[0];
+        node.bounds                = m_proxies[proxies[0]].bounds;
+        m_proxies[proxies[0]].leaf = index;
+        return;
+    }
+
+    RangeBounds range = parallelReduce(
+        0, proxies.size(), RangeBounds{},
+        [&](size_t begin, size_t end, RangeBounds partial) {
+            for(size_t idx = begin; idx < end; ++idx)
+            {
+                const AABB& bounds = m_proxies[proxies[idx]].bounds;
+                partial.bounds.merge(bounds);
+                partial.centroids.merge(bounds.getCenter());
+            }
+            return partial;
+        },
+        [](RangeBounds a, const RangeBounds& b) {
+            a.bounds.merge(b.bounds);
+            a.centroids.merge(b.centroids);
+            return a;
+        },
+        BUILD_GRAIN_SIZE);
+    node.bounds = range.bounds;
+
+    // Binned SAH along the axis the centroids spread the most on.
+    glm::vec3 extent = range.centroids.max - range.centroids.min;
+    int       axis   = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    float     scale  = extent[axis] > 0.0f ? BIN_COUNT / extent[axis] : 0.0f;
+    auto      getBin = [&](ProxyId proxy) {
+        float offset = m_proxies[proxy].bounds.getCenter()[axis] - range.centroids.min[axis];
+        return std::min(static_cast<uint32_t>(offset * scale), BIN_COUNT - 1);
+    };
+
+    size_t middle = proxies.size() / 2;
+    if(scale > 0.0f)
+    {
+        Bins bins = parallelReduce(
+            0, proxies.size(), Bins{},
+            [&](size_t begin, size_t end, Bins partial) {
+                for(size_t idx = begin; idx < end; ++idx)
+                {
+                    Bin& bin = partial[getBin(proxies[idx])];
+                    bin.bounds.merge(m_proxies[proxies[idx]].bounds);
+                    ++bin.count;
+                }
+                return partial;
+            },
+            [](Bins a, const Bins& b) {
+                for(uint32_t bin = 0; bin < BIN_COUNT; ++bin)
+                {
+                    a[bin].bounds.merge(b[bin].bounds);
+                    a[bin].count += b[bin].count;
+                }
+                return a;
+            },
+            BUILD_GRAIN_SIZE);
+
+        // Cost of splitting after every bin, the right side swept from the back.
+        std::array<float, BIN_COUNT - 1> rightCosts{};
+        AABB                             rightBounds;
+        uint32_t                         rightCount = 0;
+        for(uint32_t bin = BIN_COUNT - 1; bin > 0; --bin)
+        {
+            rightBounds.merge(bins[bin].bounds);
+            rightCount += bins[bin].count;
+            rightCosts[bin - 1] = rightBounds.getSurfaceArea() * rightCount;
+        }
+
+        AABB     leftBounds;
+        uint32_t leftCount = 0;
+        float    bestCost  = std::numeric_limits<float>::max();
+        uint32_t bestSplit = 0;
+        for(uint32_t bin = 0; bin + 1 < BIN_COUNT; ++bin)
+        {
+            leftBounds.merge(bins[bin].bounds);
+            leftCount += bins[bin].count;
+            float cost = leftBounds.getSurfaceArea() * leftCount + rightCosts[bin];
+            if(leftCount > 0 && leftCount < proxies.size() && cost < bestCost)
+            {
+                bestCost  = cost;
+                bestSplit = bin;
+            }
+        }
+
+        if(bestCost < std::numeric_limits<float>::max())
+        {
+            auto split = std::partition(proxies.begin(), proxies.end(),
+                                        [&](ProxyId proxy) { return getBin(proxy) <= bestSplit; });
+            middle     = split - proxies.begin();
+        }
+    }
+    if(middle == 0 || middle == proxies.size() || scale == 0.0f)
+    {
+        // Every centroid in one bin: any split is as good as the other.
+        middle = proxies.size() / 2;
+    }
+
+    std::span<ProxyId> leftProxies  = proxies.subspan(0, middle);
+    std::span<ProxyId> rightProxies = proxies.subspan(middle);
+    uint32_t           leftIndex    = index + 1;
+    uint32_t           rightIndex   = index + 2 * static_cast<uint32_t>(middle);
+    node.left                       = leftIndex;
+    node.right                      = rightIndex;
+
+    ThreadPool* pPool = ThreadPool::GetDefault();
+    if(pPool && pPool->GetThreadCount() > 0 && proxies.size() > PARALLEL_BUILD_COUNT)
+    {
+        WaitGroup group;
+        pPool->AddTask([this, leftProxies, leftIndex, index]() { buildRange(leftProxies, leftIndex, index); }, &group);
+        buildRange(rightProxies, rightIndex, index);
+        pPool->Wait(group);
+    }
+    else
+    {
+        buildRange(leftProxies, leftIndex, index);
+        buildRange(rightProxies, rightIndex, index);
+    }
+}
+}  // namespace aph
@@ -0,0 +1,198 @@
+#ifndef BVH_H_
+#define BVH_H_
+
+#include "scene/bounds.h"
+
+namespace aph
+{
+class Object;
+
+// Dynamic bounding volume hierarchy over object bounds, one leaf per proxy.
+// Proxies are inserted and removed incrementally. Moving one only stores its new bounds, refit() then grows or
+// shrinks the boxes above the moved leaves, so the topology is kept however far objects travel. The SAH cost of the
+// tree is tracked as it changes, once it has degraded too far from the last build refit() rebuilds the tree top-down
+// with a binned SAH, multithreaded. Not thread safe, queries must not race with any modification.
+class BVH
+{
+public:
+    using ProxyId                           = uint32_t;
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+    // Rebuilds once the cost exceeds the cost after the last build by this factor.
+    static constexpr float    REBUILD_COST_RATIO = 1.5f;
+
+    ProxyId createProxy(const AABB& bounds, Object* pObject);
+    void    destroyProxy(ProxyId proxy);
+    // Takes effect in queries after the next refit().
+    void    moveProxy(ProxyId proxy, const AABB& bounds);
+
+    // Once per frame, after moving proxies.
+    void refit();
+    void rebuild();
+
+    AABB        getBounds() const { return m_root == INVALID_INDEX ? AABB{} : m_nodes[m_root].bounds; }
+    const AABB& getProxyBounds(ProxyId proxy) const { return m_proxies[proxy].bounds; }
+    Object*     getObject(ProxyId proxy) const { return m_proxies[proxy].pObject; }
+    uint32_t    getProxyCount() const { return m_proxyCount; }
+    // Surface area of all internal nodes relative to the root's, the expected number of internal nodes a random ray
+    // through the scene bounds visits.
+    float       getCost() const;
+
+    // callback(Object*) for every proxy whose bounds overlap the box.
+    template <typename F>
+    void queryAABB(const AABB& box, F&& callback) const
+    {
+        traverse(
+            [&box](const AABB& bounds) {
+                return box.contains(bounds) ? Containment::INSIDE :
+                       box.overlaps(bounds) ? Containment::INTERSECTS :
+                                              Containment::OUTSIDE;
+            },
+            callback);
+    }
+
+    // callback(Object*) for every proxy whose bounds overlap the sphere.
+    template <typename F>
+    void querySphere(const Sphere& sphere, F&& callback) const
+    {
+        traverse(
+            [&sphere](const AABB& bounds) {
+                return sphere.overlaps(bounds) ? Containment::INTERSECTS : Containment::OUTSIDE;
+            },
+            callback);
+    }
+
+    // callback(Object*) for every proxy whose bounds are not entirely outside the frustum. Subtrees inside the frustum
+    // are reported without testing their leaves.
+    template <typename F>
+    void queryFrustum(const Frustum& frustum, F&& callback) const
+    {
+        traverse([&frustum](const AABB& bounds) { return frustum.test(bounds); }, callback);
+    }
+
+    // callback(Object*, distance) for every proxy whose bounds the ray enters within maxDistance, nearer subtrees
+    // first. The callback returns the new maximum distance: the distance of a hit to only look for closer ones from
+    // then on, 0 to stop, maxDistance to go on.
+    template <typename F>
+    void raycast(const Ray& ray, float maxDistance, F&& callback) const
+    {
+        if(m_root == INVALID_INDEX || ray.intersect(m_nodes[m_root].bounds, maxDistance) < 0.0f)
+        {
+            return;
+        }
+        std::vector<uint32_t> stack{ m_root };
+        while(!stack.empty())
+        {
+            const Node& node = m_nodes[stack.back()];
+            stack.pop_back();
+            if(node.isLeaf())
+            {
+                float distance = ray.intersect(node.bounds, maxDistance);
+                if(distance >= 0.0f)
+                {
+                    maxDistance = callback(m_proxies[node.proxy].pObject, distance);
+                    if(maxDistance <= 0.0f)
+                    {
+                        return;
+                    }
+                }
+                continue;
+            }
+
+            float left  = ray.intersect(m_nodes[node.left].bounds, maxDistance);
+            float right = ray.intersect(m_nodes[node.right].bounds, maxDistance);
+            // The nearer child goes on top.
+            uint32_t nearChild = node.left, farChild = node.right;
+            if(right >= 0.0f && (left < 0.0f || right < left))
+            {
+                std::swap(nearChild, farChild);
+                std::swap(left, right);
+            }
+            if(right >= 0.0f)
+            {
+                stack.push_back(farChild);
+            }
+            if(left >= 0.0f)
+            {
+                stack.push_back(nearChild);
+            }
+        }
+    }
+
+private:
+    struct Node
+    {
+        AABB     bounds = {};
+        uint32_t parent = INVALID_INDEX;
+        // Both INVALID_INDEX for a leaf.
+        uint32_t left   = INVALID_INDEX;
+        uint32_t right  = INVALID_INDEX;
+        ProxyId  proxy  = INVALID_INDEX;
+
+        bool isLeaf() const { return left == INVALID_INDEX; }
+    };
+
+    struct Proxy
+    {
+        AABB     bounds  = {};
+        Object*  pObject = {};
+        // Doubles as the free list link while the proxy is unused.
+        uint32_t leaf    = INVALID_INDEX;
+        bool     alive   = {};
+    };
+
+    // test(bounds) classifies a subtree, everything below an INSIDE one is reported untested.
+    template <typename FTest, typename FVisit>
+    void traverse(FTest&& test, FVisit&& visit) const
+    {
+        if(m_root == INVALID_INDEX)
+        {
+            return;
+        }
+        std::vector<std::pair<uint32_t, bool>> stack{ { m_root, false } };
+        while(!stack.empty())
+        {
+            auto [index, inside] = stack.back();
+            stack.pop_back();
+            const Node& node = m_nodes[index];
+            if(!inside)
+            {
+                Containment containment = test(node.bounds);
+                if(containment == Containment::OUTSIDE)
+                {
+                    continue;
+                }
+                inside = containment == Containment::INSIDE;
+            }
+            if(node.isLeaf())
+            {
+                visit(m_proxies[node.proxy].pObject);
+                continue;
+            }
+            stack.push_back({ node.right, inside });
+            stack.push_back({ node.left, inside });
+        }
+    }
+
+    uint32_t allocateNode();
+    void     freeNode(uint32_t index);
+    void     setBounds(uint32_t index, const AABB& bounds);
+    void     insertLeaf(uint32_t leaf);
+    void     removeLeaf(uint32_t leaf);
+    void     refitUpwards(uint32_t index);
+    void     buildRange(std::span<ProxyId> proxies, uint32_t index, uint32_t parent);
+
+    std::vector<Node>     m_nodes;
+    std::vector<uint32_t> m_freeNodes;
+    std::vector<Proxy>    m_proxies;
+    uint32_t              m_freeProxy  = INVALID_INDEX;
+    uint32_t              m_proxyCount = {};
+    uint32_t              m_root       = INVALID_INDEX;
+    std::vector<uint32_t> m_movedLeaves;
+
+    // Sum of the surface areas of the internal nodes, kept up to date by setBounds().
+    double m_internalArea = {};
+    float  m_builtCost    = {};
+};
+}  // namespace aph
+
+#endif  // BVH_H_
@@ -0,0 +1,204 @@
+#include "culling.h"
+
+#include "common/parallel.h"
+
+#include <bit>
+
+namespace aph
+{
+// Batches per parallel chunk, 512 boxes.
+constexpr size_t CULL_GRAIN_SIZE = 64;
+
+namespace
+{
+// Extent stored for invalid boxes, the radius against any plane is then so negative that the box is always outside.
+constexpr float INVALID_EXTENT = -std::numeric_limits<float>::max();
+
+#if defined(__AVX__)
+struct PlaneLanes
+{
+    __m256 x, y, z, w;
+    __m256 absX, absY, absZ;
+};
+
+// A box is outside a plane when the distance of its center is below minus its projected radius, it is visible when
+// it is outside none of them.
+inline uint32_t testBatch(const std::array<PlaneLanes, 6>& planes, const float* pCenterX, const float* pCenterY,
+                          const float* pCenterZ, const float* pExtentX, const float* pExtentY, const float* pExtentZ)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 cx       = _mm256_loadu_ps(pCenterX);
+    const __m256 cy       = _mm256_loadu_ps(pCenterY);
+    const __m256 cz       = _mm256_loadu_ps(pCenterZ);
+    const __m256 ex       = _mm256_loadu_ps(pExtentX);
+    const __m256 ey       = _mm256_loadu_ps(pExtentY);
+    const __m256 ez       = _mm256_loadu_ps(pExtentZ);
+    __m256       outside  = _mm256_setzero_ps();
+    for(const PlaneLanes& plane : planes)
+    {
+        __m256 distance = _mm256_add_ps(_mm256_mul_ps(plane.x, cx), _mm256_mul_ps(plane.y, cy));
+        distance        = _mm256_add_ps(_mm256_add_ps(distance, _mm256_mul_ps(plane.z, cz)), plane.w);
+        __m256 radius   = _mm256_add_ps(_mm256_mul_ps(plane.absX, ex), _mm256_mul_ps(plane.absY, ey));
+        radius          = _mm256_add_ps(radius, _mm256_mul_ps(plane.absZ, ez));
+        outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_xor_ps(radius, signMask), _CMP_LT_OQ));
+    }
+    return ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFFu;
+}
+#elif defined(__SSE__) || defined(_M_X64)
+struct PlaneLanes
+{
+    __m128 x, y, z, w;
+    __m128 absX, absY, absZ;
+};
+
+// Four boxes of the batch, see the AVX version.
+inline uint32_t testHalf(const std::array<PlaneLanes, 6>& planes, const float* pCenterX, const float* pCenterY,
+                         const float* pCenterZ, const float* pExtentX, const float* pExtentY, const float* pExtentZ)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 cx       = _mm_loadu_ps(pCenterX);
+    const __m128 cy       = _mm_loadu_ps(pCenterY);
+    const __m128 cz       = _mm_loadu_ps(pCenterZ);
+    const __m128 ex       = _mm_loadu_ps(pExtentX);
+    const __m128 ey       = _mm_loadu_ps(pExtentY);
+    const __m128 ez       = _mm_loadu_ps(pExtentZ);
+    __m128       outside  = _mm_setzero_ps();
+    for(const PlaneLanes& plane : planes)
+    {
+        __m128 distance = _mm_add_ps(_mm_mul_ps(plane.x, cx), _mm_mul_ps(plane.y, cy));
+        distance        = _mm_add_ps(_mm_add_ps(distance, _mm_mul_ps(plane.z, cz)), plane.w);
+        __m128 radius   = _mm_add_ps(_mm_mul_ps(plane.absX, ex), _mm_mul_ps(plane.absY, ey));
+        radius          = _mm_add_ps(radius, _mm_mul_ps(plane.absZ, ez));
+        outside         = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_xor_ps(radius, signMask)));
+    }
+    return ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xFu;
+}
+
+inline uint32_t testBatch(const std::array<PlaneLanes, 6>& planes, const float* pCenterX, const float* pCenterY,
+                          const float* pCenterZ, const float* pExtentX, const float* pExtentY, const float* pExtentZ)
+{
+    return testHalf(planes, pCenterX, pCenterY, pCenterZ, pExtentX, pExtentY, pExtentZ) |
+           testHalf(planes, pCenterX + 4, pCenterY + 4, pCenterZ + 4, pExtentX + 4, pExtentY + 4, pExtentZ + 4) << 4;
+}
+#endif
+}  // namespace
+
+uint32_t FrustumCuller::add(const AABB& bounds)
+{
+    if(m_count % BATCH_SIZE == 0)
+    {
+        size_t size = m_centerX.size() + BATCH_SIZE;
+        for(auto* pCenter : { &m_centerX, &m_centerY, &m_centerZ })
+        {
+            pCenter->resize(size, 0.0f);
+        }
+        for(auto* pExtent : { &m_extentX, &m_extentY, &m_extentZ })
+        {
+            pExtent->resize(size, INVALID_EXTENT);
+        }
+        m_masks.push_back(0);
+    }
+    set(m_count, bounds);
+    return m_count++;
+}
+
+void FrustumCuller::set(uint32_t index, const AABB& bounds)
+{
+    glm::vec3 center = bounds.isValid() ? bounds.getCenter() : glm::vec3(0.0f);
+    glm::vec3 extent = bounds.isValid() ? bounds.getExtent() : glm::vec3(INVALID_EXTENT);
+    m_centerX[index] = center.x;
+    m_centerY[index] = center.y;
+    m_centerZ[index] = center.z;
+    m_extentX[index] = extent.x;
+    m_extentY[index] = extent.y;
+    m_extentZ[index] = extent.z;
+}
+
+AABB FrustumCuller::getBounds(uint32_t index) const
+{
+    if(m_extentX[index] < 0.0f)
+    {
+        return {};
+    }
+    glm::vec3 center{ m_centerX[index], m_centerY[index], m_centerZ[index] };
+    glm::vec3 extent{ m_extentX[index], m_extentY[index], m_extentZ[index] };
+    return { center - extent, center + extent };
+}
+
+void FrustumCuller::clear()
+{
+    for(auto* pArray : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ })
+    {
+        pArray->clear();
+    }
+    m_masks.clear();
+    m_visible.clear();
+    m_count = 0;
+}
+
+std::span<const uint32_t> FrustumCuller::cull(const Frustum& frustum)
+{
+    parallelForRange(
+        0, m_masks.size(),
+        [this, &frustum](size_t batchBegin, size_t batchEnd) { cullBatches(frustum, batchBegin, batchEnd); },
+        CULL_GRAIN_SIZE);
+
+    m_visible.clear();
+    m_visible.reserve(m_count);
+    for(uint32_t batch = 0; batch < m_masks.size(); ++batch)
+    {
+        for(uint32_t mask = m_masks[batch]; mask != 0; mask &= mask - 1)
+        {
+            m_visible.push_back(batch * BATCH_SIZE + std::countr_zero(mask));
+        }
+    }
+    return m_visible;
+}
+
+void FrustumCuller::cullBatches(const Frustum& frustum, size_t batchBegin, size_t batchEnd)
+{
+#if defined(__AVX__) || defined(__SSE__) || defined(_M_X64)
+    std::array<PlaneLanes, 6> planes;
+    for(uint32_t idx = 0; idx < planes.size(); ++idx)
+    {
+        const glm::vec4& plane = frustum.planes[idx];
+#    if defined(__AVX__)
+        planes[idx] = { _mm256_set1_ps(plane.x),           _mm256_set1_ps(plane.y),
+                        _mm256_set1_ps(plane.z),           _mm256_set1_ps(plane.w),
+                        _mm256_set1_ps(std::abs(plane.x)), _mm256_set1_ps(std::abs(plane.y)),
+                        _mm256_set1_ps(std::abs(plane.z)) };
+#    else
+        planes[idx] = { _mm_set1_ps(plane.x),           _mm_set1_ps(plane.y),           _mm_set1_ps(plane.z),
+                        _mm_set1_ps(plane.w),           _mm_set1_ps(std::abs(plane.x)), _mm_set1_ps(std::abs(plane.y)),
+                        _mm_set1_ps(std::abs(plane.z)) };
+#    endif
+    }
+    for(size_t batch = batchBegin; batch < batchEnd; ++batch)
+    {
+        size_t offset  = batch * BATCH_SIZE;
+        m_masks[batch] = testBatch(planes, &m_centerX[offset], &m_centerY[offset], &m_centerZ[offset],
+                                   &m_extentX[offset], &m_extentY[offset], &m_extentZ[offset]);
+    }
+#else
+    for(size_t batch = batchBegin; batch < batchEnd; ++batch)
+    {
+        uint32_t mask = 0;
+        for(uint32_t lane = 0; lane < BATCH_SIZE; ++lane)
+        {
+            size_t    index  = batch * BATCH_SIZE + lane;
+            glm::vec3 center = { m_centerX[index], m_centerY[index], m_centerZ[index] };
+            glm::vec3 extent = { m_extentX[index], m_extentY[index], m_extentZ[index] };
+            bool      inside = true;
+            for(const glm::vec4& plane : frustum.planes)
+            {
+                float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+                float radius   = glm::dot(glm::abs(glm::vec3(plane)), extent);
+                inside         = inside && distance >= -radius;
+            }
+            mask |= uint32_t(inside) << lane;
+        }
+        m_masks[batch] = mask;
+    }
+#endif
+}
+}  // namespace aph
@@ -0,0 +1,41 @@
+#ifndef CULLING_H_
+#define CULLING_H_
+
+#include "scene/bounds.h"
+
+namespace aph
+{
+// World-space boxes kept as structure-of-arrays centers and extents, tested against the six planes of a frustum eight
+// boxes per iteration: one AVX pass when the build enables it (APH_ENABLE_AVX2), two SSE halves otherwise.
+// Batches are split across the thread pool, cull() then compacts the survivors into an ascending index list.
+// Invalid boxes are never visible. Not thread safe, boxes must not change while culling.
+class FrustumCuller
+{
+public:
+    static constexpr uint32_t BATCH_SIZE = 8;
+
+    // Returns the index of the new box, indices stay stable until clear().
+    uint32_t add(const AABB& bounds);
+    void     set(uint32_t index, const AABB& bounds);
+    AABB     getBounds(uint32_t index) const;
+    void     clear();
+    uint32_t getCount() const { return m_count; }
+
+    // Indices of the boxes not entirely outside the frustum, ascending. Valid until the next cull() or clear().
+    std::span<const uint32_t> cull(const Frustum& frustum);
+    std::span<const uint32_t> getVisible() const { return m_visible; }
+
+private:
+    void cullBatches(const Frustum& frustum, size_t batchBegin, size_t batchEnd);
+
+    // Padded to a multiple of BATCH_SIZE with invalid boxes.
+    std::vector<float>    m_centerX, m_centerY, m_centerZ;
+    std::vector<float>    m_extentX, m_extentY, m_extentZ;
+    // One bit per box of a batch, set when it is visible.
+    std::vector<uint8_t>  m_masks;
+    std::vector<uint32_t> m_visible;
+    uint32_t              m_count = {};
+};
+}  // namespace aph
+
+#endif  // CULLING_H_
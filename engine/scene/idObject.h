@@ -6,16 +6,18 @@
 namespace aph
 {
 
-typedef uint32_t IdType;
+// Wide enough for a packed SlotMap handle, see Scene.
+typedef uint64_t IdType;
 
 class Id
 {
 public:
+    // Unique per type, safe to call from any thread.
     template <typename T>
     static IdType generateNewId()
     {
-        static IdType g_currentId = 0;
-        return g_currentId++;
+        static std::atomic<IdType> g_currentId = 0;
+        return g_currentId.fetch_add(1, std::memory_order_relaxed);
     }
 };
 
@@ -2,6 +2,7 @@
 #define MESH_H_
 
 #include "object.h"
+#include "bounds.h"
 
 namespace aph
 {
@@ -55,11 +56,25 @@ enum class PrimitiveTopology
 {
     TRI_LIST,
     TRI_STRIP,
+    TRI_FAN,
+    POINT_LIST,
+    LINE_LIST,
+    LINE_LOOP,
+    LINE_STRIP,
 };
 
 struct Mesh : public Object
 {
     Mesh() : Object(Id::generateNewId<Mesh>(), ObjectType::MESH) {}
+    // A coarser version of a subset, its indices follow those of the subsets in the mesh's index range.
+    struct Lod
+    {
+        ResourceIndex firstIndex{ -1 };
+        ResourceIndex indexCount{ -1 };
+        // Sum of the positional errors simplifyMesh() reported for this level and the finer ones, in local space. An
+        // estimate of the distance of the simplified surface from the subset's, not a bound.
+        float error{};
+    };
     struct Subset
     {
         ResourceIndex firstIndex{ -1 };
@@ -68,12 +83,23 @@ struct Mesh : public Object
         ResourceIndex indexCount = { -1 };
         ResourceIndex materialIndex{ -1 };
         bool hasIndices{ false };
+        PrimitiveTopology topology{ PrimitiveTopology::TRI_LIST };
+        AABB bounds{};
+        // Increasingly coarse, the subset itself is level 0.
+        std::vector<Lod> lods{};
+
+        // Only whole triangle lists are simplified, reordered and drawn.
+        bool isTriangleList() const
+        {
+            return topology == PrimitiveTopology::TRI_LIST && indexCount > 0 && indexCount % 3 == 0;
+        }
     };
     ResourceIndex m_indexOffset{ -1 };
     ResourceIndex m_vertexOffset{ -1 };
     std::vector<Subset> m_subsets{};
+    // Local space, of all subsets.
+    AABB m_bounds{};
     IndexType m_indexType{ IndexType::UINT32 };
-    PrimitiveTopology m_topology{ PrimitiveTopology::TRI_LIST };
 };
 }  // namespace aph
 
@@ -0,0 +1,339 @@
+#include "meshOptimizer.h"
+#include "common/profiler.h"
+
+#include <numeric>
+#include <unordered_set>
+
+namespace aph
+{
+namespace
+{
+// FIFO cache over the insertion time of every vertex: a vertex stays cached until cacheSize others were inserted
+// after it.
+class FifoCache
+{
+public:
+    FifoCache(size_t vertexCount, uint32_t cacheSize) :
+        m_insertTimes(vertexCount, 0),
+        m_time(cacheSize + 1),
+        m_cacheSize(cacheSize)
+    {
+    }
+
+    // Inserts the vertex if it is not cached, returns whether it had to.
+    bool access(uint32_t vertex)
+    {
+        if(getAge(vertex) <= m_cacheSize)
+        {
+            return false;
+        }
+        m_insertTimes[vertex] = m_time++;
+        return true;
+    }
+    // Insertions since the vertex entered the cache, above the cache size once it left.
+    uint32_t getAge(uint32_t vertex) const { return m_time - m_insertTimes[vertex]; }
+    // Evicts everything.
+    void     flush() { m_time += m_cacheSize; }
+
+private:
+    std::vector<uint32_t> m_insertTimes;
+    uint32_t              m_time;
+    uint32_t              m_cacheSize;
+};
+
+size_t getVertexCount(std::span<const uint32_t> indices)
+{
+    return indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end()) + size_t(1);
+}
+}  // namespace
+
+VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, uint32_t cacheSize)
+{
+    size_t               vertexCount = getVertexCount(indices);
+    FifoCache            cache(vertexCount, cacheSize);
+    std::vector<uint8_t> used(vertexCount);
+    VertexCacheStats     stats{ .triangles = indices.size() / 3 };
+    for(uint32_t index : indices)
+    {
+        stats.transformed += cache.access(index);
+        stats.vertices += !used[index];
+        used[index] = true;
+    }
+    return stats;
+}
+
+size_t generateWeldRemap(std::span<const Vertex> vertices, std::vector<uint32_t>& remap)
+{
+    struct VertexHash
+    {
+        std::span<const Vertex> vertices;
+        size_t                  operator()(uint32_t vertex) const
+        {
+            return std::hash<std::string_view>{}(
+                { reinterpret_cast<const char*>(&vertices[vertex]), sizeof(Vertex) });
+        }
+    };
+    struct VertexEqual
+    {
+        std::span<const Vertex> vertices;
+        bool                    operator()(uint32_t a, uint32_t b) const
+        {
+            return memcmp(&vertices[a], &vertices[b], sizeof(Vertex)) == 0;
+        }
+    };
+
+    remap.resize(vertices.size());
+    std::unordered_set<uint32_t, VertexHash, VertexEqual> unique(vertices.size(), VertexHash{ vertices },
+                                                                 VertexEqual{ vertices });
+    size_t count = 0;
+    for(uint32_t vertex = 0; vertex < vertices.size(); ++vertex)
+    {
+        auto [it, inserted] = unique.insert(vertex);
+        remap[vertex]       = inserted ? count++ : remap[*it];
+    }
+    return count;
+}
+
+size_t generateFetchRemap(std::span<const uint32_t> indices, size_t vertexCount, std::vector<uint32_t>& remap)
+{
+    remap.assign(vertexCount, UINT32_MAX);
+    size_t count = 0;
+    for(uint32_t index : indices)
+    {
+        if(remap[index] == UINT32_MAX)
+        {
+            remap[index] = count++;
+        }
+    }
+    return count;
+}
+
+void remapMesh(std::vector<Vertex>& vertices, std::span<uint32_t> indices, std::span<const uint32_t> remap,
+               size_t remappedCount)
+{
+    std::vector<Vertex> remapped(remappedCount);
+    for(size_t vertex = 0; vertex < vertices.size(); ++vertex)
+    {
+        if(remap[vertex] != UINT32_MAX)
+        {
+            remapped[remap[vertex]] = vertices[vertex];
+        }
+    }
+    vertices = std::move(remapped);
+    for(uint32_t& index : indices)
+    {
+        index = remap[index];
+    }
+}
+
+void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize)
+{
+    APH_PROFILE_FUNCTION();
+    if(indices.size() % 3 != 0)
+    {
+        return;
+    }
+
+    // Triangles around every vertex, and how many of them are still to be emitted.
+    std::vector<uint32_t> liveCounts(vertexCount);
+    for(uint32_t index : indices)
+    {
+        ++liveCounts[index];
+    }
+    std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+    std::partial_sum(liveCounts.begin(), liveCounts.end(), triangleOffsets.begin() + 1);
+    std::vector<uint32_t> vertexTriangles(indices.size());
+    {
+        std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+        for(size_t idx = 0; idx < indices.size(); ++idx)
+        {
+            vertexTriangles[cursor[indices[idx]]++] = idx / 3;
+        }
+    }
+
+    FifoCache             cache(vertexCount, cacheSize);
+    std::vector<uint8_t>  emitted(indices.size() / 3);
+    std::vector<uint32_t> result;
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    result.reserve(indices.size());
+    deadEnds.reserve(indices.size());
+
+    uint32_t scan   = 0;
+    uint32_t vertex = 0;
+    while(vertex < vertexCount && liveCounts[vertex] == 0)
+    {
+        ++vertex;
+    }
+    while(vertex < vertexCount)
+    {
+        candidates.clear();
+        for(uint32_t offset = triangleOffsets[vertex]; offset < triangleOffsets[vertex + 1]; ++offset)
+        {
+            uint32_t triangle = vertexTriangles[offset];
+            if(emitted[triangle])
+            {
+                continue;
+            }
+            emitted[triangle] = true;
+            for(uint32_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t index = indices[triangle * 3 + corner];
+                result.push_back(index);
+                deadEnds.push_back(index);
+                candidates.push_back(index);
+                --liveCounts[index];
+                cache.access(index);
+            }
+        }
+
+        // Among the neighbors that still have triangles, the oldest one that stays cached while its remaining fans
+        // are emitted, else any of them.
+        uint32_t next         = UINT32_MAX;
+        int64_t  bestPriority = -1;
+        for(uint32_t candidate : candidates)
+        {
+            if(liveCounts[candidate] == 0)
+            {
+                continue;
+            }
+            int64_t priority = 0;
+            if(cache.getAge(candidate) + 2 * liveCounts[candidate] <= cacheSize)
+            {
+                priority = cache.getAge(candidate);
+            }
+            if(priority > bestPriority)
+            {
+                bestPriority = priority;
+                next         = candidate;
+            }
+        }
+        // Dead end: the most recently emitted vertex with triangles left, else the next one in index order.
+        while(next == UINT32_MAX && !deadEnds.empty())
+        {
+            uint32_t candidate = deadEnds.back();
+            deadEnds.pop_back();
+            if(liveCounts[candidate] > 0)
+            {
+                next = candidate;
+            }
+        }
+        if(next == UINT32_MAX)
+        {
+            while(scan < vertexCount && liveCounts[scan] == 0)
+            {
+                ++scan;
+            }
+            next = scan < vertexCount ? scan : UINT32_MAX;
+        }
+        vertex = next;
+    }
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void optimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, float threshold,
+                      uint32_t cacheSize)
+{
+    APH_PROFILE_FUNCTION();
+    size_t triangleCount = indices.size() / 3;
+    if(triangleCount < 2 || indices.size() % 3 != 0)
+    {
+        return;
+    }
+
+    // Hard boundaries where all three vertices of a triangle miss, the cache optimizer jumped there.
+    FifoCache             cache(getVertexCount(indices), cacheSize);
+    std::vector<uint32_t> hardStarts;
+    std::vector<uint32_t> misses(triangleCount);
+    for(uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        for(uint32_t corner = 0; corner < 3; ++corner)
+        {
+            misses[triangle] += cache.access(indices[triangle * 3 + corner]);
+        }
+        if(triangle == 0 || misses[triangle] == 3)
+        {
+            hardStarts.push_back(triangle);
+        }
+    }
+    hardStarts.push_back(triangleCount);
+
+    // Soft boundaries: a cluster closes once its miss ratio, starting from an empty cache, is close to the one of
+    // its hard cluster, where the next triangle mostly misses anyway so moving it costs little.
+    std::vector<uint32_t> clusterStarts;
+    for(size_t hard = 0; hard + 1 < hardStarts.size(); ++hard)
+    {
+        uint32_t begin = hardStarts[hard], end = hardStarts[hard + 1];
+        uint32_t hardMisses = std::accumulate(misses.begin() + begin, misses.begin() + end, 0u);
+        float    limit      = threshold * hardMisses / (end - begin);
+
+        clusterStarts.push_back(begin);
+        cache.flush();
+        uint32_t clusterBegin = begin, clusterMisses = 0;
+        for(uint32_t triangle = begin; triangle + 1 < end; ++triangle)
+        {
+            for(uint32_t corner = 0; corner < 3; ++corner)
+            {
+                clusterMisses += cache.access(indices[triangle * 3 + corner]);
+            }
+            if(clusterMisses <= limit * (triangle - clusterBegin + 1) && misses[triangle + 1] >= 2)
+            {
+                clusterBegin  = triangle + 1;
+                clusterMisses = 0;
+                clusterStarts.push_back(clusterBegin);
+                cache.flush();
+            }
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // Area weighted centroid and normal of every cluster.
+    size_t                 clusterCount = clusterStarts.size() - 1;
+    std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+    std::vector<float>     areas(clusterCount, 0.0f);
+    glm::vec3              meshCentroid(0.0f);
+    float                  meshArea = 0.0f;
+    for(size_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        for(uint32_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle)
+        {
+            const glm::vec3& p0     = vertices[indices[triangle * 3]].pos;
+            const glm::vec3& p1     = vertices[indices[triangle * 3 + 1]].pos;
+            const glm::vec3& p2     = vertices[indices[triangle * 3 + 2]].pos;
+            glm::vec3        normal = glm::cross(p1 - p0, p2 - p0);
+            float            area   = glm::length(normal);
+            centroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+            normals[cluster] += normal;
+            areas[cluster] += area;
+        }
+        meshCentroid += centroids[cluster];
+        meshArea += areas[cluster];
+    }
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+    // Clusters facing away from the center and far out along their normal first.
+    std::vector<float> sortKeys(clusterCount, 0.0f);
+    for(size_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        float length = glm::length(normals[cluster]);
+        if(areas[cluster] > 0.0f && length > 0.0f)
+        {
+            sortKeys[cluster] = glm::dot(centroids[cluster] / areas[cluster] - meshCentroid, normals[cluster] / length);
+        }
+    }
+    std::vector<uint32_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for(uint32_t cluster : order)
+    {
+        result.insert(result.end(), indices.begin() + clusterStarts[cluster] * 3,
+                      indices.begin() + clusterStarts[cluster + 1] * 3);
+    }
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+}  // namespace aph
@@ -0,0 +1,58 @@
+#ifndef MESH_OPTIMIZER_H_
+#define MESH_OPTIMIZER_H_
+
+#include "scene/mesh.h"
+
+namespace aph
+{
+// Entries of the simulated post-transform cache, the optimizations below target the same size.
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats
+{
+    size_t triangles   = {};
+    // Distinct vertices referenced.
+    size_t vertices    = {};
+    // Vertices shaded, one per cache miss.
+    size_t transformed = {};
+
+    // Average cache miss ratio, shaded vertices per triangle: 3 without any reuse, 0.5 at best on a regular grid.
+    float getAcmr() const { return triangles ? static_cast<float>(transformed) / triangles : 0.0f; }
+    // Average transformed vertex ratio, shaded vertices per distinct vertex: 1 at best.
+    float getAtvr() const { return vertices ? static_cast<float>(transformed) / vertices : 0.0f; }
+
+    VertexCacheStats& operator+=(const VertexCacheStats& other)
+    {
+        triangles += other.triangles;
+        vertices += other.vertices;
+        transformed += other.transformed;
+        return *this;
+    }
+};
+
+// Runs the triangle list through a FIFO cache of cacheSize vertices, as a draw of it would.
+VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Maps every vertex onto the first one with bit identical data, the unique vertices numbered in order of first
+// occurrence. Returns their count.
+size_t generateWeldRemap(std::span<const Vertex> vertices, std::vector<uint32_t>& remap);
+// Maps every vertex used by the triangle list onto its order of first use, unused ones onto UINT32_MAX, so vertex
+// fetches walk the vertex buffer forwards. Returns the number of used vertices.
+size_t generateFetchRemap(std::span<const uint32_t> indices, size_t vertexCount, std::vector<uint32_t>& remap);
+// Rewrites the vertices and the indices of the whole mesh with a remap from one of the above.
+void   remapMesh(std::vector<Vertex>& vertices, std::span<uint32_t> indices, std::span<const uint32_t> remap,
+                 size_t remappedCount);
+
+// Reorders triangles for the post-transform cache with Tipsify: fans around the current vertex are emitted whole,
+// and the next vertex is the neighbor that is still used and will stay cached longest, falling back to recently
+// emitted vertices and then to the lowest unfinished one. Linear in the number of indices. Index lists that are not
+// whole triangles are left unchanged, by this and by optimizeOverdraw().
+void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+// Reorders clusters of a cache optimized triangle list so outward facing parts far from the center come first and
+// occlude the rest, reducing overdraw. Clusters break where the cache restarts and, within those, as soon as their
+// cache miss ratio is within threshold of the whole cluster's, so the cache efficiency barely drops.
+void optimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, float threshold = 1.05f,
+                      uint32_t cacheSize = VERTEX_CACHE_SIZE);
+}  // namespace aph
+
+#endif  // MESH_OPTIMIZER_H_
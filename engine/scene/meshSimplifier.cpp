@@ -0,0 +1,414 @@
+#include "meshSimplifier.h"
+
+#include "common/parallel.h"
+
+#include <numeric>
+
+namespace aph
+{
+// Collapse passes before giving up on reaching the target.
+constexpr uint32_t SIMPLIFY_MAX_PASSES = 64;
+// A collapse is rejected once it turns a triangle's normal by more than about 75 degrees.
+constexpr double   SIMPLIFY_MIN_NORMAL_COS = 0.25;
+// Candidate collapses per parallel chunk when computing their cost.
+constexpr size_t   SIMPLIFY_GRAIN_SIZE = 4 * 1024;
+
+namespace
+{
+// Sum of squared distances to a set of planes, each weighted by the area of its triangle.
+struct Quadric
+{
+    // Upper triangle of the symmetric 4x4 matrix.
+    double a2 = {}, ab = {}, ac = {}, ad = {};
+    double b2 = {}, bc = {}, bd = {};
+    double c2 = {}, cd = {};
+    double d2     = {};
+    double weight = {};
+
+    void addPlane(const glm::dvec3& normal, double distance, double area)
+    {
+        a2 += area * normal.x * normal.x;
+        ab += area * normal.x * normal.y;
+        ac += area * normal.x * normal.z;
+        ad += area * normal.x * distance;
+        b2 += area * normal.y * normal.y;
+        bc += area * normal.y * normal.z;
+        bd += area * normal.y * distance;
+        c2 += area * normal.z * normal.z;
+        cd += area * normal.z * distance;
+        d2 += area * distance * distance;
+        weight += area;
+    }
+
+    void add(const Quadric& other)
+    {
+        a2 += other.a2;
+        ab += other.ab;
+        ac += other.ac;
+        ad += other.ad;
+        b2 += other.b2;
+        bc += other.bc;
+        bd += other.bd;
+        c2 += other.c2;
+        cd += other.cd;
+        d2 += other.d2;
+        weight += other.weight;
+    }
+
+    // Mean squared distance of the point to the planes.
+    double evaluate(const glm::dvec3& p) const
+    {
+        double error = a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z + d2 +
+                       2.0 * (ab * p.x * p.y + ac * p.x * p.z + bc * p.y * p.z + ad * p.x + bd * p.y + cd * p.z);
+        return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+    }
+};
+
+struct Collapse
+{
+    uint32_t from  = {};
+    uint32_t to    = {};
+    // Squared distance term of the cost, without the attributes.
+    double   error = {};
+    double   cost  = {};
+};
+
+enum class VertexKind : uint8_t
+{
+    // Moves onto any neighbor.
+    FREE,
+    // Has copies with other attributes at its position and lies on exactly two seam edges, moves along the seam only.
+    SEAM,
+    // Seam corners and junctions, and open borders if asked to.
+    LOCKED,
+};
+
+inline uint64_t packEdge(uint32_t a, uint32_t b)
+{
+    return static_cast<uint64_t>(a) << 32 | b;
+}
+
+// Vertices at the same position, canonical[v] is the first of them and nextSibling links them into a ring.
+void findPositionGroups(std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+                        std::vector<uint32_t>& canonical, std::vector<uint32_t>& nextSibling)
+{
+    struct PositionHash
+    {
+        size_t operator()(const glm::vec3& p) const
+        {
+            uint32_t bits[3];
+            memcpy(bits, &p, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+
+    canonical.assign(vertices.size(), UINT32_MAX);
+    nextSibling.resize(vertices.size());
+    std::iota(nextSibling.begin(), nextSibling.end(), 0);
+    std::unordered_map<glm::vec3, uint32_t, PositionHash> firstAtPosition;
+    for(uint32_t index : indices)
+    {
+        if(canonical[index] != UINT32_MAX)
+        {
+            continue;
+        }
+        auto [it, inserted] = firstAtPosition.try_emplace(vertices[index].pos, index);
+        canonical[index]    = it->second;
+        if(!inserted)
+        {
+            nextSibling[index]      = nextSibling[it->second];
+            nextSibling[it->second] = index;
+        }
+    }
+}
+
+// Kinds of the position groups of the current triangles, indexed by canonical vertex. An edge used in one direction
+// only is a seam edge when its positions are used the other way round, else it is on an open border.
+void classifyVertices(std::span<const uint32_t> indices, std::span<const uint32_t> canonical,
+                      std::span<const uint32_t> nextSibling, bool lockBorder, std::vector<VertexKind>& kinds,
+                      std::vector<std::array<uint32_t, 2>>& seamNeighbors)
+{
+    std::vector<uint64_t> vertexEdges(indices.size());
+    std::vector<uint64_t> positionEdges(indices.size());
+    for(size_t idx = 0; idx < indices.size(); ++idx)
+    {
+        size_t next        = idx % 3 == 2 ? idx - 2 : idx + 1;
+        vertexEdges[idx]   = packEdge(indices[idx], indices[next]);
+        positionEdges[idx] = packEdge(canonical[indices[idx]], canonical[indices[next]]);
+    }
+    std::sort(vertexEdges.begin(), vertexEdges.end());
+    std::sort(positionEdges.begin(), positionEdges.end());
+
+    std::vector<uint8_t> seamCounts(canonical.size());
+    std::vector<uint8_t> border(canonical.size());
+    seamNeighbors.assign(canonical.size(), { UINT32_MAX, UINT32_MAX });
+    auto addSeamNeighbor = [&](uint32_t vertex, uint32_t neighbor) {
+        auto& neighbors = seamNeighbors[vertex];
+        if(neighbors[0] == neighbor || neighbors[1] == neighbor)
+        {
+            return;
+        }
+        if(seamCounts[vertex] < neighbors.size())
+        {
+            neighbors[seamCounts[vertex]] = neighbor;
+        }
+        seamCounts[vertex] = std::min(seamCounts[vertex] + 1, 3);
+    };
+    for(size_t idx = 0; idx < indices.size(); ++idx)
+    {
+        size_t   next = idx % 3 == 2 ? idx - 2 : idx + 1;
+        uint32_t a = indices[idx], b = indices[next];
+        if(std::binary_search(vertexEdges.begin(), vertexEdges.end(), packEdge(b, a)))
+        {
+            continue;
+        }
+        if(std::binary_search(positionEdges.begin(), positionEdges.end(), packEdge(canonical[b], canonical[a])))
+        {
+            addSeamNeighbor(canonical[a], canonical[b]);
+            addSeamNeighbor(canonical[b], canonical[a]);
+        }
+        else
+        {
+            border[canonical[a]] = border[canonical[b]] = true;
+        }
+    }
+
+    kinds.assign(canonical.size(), VertexKind::LOCKED);
+    for(uint32_t index : indices)
+    {
+        uint32_t group = canonical[index];
+        if(lockBorder && border[group])
+        {
+            kinds[group] = VertexKind::LOCKED;
+        }
+        else if(nextSibling[group] == group)
+        {
+            kinds[group] = VertexKind::FREE;
+        }
+        else
+        {
+            kinds[group] = seamCounts[group] == 2 ? VertexKind::SEAM : VertexKind::LOCKED;
+        }
+    }
+}
+}  // namespace
+
+std::vector<uint32_t> simplifyMesh(std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+                                   const SimplifyOptions& options, float* pError)
+{
+    std::vector<uint32_t> result(indices.begin(), indices.end());
+    if(pError)
+    {
+        *pError = 0.0f;
+    }
+    if(result.size() <= options.targetIndexCount || result.size() % 3 != 0)
+    {
+        return result;
+    }
+
+    auto position = [&vertices](uint32_t vertex) { return glm::dvec3(vertices[vertex].pos); };
+
+    std::vector<uint32_t> canonical;
+    std::vector<uint32_t> nextSibling;
+    findPositionGroups(vertices, indices, canonical, nextSibling);
+
+    // One quadric per position, the copies of a seam vertex move together.
+    std::vector<Quadric> quadrics(vertices.size());
+    for(size_t first = 0; first < result.size(); first += 3)
+    {
+        glm::dvec3 p0     = position(result[first]);
+        glm::dvec3 normal = glm::cross(position(result[first + 1]) - p0, position(result[first + 2]) - p0);
+        double     length = glm::length(normal);
+        if(length == 0.0)
+        {
+            continue;
+        }
+        normal /= length;
+        for(uint32_t corner = 0; corner < 3; ++corner)
+        {
+            quadrics[canonical[result[first + corner]]].addPlane(normal, -glm::dot(normal, p0), length * 0.5);
+        }
+    }
+
+    double maxErrorSquared = static_cast<double>(options.maxError) * options.maxError;
+    double normalWeight    = static_cast<double>(options.normalWeight) * options.normalWeight;
+    double uvWeight        = static_cast<double>(options.uvWeight) * options.uvWeight;
+    double worstError      = 0.0;
+
+    std::vector<VertexKind>                    kinds;
+    std::vector<std::array<uint32_t, 2>>       seamNeighbors;
+    std::vector<uint32_t>                      triangleOffsets;
+    std::vector<uint32_t>                      vertexTriangles;
+    std::vector<Collapse>                      collapses;
+    std::vector<std::pair<uint32_t, uint32_t>> moves;
+    std::vector<uint32_t>                      remap(vertices.size());
+    std::vector<uint8_t>                       touched(vertices.size());
+    std::iota(remap.begin(), remap.end(), 0);
+
+    for(uint32_t pass = 0; pass < SIMPLIFY_MAX_PASSES && result.size() > options.targetIndexCount; ++pass)
+    {
+        classifyVertices(result, canonical, nextSibling, options.lockBorder, kinds, seamNeighbors);
+
+        // Triangles around every vertex.
+        triangleOffsets.assign(vertices.size() + 1, 0);
+        for(uint32_t index : result)
+        {
+            ++triangleOffsets[index + 1];
+        }
+        std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+        vertexTriangles.resize(result.size());
+        {
+            std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for(size_t idx = 0; idx < result.size(); ++idx)
+            {
+                vertexTriangles[cursor[result[idx]]++] = idx / 3;
+            }
+        }
+
+        // Every directed edge is a collapse of its first vertex onto its second, interior edges appear both ways.
+        collapses.clear();
+        for(size_t idx = 0; idx < result.size(); ++idx)
+        {
+            size_t   next = idx % 3 == 2 ? idx - 2 : idx + 1;
+            uint32_t from = result[idx], to = result[next];
+            uint32_t group = canonical[from];
+            if(kinds[group] == VertexKind::FREE ||
+               (kinds[group] == VertexKind::SEAM &&
+                (seamNeighbors[group][0] == canonical[to] || seamNeighbors[group][1] == canonical[to])))
+            {
+                collapses.push_back({ .from = from, .to = to });
+            }
+        }
+        parallelFor(
+            0, collapses.size(),
+            [&](size_t idx) {
+                Collapse&     collapse = collapses[idx];
+                const Vertex& from     = vertices[collapse.from];
+                const Vertex& to       = vertices[collapse.to];
+                glm::vec3     normal   = from.normal - to.normal;
+                glm::vec2     uv       = from.uv - to.uv;
+                collapse.error         = quadrics[canonical[collapse.from]].evaluate(position(collapse.to));
+                collapse.cost          = collapse.error + normalWeight * glm::dot(normal, normal) +
+                                uvWeight * glm::dot(uv, uv);
+            },
+            SIMPLIFY_GRAIN_SIZE);
+        std::erase_if(collapses,
+                      [maxErrorSquared](const Collapse& collapse) { return collapse.cost > maxErrorSquared; });
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+        // Cheapest first. Every copy of the source moves onto the copy of the target among its own triangles. A
+        // collapse changes the triangles around its source, so the vertices of those are left alone for the rest of
+        // the pass and every collapse is checked against the triangles as they are.
+        size_t trianglesToRemove = (result.size() - options.targetIndexCount) / 3;
+        size_t removed           = 0;
+        std::fill(touched.begin(), touched.end(), 0);
+        std::vector<uint32_t> collapsedVertices;
+        for(const Collapse& collapse : collapses)
+        {
+            if(removed >= trianglesToRemove)
+            {
+                break;
+            }
+
+            bool     valid     = true;
+            uint32_t collapsed = 0;
+            uint32_t source    = collapse.from;
+            moves.clear();
+            do
+            {
+                uint32_t target = UINT32_MAX;
+                for(uint32_t offset = triangleOffsets[source]; offset < triangleOffsets[source + 1]; ++offset)
+                {
+                    const uint32_t* pTriangle = &result[vertexTriangles[offset] * 3];
+                    for(uint32_t corner = 0; corner < 3; ++corner)
+                    {
+                        if(canonical[pTriangle[corner]] == canonical[collapse.to])
+                        {
+                            // Two copies of the target around one source would leave a triangle of zero area.
+                            valid  = valid && (target == UINT32_MAX || target == pTriangle[corner]);
+                            target = pTriangle[corner];
+                        }
+                    }
+                }
+                if(triangleOffsets[source] != triangleOffsets[source + 1])
+                {
+                    valid = valid && target != UINT32_MAX && !touched[source] && !touched[target];
+                    moves.push_back({ source, target });
+                }
+                source = nextSibling[source];
+            } while(valid && source != collapse.from);
+
+            for(size_t moveIdx = 0; valid && moveIdx < moves.size(); ++moveIdx)
+            {
+                auto [from, to] = moves[moveIdx];
+                for(uint32_t offset = triangleOffsets[from]; valid && offset < triangleOffsets[from + 1]; ++offset)
+                {
+                    const uint32_t* pTriangle = &result[vertexTriangles[offset] * 3];
+                    if(pTriangle[0] == to || pTriangle[1] == to || pTriangle[2] == to)
+                    {
+                        ++collapsed;
+                        continue;
+                    }
+                    std::array<glm::dvec3, 3> before, after;
+                    for(uint32_t corner = 0; corner < 3; ++corner)
+                    {
+                        before[corner] = position(pTriangle[corner]);
+                        after[corner]  = pTriangle[corner] == from ? position(to) : before[corner];
+                    }
+                    glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                    glm::dvec3 normalAfter  = glm::cross(after[1] - after[0], after[2] - after[0]);
+                    valid = glm::dot(normalBefore, normalAfter) >=
+                            SIMPLIFY_MIN_NORMAL_COS * glm::length(normalBefore) * glm::length(normalAfter);
+                }
+            }
+            if(!valid || collapsed == 0)
+            {
+                continue;
+            }
+
+            for(auto [from, to] : moves)
+            {
+                for(uint32_t offset = triangleOffsets[from]; offset < triangleOffsets[from + 1]; ++offset)
+                {
+                    const uint32_t* pTriangle = &result[vertexTriangles[offset] * 3];
+                    touched[pTriangle[0]] = touched[pTriangle[1]] = touched[pTriangle[2]] = true;
+                }
+                remap[from] = to;
+                collapsedVertices.push_back(from);
+            }
+            quadrics[canonical[collapse.to]].add(quadrics[canonical[collapse.from]]);
+            worstError = std::max(worstError, collapse.error);
+            removed += collapsed;
+        }
+        if(collapsedVertices.empty())
+        {
+            break;
+        }
+
+        // Collapses of one pass never chain, a single lookup resolves every vertex.
+        size_t kept = 0;
+        for(size_t first = 0; first < result.size(); first += 3)
+        {
+            uint32_t a = remap[result[first]], b = remap[result[first + 1]], c = remap[result[first + 2]];
+            if(a != b && b != c && c != a)
+            {
+                result[kept++] = a;
+                result[kept++] = b;
+                result[kept++] = c;
+            }
+        }
+        result.resize(kept);
+        for(uint32_t vertex : collapsedVertices)
+        {
+            remap[vertex] = vertex;
+        }
+    }
+
+    if(pError)
+    {
+        *pError = static_cast<float>(std::sqrt(worstError));
+    }
+    return result;
+}
+}  // namespace aph
@@ -0,0 +1,33 @@
+#ifndef MESH_SIMPLIFIER_H_
+#define MESH_SIMPLIFIER_H_
+
+#include "scene/mesh.h"
+
+namespace aph
+{
+struct SimplifyOptions
+{
+    // Simplification stops once the triangle list is at most this long.
+    size_t targetIndexCount = {};
+    // Largest cost of a single collapse, attribute terms included, as a distance in the units of the positions.
+    float  maxError         = std::numeric_limits<float>::max();
+    // Cost of a unit difference of normals and of texture coordinates between the two ends of a collapse, as a
+    // distance in the units of the positions.
+    float  normalWeight     = {};
+    float  uvWeight         = {};
+    // Keeps vertices on open borders in place, so the result still meets whatever the border was connected to.
+    bool   lockBorder       = true;
+};
+
+// Simplifies a triangle list by collapsing edges onto one of their end vertices, cheapest first by quadric error
+// metric plus the weighted attribute difference. Collapses run in passes of independent edges, rejecting any that
+// would flip a triangle. Vertices with copies at the same position (attribute seams) only move along the seam, all
+// copies together, so seams stay closed; seam corners never move. The result indexes the same vertices. pError
+// receives the largest positional error of a collapse made: the area weighted root mean square distance of the kept
+// vertex from the planes of the original triangles merged into it, without the attribute terms. Index lists that are
+// not whole triangles are returned unchanged.
+std::vector<uint32_t> simplifyMesh(std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+                                   const SimplifyOptions& options, float* pError = nullptr);
+}  // namespace aph
+
+#endif  // MESH_SIMPLIFIER_H_
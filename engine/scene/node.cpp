@@ -1,5 +1,6 @@
 #include "node.h"
 
+#include "bvh.h"
 #include "camera.h"
 #include "light.h"
 #include "mesh.h"
@@ -11,4 +12,12 @@ SceneNode::SceneNode(SceneNode* parent, glm::mat4 matrix, std::string name) :
     Node<SceneNode>{ parent, Id::generateNewId<SceneNode>(), ObjectType::SCENENODE, matrix, std::move(name) }
 {
 }
+
+SceneNode::~SceneNode()
+{
+    if(m_pBvh && m_boundsProxy != BVH::INVALID_INDEX)
+    {
+        m_pBvh->destroyProxy(m_boundsProxy);
+    }
+}
 }  // namespace aph
@@ -4,9 +4,12 @@
 #include "scene/camera.h"
 #include "scene/light.h"
 #include "scene/mesh.h"
+#include "scene/transformHierarchy.h"
 
 namespace aph
 {
+class BVH;
+
 template <typename TNode>
 class Node : public Object
 {
@@ -14,7 +17,6 @@ public:
     Node(TNode* parent, IdType id, ObjectType type, glm::mat4 transform = glm::mat4(1.0f), std::string name = "") :
         Object{ id, type },
         parent{ parent },
-        matrix{ transform },
         name{ std::move(name) }
     {
         if constexpr(std::is_same<TNode, Node>::value)
@@ -28,60 +30,94 @@ public:
                 name = std::to_string(id);
             }
         }
+
+        // The whole tree shares the root's hierarchy.
+        hierarchy = parent ? parent->hierarchy : std::make_shared<TransformHierarchy>();
+        transformHandle =
+            hierarchy->add(parent ? parent->transformHandle : TransformHierarchy::INVALID_INDEX, transform, this);
     }
 
+    ~Node() override { hierarchy->remove(transformHandle); }
+
     std::shared_ptr<TNode> createChildNode(glm::mat4 transform = glm::mat4(1.0f), std::string name = "")
     {
-        auto childNode = std::shared_ptr<TNode>(new TNode(static_cast<TNode*>(this), transform, std::move(name)));
-        children.push_back(childNode);
+        auto childNode = Object::Create<TNode>(static_cast<TNode*>(this), transform, std::move(name));
+        addChild(childNode);
         return childNode;
     }
 
-    glm::mat4 getTransform()
+    // Local transform, relative to the parent.
+    glm::mat4 getMatrix() const { return hierarchy->getLocal(transformHandle); }
+
+    // World transform. Cached after updateTransforms(), recomputed from the ancestors while any node of the tree moved
+    // since.
+    glm::mat4 getTransform() const { return hierarchy->getWorld(transformHandle); }
+
+    // Call on the root once per frame: recomputes the world transforms of the branches that moved since the last
+    // call, and of nothing else.
+    void updateTransforms()
     {
-        glm::mat4 res         = matrix;
-        auto      currentNode = parent;
-        while(currentNode)
+        hierarchy->update();
+        changedNodes.clear();
+        for(Object* pOwner : hierarchy->getChanged())
         {
-            res         = currentNode->matrix * res;
-            currentNode = currentNode->parent;
+            changedNodes.push_back(static_cast<TNode*>(pOwner));
         }
-        return res;
     }
 
+    // Root only: the nodes whose world transform changed in the last updateTransforms(), parents before children.
+    const std::vector<TNode*>& getChangedNodes() const { return changedNodes; }
+
+    // World transforms of every node of the tree, indexed by getTransformIndex(). Valid after updateTransforms().
+    std::span<const glm::mat4> getWorldTransforms() const { return hierarchy->getWorldMatrices(); }
+    uint32_t                   getTransformIndex() const { return hierarchy->getSlot(transformHandle); }
+
     void addChild(std::shared_ptr<TNode> childNode) { children.push_back(std::move(childNode)); }
-    std::vector<std::shared_ptr<TNode>> getChildren() const { return children; }
-    std::string_view                    getName() const { return name; }
+    const std::vector<std::shared_ptr<TNode>>& getChildren() const { return children; }
+    std::string_view                           getName() const { return name; }
 
     Node<TNode>& rotate(float angle, glm::vec3 axis)
     {
-        matrix = glm::rotate(matrix, angle, axis);
+        hierarchy->rotate(transformHandle, angle, axis);
         return *this;
     }
 
     Node<TNode>& translate(glm::vec3 value)
     {
-        matrix = glm::translate(matrix, value);
+        hierarchy->translate(transformHandle, value);
         return *this;
     }
 
     Node<TNode>& scale(glm::vec3 value)
     {
-        matrix = glm::scale(matrix, value);
+        hierarchy->scale(transformHandle, value);
         return *this;
     }
 
 protected:
+    void markDirty() { hierarchy->markDirty(transformHandle); }
+
     std::string                         name     = {};
     std::vector<std::shared_ptr<TNode>> children = {};
     TNode*                              parent   = {};
-    glm::mat4                           matrix   = { glm::mat4(1.0f) };
+
+private:
+    std::shared_ptr<TransformHierarchy> hierarchy       = {};
+    TransformHierarchy::Handle          transformHandle = {};
+
+    // Root only.
+    std::vector<TNode*> changedNodes = {};
 };
 
 class SceneNode : public Node<SceneNode>
 {
+    // Keeps the node's proxy in the scene's BVH.
+    friend class Scene;
+
 public:
     SceneNode(SceneNode* parent, glm::mat4 matrix = glm::mat4(1.0f), std::string name = "");
+    ~SceneNode() override;
+
     ObjectType getAttachType() const { return m_object ? m_object->getType() : ObjectType::UNATTACHED; };
     IdType     getAttachObjectId() { return m_object->getId(); }
 
@@ -91,6 +127,8 @@ public:
         if constexpr(isObjectTypeValid<TObject>())
         {
             m_object = object;
+            // The next Scene::updateTransforms() creates or destroys the bounds proxy.
+            markDirty();
         }
         else
         {
@@ -120,6 +158,9 @@ public:
 
 private:
     std::shared_ptr<Object> m_object{};
+    // Owner of m_boundsProxy, cleared when the scene goes away before the node.
+    BVH*                    m_pBvh{};
+    uint32_t                m_boundsProxy{ UINT32_MAX };
 };
 }  // namespace aph
 
@@ -2,6 +2,7 @@
 #define VKLMODEL_H_
 
 #include "idObject.h"
+#include "common/objectPool.h"
 
 namespace aph
 {
@@ -19,11 +20,15 @@ enum class ObjectType : uint8_t
 
 class Object : public IdObject
 {
+    // Sets the id of the objects it creates to their handle.
+    friend class Scene;
+
 public:
+    // Objects and their reference counts come from per-size pools, see PoolAllocator.
     template <typename TObject, typename... Args>
     static std::shared_ptr<TObject> Create(Args&&... args)
     {
-        auto instance = std::make_shared<TObject>(std::forward<Args>(args)...);
+        auto instance = std::allocate_shared<TObject>(PoolAllocator<TObject>(), std::forward<Args>(args)...);
         return instance;
     }
     Object(IdType id, ObjectType type) : IdObject{ id }, m_type{ type } {}
@@ -0,0 +1,377 @@
+#include "occlusion.h"
+
+#include "common/parallel.h"
+#include "common/profiler.h"
+
+namespace aph
+{
+// Rows of the depth buffer rasterized by one task.
+constexpr uint32_t OCCLUSION_BAND_HEIGHT = 16;
+// A box is tested on the finest pyramid level where its rectangle spans at most this many texels per axis.
+constexpr int32_t  OCCLUSION_MAX_TEST_TEXELS = 4;
+// Boxes this close behind the depth buffer still count as visible: a flat box has the depth of the surface it bounds,
+// which rasterizes a few ulps nearer than that. Keeps occluders and coplanar decals from hiding themselves.
+constexpr float    OCCLUSION_DEPTH_BIAS = 1e-6f;
+
+namespace
+{
+struct ScreenVertex
+{
+    double x, y, z;
+};
+
+// Edge function through p and q, positive on the inside of a counter-clockwise triangle.
+inline void setupEdge(const ScreenVertex& p, const ScreenVertex& q, double originX, double originY, double& edgeX,
+                      double& edgeY, double& edgeC)
+{
+    edgeX = p.y - q.y;
+    edgeY = q.x - p.x;
+    edgeC = edgeX * (originX - p.x) + edgeY * (originY - p.y);
+}
+
+// Done in double precision: vertices close to the near plane project far outside the screen and the edge functions
+// of such triangles lose all their precision in float.
+bool setupScreenTriangle(ScreenVertex a, ScreenVertex b, ScreenVertex c, uint32_t width, uint32_t height,
+                         std::array<float, 3>& edgeX, std::array<float, 3>& edgeY, std::array<float, 3>& edgeC,
+                         float& depthX, float& depthY, float& depthC, int32_t& minX, int32_t& minY, int32_t& maxX,
+                         int32_t& maxY)
+{
+    double area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if(!(std::abs(area) > 0.0))
+    {
+        return false;
+    }
+    // Occluders are rasterized from both sides.
+    if(area < 0.0)
+    {
+        std::swap(b, c);
+        area = -area;
+    }
+
+    // Pixels whose centers lie within the bounds of the triangle.
+    auto firstPixel = [](double value, uint32_t size) {
+        return static_cast<int32_t>(std::clamp(std::ceil(value - 0.5), 0.0, static_cast<double>(size)));
+    };
+    auto lastPixel = [](double value, uint32_t size) {
+        return static_cast<int32_t>(std::clamp(std::floor(value - 0.5), -1.0, static_cast<double>(size) - 1.0));
+    };
+    minX = firstPixel(std::min({ a.x, b.x, c.x }), width);
+    minY = firstPixel(std::min({ a.y, b.y, c.y }), height);
+    maxX = lastPixel(std::max({ a.x, b.x, c.x }), width);
+    maxY = lastPixel(std::max({ a.y, b.y, c.y }), height);
+    if(minX > maxX || minY > maxY)
+    {
+        return false;
+    }
+
+    double originX = minX + 0.5;
+    double originY = minY + 0.5;
+    // Edge i is opposite vertex i, its function over the area is the barycentric weight of that vertex.
+    std::array<double, 3> x, y, constant;
+    setupEdge(b, c, originX, originY, x[0], y[0], constant[0]);
+    setupEdge(c, a, originX, originY, x[1], y[1], constant[1]);
+    setupEdge(a, b, originX, originY, x[2], y[2], constant[2]);
+    for(uint32_t edge = 0; edge < 3; ++edge)
+    {
+        edgeX[edge] = static_cast<float>(x[edge]);
+        edgeY[edge] = static_cast<float>(y[edge]);
+        edgeC[edge] = static_cast<float>(constant[edge]);
+    }
+    depthX = static_cast<float>((x[0] * a.z + x[1] * b.z + x[2] * c.z) / area);
+    depthY = static_cast<float>((y[0] * a.z + y[1] * b.z + y[2] * c.z) / area);
+    depthC = static_cast<float>((constant[0] * a.z + constant[1] * b.z + constant[2] * c.z) / area);
+    return true;
+}
+}  // namespace
+
+void OcclusionCuller::setResolution(uint32_t width, uint32_t height)
+{
+    m_width  = (std::max(width, 1u) + 3) & ~3u;
+    m_height = std::max(height, 1u);
+
+    m_levels.clear();
+    uint32_t levelWidth  = m_width;
+    uint32_t levelHeight = m_height;
+    while(true)
+    {
+        m_levels.push_back({ levelWidth, levelHeight, std::vector<float>(levelWidth * levelHeight, 1.0f) });
+        if(levelWidth == 1 && levelHeight == 1)
+        {
+            break;
+        }
+        levelWidth  = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+    }
+    m_bands.resize((m_height + OCCLUSION_BAND_HEIGHT - 1) / OCCLUSION_BAND_HEIGHT);
+    m_rendered = false;
+}
+
+uint32_t OcclusionCuller::addOccluder(std::vector<glm::vec3> positions, std::vector<uint32_t> indices)
+{
+    Occluder occluder{ .positions = std::move(positions), .indices = std::move(indices), .firstSlot = m_slotCount };
+    m_slotCount += occluder.indices.size() / 3 * 2;
+    m_occluders.push_back(std::move(occluder));
+    return m_occluders.size() - 1;
+}
+
+void OcclusionCuller::setOccluderTransform(uint32_t occluder, const glm::mat4& transform)
+{
+    m_occluders[occluder].transform = transform;
+}
+
+void OcclusionCuller::setOccluderEnabled(uint32_t occluder, bool enabled)
+{
+    m_occluders[occluder].enabled = enabled;
+}
+
+void OcclusionCuller::clearOccluders()
+{
+    m_occluders.clear();
+    m_triangles.clear();
+    m_slotCount = 0;
+}
+
+void OcclusionCuller::render(const glm::mat4& viewProj)
+{
+    APH_PROFILE_FUNCTION();
+    m_viewProj = viewProj;
+    m_triangles.resize(m_slotCount);
+
+    parallelForRange(
+        0, m_occluders.size(),
+        [this, &viewProj](size_t begin, size_t end) {
+            for(size_t idx = begin; idx < end; ++idx)
+            {
+                if(m_occluders[idx].enabled)
+                {
+                    setupOccluder(m_occluders[idx], viewProj);
+                }
+            }
+        },
+        1);
+
+    m_rasterizedTriangles = 0;
+    for(auto& band : m_bands)
+    {
+        band.clear();
+    }
+    for(const Occluder& occluder : m_occluders)
+    {
+        if(!occluder.enabled)
+        {
+            continue;
+        }
+        uint32_t slotEnd = occluder.firstSlot + occluder.indices.size() / 3 * 2;
+        for(uint32_t slot = occluder.firstSlot; slot < slotEnd; ++slot)
+        {
+            const Triangle& triangle = m_triangles[slot];
+            if(triangle.minX > triangle.maxX)
+            {
+                continue;
+            }
+            ++m_rasterizedTriangles;
+            for(uint32_t band = triangle.minY / OCCLUSION_BAND_HEIGHT; band <= triangle.maxY / OCCLUSION_BAND_HEIGHT;
+                ++band)
+            {
+                m_bands[band].push_back(slot);
+            }
+        }
+    }
+
+    parallelFor(0, m_bands.size(), [this](size_t band) { rasterizeBand(band); }, 1);
+    buildPyramid();
+    m_rendered = true;
+}
+
+void OcclusionCuller::setupOccluder(Occluder& occluder, const glm::mat4& viewProj)
+{
+    glm::mat4 transform = viewProj * occluder.transform;
+    occluder.clipPositions.resize(occluder.positions.size());
+    for(size_t idx = 0; idx < occluder.positions.size(); ++idx)
+    {
+        occluder.clipPositions[idx] = transform * glm::vec4(occluder.positions[idx], 1.0f);
+    }
+
+    auto toScreen = [this](const glm::vec4& clip) {
+        return ScreenVertex{ (clip.x / clip.w * 0.5 + 0.5) * m_width, (clip.y / clip.w * 0.5 + 0.5) * m_height,
+                             clip.z / clip.w };
+    };
+
+    for(size_t first = 0; first + 2 < occluder.indices.size(); first += 3)
+    {
+        Triangle* pSlots = &m_triangles[occluder.firstSlot + first / 3 * 2];
+        pSlots[0]        = {};
+        pSlots[1]        = {};
+
+        // Clipped against the near plane z >= 0, which leaves w positive as well.
+        std::array<glm::vec4, 4> polygon;
+        uint32_t                 count = 0;
+        for(uint32_t corner = 0; corner < 3; ++corner)
+        {
+            const glm::vec4& current = occluder.clipPositions[occluder.indices[first + corner]];
+            const glm::vec4& next    = occluder.clipPositions[occluder.indices[first + (corner + 1) % 3]];
+            if(current.z >= 0.0f)
+            {
+                polygon[count++] = current;
+            }
+            if((current.z >= 0.0f) != (next.z >= 0.0f))
+            {
+                polygon[count++] = glm::mix(current, next, current.z / (current.z - next.z));
+            }
+        }
+        if(count < 3 || polygon[0].w <= 0.0f || polygon[1].w <= 0.0f || polygon[2].w <= 0.0f ||
+           (count == 4 && polygon[3].w <= 0.0f))
+        {
+            continue;
+        }
+
+        for(uint32_t fan = 0; fan + 2 < count; ++fan)
+        {
+            Triangle& triangle = pSlots[fan];
+            if(!setupScreenTriangle(toScreen(polygon[0]), toScreen(polygon[fan + 1]), toScreen(polygon[fan + 2]),
+                                    m_width, m_height, triangle.edgeX, triangle.edgeY, triangle.edgeC,
+                                    triangle.depthX, triangle.depthY, triangle.depthC, triangle.minX, triangle.minY,
+                                    triangle.maxX, triangle.maxY))
+            {
+                triangle = {};
+            }
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeBand(uint32_t band)
+{
+    auto&   depth    = m_levels[0].depth;
+    int32_t rowBegin = band * OCCLUSION_BAND_HEIGHT;
+    int32_t rowEnd   = std::min<int32_t>(rowBegin + OCCLUSION_BAND_HEIGHT, m_height);
+    std::fill(depth.begin() + rowBegin * m_width, depth.begin() + rowEnd * m_width, 1.0f);
+
+    for(uint32_t slot : m_bands[band])
+    {
+        const Triangle& triangle = m_triangles[slot];
+        int32_t         minY     = std::max(triangle.minY, rowBegin);
+        int32_t         maxY     = std::min(triangle.maxY, rowEnd - 1);
+        // Four pixels at a time from a multiple of 4, the edge functions reject the extra ones.
+        int32_t         minX     = triangle.minX & ~3;
+        for(int32_t y = minY; y <= maxY; ++y)
+        {
+            float  v    = static_cast<float>(y - triangle.minY);
+            float* pRow = &depth[y * m_width];
+#if defined(__SSE__) || defined(_M_X64)
+            const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+            const __m128 zero  = _mm_setzero_ps();
+            __m128       edgeX[3], edgeRow[3];
+            for(uint32_t edge = 0; edge < 3; ++edge)
+            {
+                edgeX[edge]   = _mm_set1_ps(triangle.edgeX[edge]);
+                edgeRow[edge] = _mm_set1_ps(triangle.edgeY[edge] * v + triangle.edgeC[edge]);
+            }
+            const __m128 depthX   = _mm_set1_ps(triangle.depthX);
+            const __m128 depthRow = _mm_set1_ps(triangle.depthY * v + triangle.depthC);
+            for(int32_t x = minX; x <= triangle.maxX; x += 4)
+            {
+                __m128 u       = _mm_add_ps(_mm_set1_ps(static_cast<float>(x - triangle.minX)), lanes);
+                __m128 covered = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX[0], u), edgeRow[0]), zero);
+                covered = _mm_and_ps(covered, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX[1], u), edgeRow[1]), zero));
+                covered = _mm_and_ps(covered, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX[2], u), edgeRow[2]), zero));
+                __m128 current = _mm_loadu_ps(pRow + x);
+                __m128 nearest = _mm_min_ps(current, _mm_add_ps(_mm_mul_ps(depthX, u), depthRow));
+                _mm_storeu_ps(pRow + x, _mm_or_ps(_mm_and_ps(covered, nearest), _mm_andnot_ps(covered, current)));
+            }
+#else
+            for(int32_t x = minX; x <= triangle.maxX; ++x)
+            {
+                float u       = static_cast<float>(x - triangle.minX);
+                bool  covered = true;
+                for(uint32_t edge = 0; edge < 3; ++edge)
+                {
+                    float value = triangle.edgeX[edge] * u + (triangle.edgeY[edge] * v + triangle.edgeC[edge]);
+                    covered     = covered && value >= 0.0f;
+                }
+                if(covered)
+                {
+                    pRow[x] = std::min(pRow[x], triangle.depthX * u + (triangle.depthY * v + triangle.depthC));
+                }
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionCuller::buildPyramid()
+{
+    for(uint32_t level = 1; level < m_levels.size(); ++level)
+    {
+        const Level& source = m_levels[level - 1];
+        Level&       target = m_levels[level];
+        for(uint32_t y = 0; y < target.height; ++y)
+        {
+            uint32_t y0 = 2 * y;
+            uint32_t y1 = std::min(y0 + 1, source.height - 1);
+            for(uint32_t x = 0; x < target.width; ++x)
+            {
+                uint32_t x0 = 2 * x;
+                uint32_t x1 = std::min(x0 + 1, source.width - 1);
+                target.depth[y * target.width + x] =
+                    std::max(std::max(source.depth[y0 * source.width + x0], source.depth[y0 * source.width + x1]),
+                             std::max(source.depth[y1 * source.width + x0], source.depth[y1 * source.width + x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::isVisible(const AABB& box) const
+{
+    if(!m_rendered || !box.isValid())
+    {
+        return true;
+    }
+
+    glm::vec2 screenMin{ std::numeric_limits<float>::max() };
+    glm::vec2 screenMax{ -std::numeric_limits<float>::max() };
+    float     nearest = std::numeric_limits<float>::max();
+    for(uint32_t corner = 0; corner < 8; ++corner)
+    {
+        glm::vec3 position{ corner & 1 ? box.max.x : box.min.x, corner & 2 ? box.max.y : box.min.y,
+                            corner & 4 ? box.max.z : box.min.z };
+        glm::vec4 clip = m_viewProj * glm::vec4(position, 1.0f);
+        if(clip.z < 0.0f || clip.w <= 0.0f)
+        {
+            return true;
+        }
+        glm::vec2 screen{ (clip.x / clip.w * 0.5f + 0.5f) * m_width, (clip.y / clip.w * 0.5f + 0.5f) * m_height };
+        screenMin = glm::min(screenMin, screen);
+        screenMax = glm::max(screenMax, screen);
+        nearest   = std::min(nearest, clip.z / clip.w);
+    }
+
+    // Every pixel the rectangle touches, off screen parts are not known to be hidden.
+    if(screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= m_width || screenMin.y >= m_height)
+    {
+        return true;
+    }
+    int32_t minX = static_cast<int32_t>(std::max(screenMin.x, 0.0f));
+    int32_t minY = static_cast<int32_t>(std::max(screenMin.y, 0.0f));
+    int32_t maxX = static_cast<int32_t>(std::min(screenMax.x, m_width - 1.0f));
+    int32_t maxY = static_cast<int32_t>(std::min(screenMax.y, m_height - 1.0f));
+
+    uint32_t level = 0;
+    while(level + 1 < m_levels.size() && ((maxX >> level) - (minX >> level) >= OCCLUSION_MAX_TEST_TEXELS ||
+                                          (maxY >> level) - (minY >> level) >= OCCLUSION_MAX_TEST_TEXELS))
+    {
+        ++level;
+    }
+    const Level& pyramid = m_levels[level];
+    for(int32_t y = minY >> level; y <= maxY >> level; ++y)
+    {
+        for(int32_t x = minX >> level; x <= maxX >> level; ++x)
+        {
+            if(nearest <= pyramid.depth[y * pyramid.width + x] + OCCLUSION_DEPTH_BIAS)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+}  // namespace aph
@@ -0,0 +1,98 @@
+#ifndef OCCLUSION_H_
+#define OCCLUSION_H_
+
+#include "scene/bounds.h"
+
+namespace aph
+{
+// Software occlusion culling. Occluder triangles are clipped against the near plane and rasterized into a small depth
+// buffer on the thread pool, one band of rows per task and four pixels at a time with SSE. The buffer is then reduced
+// into a pyramid keeping the farthest depth of every 2x2 block. A box is hidden when its nearest depth lies behind
+// every texel its screen rectangle touches, on the finest level where that is only a few texels.
+// Depth follows the [0, 1] range of the projection, smaller is nearer. Boxes crossing the near plane are always
+// visible. Not thread safe, isVisible() may be called concurrently once render() returned.
+class OcclusionCuller
+{
+public:
+    static constexpr uint32_t DEFAULT_WIDTH  = 256;
+    static constexpr uint32_t DEFAULT_HEIGHT = 128;
+
+    OcclusionCuller() { setResolution(DEFAULT_WIDTH, DEFAULT_HEIGHT); }
+
+    // The width is rounded up to a multiple of 4. Takes effect with the next render().
+    void     setResolution(uint32_t width, uint32_t height);
+    uint32_t getWidth() const { return m_width; }
+    uint32_t getHeight() const { return m_height; }
+
+    // Triangle list in the occluder's local space. Returns its index, stable until clearOccluders().
+    uint32_t addOccluder(std::vector<glm::vec3> positions, std::vector<uint32_t> indices);
+    void     setOccluderTransform(uint32_t occluder, const glm::mat4& transform);
+    // Disabled occluders are kept but not rasterized.
+    void     setOccluderEnabled(uint32_t occluder, bool enabled);
+    void     clearOccluders();
+    uint32_t getOccluderCount() const { return m_occluders.size(); }
+
+    // Rasterizes the enabled occluders seen through viewProj and rebuilds the depth pyramid.
+    void render(const glm::mat4& viewProj);
+    // False if the box lies entirely behind the occluders of the last render(), true before the first one.
+    bool isVisible(const AABB& box) const;
+
+    // Triangles of the last render() that reached the screen, after clipping.
+    uint32_t getRasterizedTriangleCount() const { return m_rasterizedTriangles; }
+    // Level 0 is the depth buffer, every further level halves it. Row major.
+    uint32_t               getLevelCount() const { return m_levels.size(); }
+    std::span<const float> getDepth(uint32_t level = 0) const { return m_levels[level].depth; }
+
+private:
+    struct Occluder
+    {
+        std::vector<glm::vec3> positions     = {};
+        std::vector<uint32_t>  indices       = {};
+        glm::mat4              transform     = glm::mat4(1.0f);
+        bool                   enabled       = true;
+        // Triangle slots in m_triangles, two per triangle since clipping can split one.
+        uint32_t               firstSlot     = {};
+        // Clip space positions, scratch of render().
+        std::vector<glm::vec4> clipPositions = {};
+    };
+
+    // Edge functions and depth plane of a screen-space triangle in pixels relative to the center of its top left
+    // pixel. A pixel is covered when all three edge functions are non-negative at its center.
+    struct Triangle
+    {
+        std::array<float, 3> edgeX  = {};
+        std::array<float, 3> edgeY  = {};
+        std::array<float, 3> edgeC  = {};
+        float                depthX = {};
+        float                depthY = {};
+        float                depthC = {};
+        // Inclusive pixel bounds, minX > maxX for an unused slot.
+        int32_t              minX = 1, minY = 1, maxX = 0, maxY = 0;
+    };
+
+    struct Level
+    {
+        uint32_t           width  = {};
+        uint32_t           height = {};
+        std::vector<float> depth  = {};
+    };
+
+    void setupOccluder(Occluder& occluder, const glm::mat4& viewProj);
+    void rasterizeBand(uint32_t band);
+    void buildPyramid();
+
+    uint32_t                           m_width               = {};
+    uint32_t                           m_height              = {};
+    glm::mat4                          m_viewProj            = glm::mat4(1.0f);
+    bool                               m_rendered            = {};
+    std::vector<Occluder>              m_occluders           = {};
+    uint32_t                           m_slotCount           = {};
+    std::vector<Triangle>              m_triangles           = {};
+    // Triangles overlapping each band of rows.
+    std::vector<std::vector<uint32_t>> m_bands               = {};
+    std::vector<Level>                 m_levels              = {};
+    uint32_t                           m_rasterizedTriangles = {};
+};
+}  // namespace aph
+
+#endif  // OCCLUSION_H_
@@ -1,16 +1,95 @@
 #include "scene.h"
+#include "meshOptimizer.h"
+#include "meshSimplifier.h"
+#include "common/allocationTracker.h"
 #include "common/assetManager.h"
 #include "common/common.h"
+#include "common/logger.h"
+#include "common/parallel.h"
+#include "common/profiler.h"
+#include "common/task.h"
 
 #define TINYGLTF_IMPLEMENTATION
 #define TINYGLTF_NO_INCLUDE_STB_IMAGE
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #include <tinygltf/tiny_gltf.h>
 
+#include <numeric>
+
 namespace aph::gltf
 {
+PrimitiveTopology getTopology(int mode)
+{
+    switch(mode)
+    {
+    case TINYGLTF_MODE_POINTS:
+    {
+        return PrimitiveTopology::POINT_LIST;
+    }
+    case TINYGLTF_MODE_LINE:
+    {
+        return PrimitiveTopology::LINE_LIST;
+    }
+    case TINYGLTF_MODE_LINE_LOOP:
+    {
+        return PrimitiveTopology::LINE_LOOP;
+    }
+    case TINYGLTF_MODE_LINE_STRIP:
+    {
+        return PrimitiveTopology::LINE_STRIP;
+    }
+    case TINYGLTF_MODE_TRIANGLE_STRIP:
+    {
+        return PrimitiveTopology::TRI_STRIP;
+    }
+    case TINYGLTF_MODE_TRIANGLE_FAN:
+    {
+        return PrimitiveTopology::TRI_FAN;
+    }
+    default:
+    {
+        return PrimitiveTopology::TRI_LIST;
+    }
+    }
+}
+
+// Rewrites a triangle strip or fan, the indices from firstIndex to the end, as a triangle list with the winding the
+// glTF spec gives its triangles. Triangles of zero area, which strips use to restart, are dropped.
+void convertToTriangleList(PrimitiveTopology topology, std::vector<uint32_t>& indices, size_t firstIndex)
+{
+    std::vector<uint32_t> list;
+    size_t                count    = indices.size() - firstIndex;
+    const uint32_t*       pIndices = indices.data() + firstIndex;
+    list.reserve(count > 2 ? (count - 2) * 3 : 0);
+    for(size_t idx = 2; idx < count; ++idx)
+    {
+        uint32_t a = pIndices[idx - 2], b = pIndices[idx - 1], c = pIndices[idx];
+        if(topology == PrimitiveTopology::TRI_FAN)
+        {
+            a = pIndices[0];
+        }
+        else if(idx % 2 == 1)
+        {
+            // Every other triangle of a strip is flipped to keep the winding.
+            std::swap(a, b);
+        }
+        if(a != b && b != c && c != a)
+        {
+            list.insert(list.end(), { a, b, c });
+        }
+    }
+    indices.resize(firstIndex);
+    indices.insert(indices.end(), list.begin(), list.end());
+}
+
+// Iterations per parallel chunk for the per-pixel and per-vertex conversion loops.
+constexpr size_t PIXEL_GRAIN_SIZE  = 64 * 1024;
+constexpr size_t VERTEX_GRAIN_SIZE = 4 * 1024;
+constexpr size_t INDEX_GRAIN_SIZE  = 16 * 1024;
+
 void loadImages(std::vector<std::shared_ptr<ImageInfo>>& images, tinygltf::Model& input)
 {
+    APH_PROFILE_FUNCTION();
     images.clear();
     for(auto& glTFImage : input.images)
     {
@@ -22,12 +101,15 @@ void loadImages(std::vector<std::shared_ptr<ImageInfo>>& images, tinygltf::Model
         newImage->format = Format::R8G8B8A8_UNORM;
         if(glTFImage.component == 3)
         {
-            std::vector<uint8_t> rgba(newImage->data.size());
-            for(size_t i = 0; i < glTFImage.width * glTFImage.height; ++i)
-            {
-                memcpy(&rgba[4 * i], &glTFImage.image[3 * i], 3);
-            }
-            memcpy(newImage->data.data(), rgba.data(), glTFImage.image.size());
+            const uint8_t* rgb  = glTFImage.image.data();
+            uint8_t*       rgba = newImage->data.data();
+            parallelFor(
+                0, static_cast<size_t>(glTFImage.width) * glTFImage.height,
+                [rgb, rgba](size_t i) {
+                    memcpy(&rgba[4 * i], &rgb[3 * i], 3);
+                    rgba[4 * i + 3] = 0xFF;
+                },
+                PIXEL_GRAIN_SIZE);
         }
         else
         {
@@ -93,7 +175,190 @@ void loadMaterials(std::vector<Material>& materials, tinygltf::Model& input, uin
     }
 }
 
-void loadNodes(std::vector<uint8_t>& verticesList, std::vector<uint8_t>& indicesList, const tinygltf::Node& inputNode,
+bool loadModelFromMemory(tinygltf::Model& model, const std::string& path, const std::vector<uint8_t>& data)
+{
+    tinygltf::TinyGLTF gltfContext;
+    std::string        error, warning;
+    std::string        baseDir = std::filesystem::path(path).parent_path().string();
+
+    bool fileLoaded = false;
+    if(path.find(".glb") != std::string::npos)
+    {
+        fileLoaded = gltfContext.LoadBinaryFromMemory(&model, &error, &warning, data.data(), data.size(), baseDir);
+    }
+    else
+    {
+        fileLoaded = gltfContext.LoadASCIIFromString(&model, &error, &warning,
+                                                     reinterpret_cast<const char*>(data.data()), data.size(), baseDir);
+    }
+
+    if(!fileLoaded)
+    {
+        std::cout << error << std::endl;
+    }
+    return fileLoaded;
+}
+
+// Every level of detail has about half the triangles of the previous one, until the subset gets this small.
+constexpr uint32_t LOD_MAX_LEVELS    = 4;
+constexpr uint32_t LOD_MIN_TRIANGLES = 64;
+// A level removing less than this share of the previous one's triangles is not worth its indices.
+constexpr float    LOD_MIN_REDUCTION = 0.2f;
+// Largest cost of a single collapse and cost of attribute differences, relative to the radius of the subset.
+constexpr float    LOD_MAX_RELATIVE_ERROR   = 0.1f;
+constexpr float    LOD_RELATIVE_ATTRIB_COST = 0.01f;
+
+// Geometry of one mesh between loadNodes() and its upload into the scene's buffers. Indices are relative to the
+// first vertex of the mesh, counted in elements.
+struct MeshGeometry
+{
+    std::shared_ptr<Mesh> mesh     = {};
+    std::string           name     = {};
+    std::vector<Vertex>   vertices = {};
+    std::vector<uint32_t> indices  = {};
+};
+
+void generateLods(Mesh* pMesh, std::span<const Vertex> vertices, std::vector<uint32_t>& indices)
+{
+    APH_PROFILE_FUNCTION();
+    std::vector<std::vector<uint32_t>> lodIndices(pMesh->m_subsets.size());
+    parallelFor(0, pMesh->m_subsets.size(), [&](size_t subsetIdx) {
+        auto& subset = pMesh->m_subsets[subsetIdx];
+        if(!subset.isTriangleList() || !subset.bounds.isValid())
+        {
+            return;
+        }
+        float           radius = glm::length(subset.bounds.getExtent());
+        SimplifyOptions options{
+            .maxError     = radius * LOD_MAX_RELATIVE_ERROR,
+            .normalWeight = radius * LOD_RELATIVE_ATTRIB_COST,
+            .uvWeight     = radius * LOD_RELATIVE_ATTRIB_COST,
+        };
+
+        // Each level simplifies the previous one, so its error is estimated by the sum of theirs.
+        std::vector<uint32_t> current(&indices[subset.firstIndex], &indices[subset.firstIndex] + subset.indexCount);
+        float                 error = 0.0f;
+        for(uint32_t level = 0; level < LOD_MAX_LEVELS && current.size() / 6 >= LOD_MIN_TRIANGLES; ++level)
+        {
+            options.targetIndexCount = current.size() / 6 * 3;
+            float                 levelError;
+            std::vector<uint32_t> simplified = simplifyMesh(vertices, current, options, &levelError);
+            if(simplified.size() > current.size() * (1.0f - LOD_MIN_REDUCTION))
+            {
+                break;
+            }
+            error += levelError;
+            subset.lods.push_back({ .firstIndex = static_cast<ResourceIndex>(lodIndices[subsetIdx].size()),
+                                    .indexCount = static_cast<ResourceIndex>(simplified.size()),
+                                    .error      = error });
+            lodIndices[subsetIdx].insert(lodIndices[subsetIdx].end(), simplified.begin(), simplified.end());
+            current = std::move(simplified);
+        }
+    });
+
+    for(size_t subsetIdx = 0; subsetIdx < pMesh->m_subsets.size(); ++subsetIdx)
+    {
+        for(auto& lod : pMesh->m_subsets[subsetIdx].lods)
+        {
+            lod.firstIndex += static_cast<ResourceIndex>(indices.size());
+        }
+        indices.insert(indices.end(), lodIndices[subsetIdx].begin(), lodIndices[subsetIdx].end());
+    }
+}
+
+// Welds the vertices of the mesh, builds its levels of detail, orders the triangles of every subset and level for
+// the vertex cache and then for overdraw, and finally the vertices in order of first use. Other topologies than
+// triangle lists keep their order. Logs the cache statistics of the full detail triangle lists before and after.
+void optimizeMesh(MeshGeometry& geometry)
+{
+    APH_PROFILE_FUNCTION();
+    Mesh* pMesh         = geometry.mesh.get();
+    auto  getCacheStats = [&]() {
+        VertexCacheStats stats{};
+        for(const auto& subset : pMesh->m_subsets)
+        {
+            if(subset.isTriangleList())
+            {
+                stats += analyzeVertexCache({ geometry.indices.data() + subset.firstIndex, size_t(subset.indexCount) });
+            }
+        }
+        return stats;
+    };
+    size_t           vertexCount = geometry.vertices.size();
+    VertexCacheStats before      = getCacheStats();
+
+    std::vector<uint32_t> remap;
+    size_t                weldedCount = generateWeldRemap(geometry.vertices, remap);
+    remapMesh(geometry.vertices, geometry.indices, remap, weldedCount);
+
+    generateLods(pMesh, geometry.vertices, geometry.indices);
+
+    parallelFor(0, pMesh->m_subsets.size(), [&](size_t subsetIdx) {
+        const auto& subset = pMesh->m_subsets[subsetIdx];
+        if(!subset.isTriangleList())
+        {
+            return;
+        }
+        auto optimize = [&](ResourceIndex firstIndex, ResourceIndex indexCount) {
+            std::span<uint32_t> indices{ geometry.indices.data() + firstIndex, size_t(indexCount) };
+            optimizeVertexCache(indices, geometry.vertices.size());
+            optimizeOverdraw(indices, geometry.vertices);
+        };
+        optimize(subset.firstIndex, subset.indexCount);
+        for(const auto& lod : subset.lods)
+        {
+            optimize(lod.firstIndex, lod.indexCount);
+        }
+    });
+
+    size_t usedCount = generateFetchRemap(geometry.indices, geometry.vertices.size(), remap);
+    remapMesh(geometry.vertices, geometry.indices, remap, usedCount);
+    for(auto& subset : pMesh->m_subsets)
+    {
+        const uint32_t* pFirst = geometry.indices.data() + subset.firstIndex;
+        auto [first, last]     = std::minmax_element(pFirst, pFirst + subset.indexCount);
+        subset.firstVertex = subset.indexCount > 0 ? *first : 0;
+        subset.vertexCount = subset.indexCount > 0 ? *last - *first + 1 : 0;
+    }
+
+    VertexCacheStats after = getCacheStats();
+    LOG_ASYNC_INFO("mesh '{}': {} -> {} vertices, ACMR {} -> {}, ATVR {} -> {}", geometry.name, vertexCount,
+                   geometry.vertices.size(), before.getAcmr(), after.getAcmr(), before.getAtvr(), after.getAtvr());
+}
+
+// Appends the mesh to the scene's buffers, with 16 bit indices whenever its vertices fit. The index buffer is padded
+// to the element size so the offset can be counted in elements.
+void uploadMesh(const MeshGeometry& geometry, std::vector<uint8_t>& verticesList, std::vector<uint8_t>& indicesList)
+{
+    const auto& indices = geometry.indices;
+    auto        indexType{ geometry.vertices.size() <= 1 << 16 ? IndexType::UINT16 : IndexType::UINT32 };
+    size_t      indexSize{ indexType == IndexType::UINT16 ? sizeof(uint16_t) : sizeof(uint32_t) };
+    indicesList.resize((indicesList.size() + indexSize - 1) / indexSize * indexSize);
+
+    geometry.mesh->m_indexType   = indexType;
+    geometry.mesh->m_indexOffset = indicesList.size() / indexSize;
+    // TODO variable vertex form
+    geometry.mesh->m_vertexOffset = verticesList.size() / sizeof(Vertex);
+
+    size_t indexStart = indicesList.size();
+    indicesList.resize(indexStart + indices.size() * indexSize);
+    uint8_t* indexDst = &indicesList[indexStart];
+    parallelFor(
+        0, indices.size(),
+        [&](size_t index) {
+            if(indexType == IndexType::UINT16)
+            {
+                auto value = static_cast<uint16_t>(indices[index]);
+                memcpy(indexDst + index * sizeof(value), &value, sizeof(value));
+            }
+            else { memcpy(indexDst + index * sizeof(uint32_t), &indices[index], sizeof(uint32_t)); }
+        },
+        INDEX_GRAIN_SIZE);
+    const auto* pVertexData = reinterpret_cast<const uint8_t*>(geometry.vertices.data());
+    verticesList.insert(verticesList.cend(), pVertexData, pVertexData + geometry.vertices.size() * sizeof(Vertex));
+}
+
+void loadNodes(Scene* pScene, std::vector<MeshGeometry>& geometries, const tinygltf::Node& inputNode,
                const tinygltf::Model& input, const std::shared_ptr<SceneNode>& parent, uint32_t materialOffset)
 {
     glm::mat4 matrix{ 1.0f };
@@ -122,13 +387,13 @@ void loadNodes(std::vector<uint8_t>& verticesList, std::vector<uint8_t>& indices
     // In glTF this is done via accessors and buffer views
     if(inputNode.mesh > -1)
     {
-        auto mesh{ Object::Create<Mesh>() };
+        auto mesh{ pScene->createMesh() };
         node->attachObject<Mesh>(mesh);
 
         const tinygltf::Mesh gltfMesh{ input.meshes[inputNode.mesh] };
-        std::vector<uint8_t> indices;
-        std::vector<uint8_t> vertices;
-        auto                 indexType{ IndexType::UINT16 };
+        MeshGeometry&        geometry = geometries.emplace_back(MeshGeometry{ .mesh = mesh, .name = gltfMesh.name });
+        auto&                indices  = geometry.indices;
+        auto&                vertices = geometry.vertices;
 
         // Iterate through all primitives of this node's mesh
         for(const auto& glTFPrimitive : gltfMesh.primitives)
@@ -137,6 +402,7 @@ void loadNodes(std::vector<uint8_t>& verticesList, std::vector<uint8_t>& indices
             auto vertexStart{ static_cast<int32_t>(vertices.size()) };
             auto indexCount{ static_cast<int32_t>(0) };
             auto vertexCount{ 0 };
+            AABB bounds{};
 
             // Vertices
             {
@@ -154,6 +420,25 @@ void loadNodes(std::vector<uint8_t>& verticesList, std::vector<uint8_t>& indices
                     positionBuffer                   = reinterpret_cast<const float*>(
                         &(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
                     vertexCount = accessor.count;
+                    // Required by the spec for positions, computed for files that leave them out anyway.
+                    if(accessor.minValues.size() == 3 && accessor.maxValues.size() == 3)
+                    {
+                        bounds = { glm::make_vec3(accessor.minValues.data()),
+                                   glm::make_vec3(accessor.maxValues.data()) };
+                    }
+                    else
+                    {
+                        bounds = parallelReduce(
+                            0, vertexCount, AABB{},
+                            [&](size_t begin, size_t end, AABB partial) {
+                                for(size_t v = begin; v < end; ++v)
+                                {
+                                    partial.merge(glm::make_vec3(&positionBuffer[v * 3]));
+                                }
+                                return partial;
+                            },
+                            [](AABB a, const AABB& b) { return AABB::Merge(a, b); }, VERTEX_GRAIN_SIZE);
+                    }
                 }
                 // Get buffer data for vertex normals
                 if(glTFPrimitive.attributes.find("NORMAL") != glTFPrimitive.attributes.end())
@@ -184,55 +469,58 @@ void loadNodes(std::vector<uint8_t>& verticesList, std::vector<uint8_t>& indices
                 }
 
                 // Append data to model's vertex buffer
-                for(size_t v = 0; v < vertexCount; v++)
-                {
-                    Vertex vert{};
-                    vert.pos    = glm::vec4(glm::make_vec3(&positionBuffer[v * 3]), 1.0f);
-                    vert.normal = glm::normalize(
-                        glm::vec3(normalsBuffer ? glm::make_vec3(&normalsBuffer[v * 3]) : glm::vec3(0.0f)));
-                    vert.uv      = texCoordsBuffer ? glm::make_vec2(&texCoordsBuffer[v * 2]) : glm::vec3(0.0f);
-                    vert.color   = glm::vec3(1.0f);
-                    vert.tangent = tangentsBuffer ? glm::make_vec4(&tangentsBuffer[v * 4]) : glm::vec4(0.0f);
-                    uint8_t* ptr = reinterpret_cast<uint8_t*>(&vert);
-                    std::copy(ptr, ptr + sizeof(vert), back_inserter(vertices));
-                }
+                vertices.resize(vertices.size() + vertexCount);
+                Vertex* vertexDst = &vertices[vertexStart];
+                parallelFor(
+                    0, vertexCount,
+                    [&](size_t v) {
+                        Vertex vert{};
+                        vert.pos    = glm::vec4(glm::make_vec3(&positionBuffer[v * 3]), 1.0f);
+                        vert.normal = glm::normalize(
+                            glm::vec3(normalsBuffer ? glm::make_vec3(&normalsBuffer[v * 3]) : glm::vec3(0.0f)));
+                        vert.uv      = texCoordsBuffer ? glm::make_vec2(&texCoordsBuffer[v * 2]) : glm::vec3(0.0f);
+                        vert.color   = glm::vec3(1.0f);
+                        vert.tangent = tangentsBuffer ? glm::make_vec4(&tangentsBuffer[v * 4]) : glm::vec4(0.0f);
+                        vertexDst[v] = vert;
+                    },
+                    VERTEX_GRAIN_SIZE);
             }
             // Indices
+            if(glTFPrimitive.indices > -1)
             {
                 const tinygltf::Accessor&   accessor   = input.accessors[glTFPrimitive.indices];
                 const tinygltf::BufferView& bufferView = input.bufferViews[accessor.bufferView];
                 const tinygltf::Buffer&     buffer     = input.buffers[bufferView.buffer];
+                const uint8_t*              pSrc       = &buffer.data[accessor.byteOffset + bufferView.byteOffset];
 
                 indexCount += static_cast<uint32_t>(accessor.count);
 
                 // glTF supports different component types of indices
-                uint32_t idxOffset{ static_cast<uint32_t>(indices.size()) };
+                indices.resize(indices.size() + accessor.count);
+                uint32_t* dataPtr = &indices[firstIndex];
                 switch(accessor.componentType)
                 {
                 case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT:
                 {
-                    indices.resize(indices.size() + accessor.count * 4);
-                    auto* dataPtr = reinterpret_cast<uint32_t*>(&indices[idxOffset]);
-                    indexType     = IndexType::UINT32;
-                    const auto* buf =
-                        reinterpret_cast<const uint32_t*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-                    for(size_t index = 0; index < accessor.count; index++)
-                    {
-                        dataPtr[index] = buf[index] + vertexStart;
-                    }
+                    const auto* buf = reinterpret_cast<const uint32_t*>(pSrc);
+                    parallelFor(
+                        0, accessor.count, [&](size_t index) { dataPtr[index] = buf[index] + vertexStart; },
+                        INDEX_GRAIN_SIZE);
                     break;
                 }
                 case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT:
                 {
-                    indices.resize(indices.size() + accessor.count * 2);
-                    auto* dataPtr = reinterpret_cast<uint16_t*>(&indices[idxOffset]);
-                    indexType     = IndexType::UINT16;
-                    const auto* buf =
-                        reinterpret_cast<const uint16_t*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-                    for(size_t index = 0; index < accessor.count; index++)
-                    {
-                        dataPtr[index] = buf[index] + vertexStart;
-                    }
+                    const auto* buf = reinterpret_cast<const uint16_t*>(pSrc);
+                    parallelFor(
+                        0, accessor.count, [&](size_t index) { dataPtr[index] = buf[index] + vertexStart; },
+                        INDEX_GRAIN_SIZE);
+                    break;
+                }
+                case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE:
+                {
+                    parallelFor(
+                        0, accessor.count, [&](size_t index) { dataPtr[index] = pSrc[index] + vertexStart; },
+                        INDEX_GRAIN_SIZE);
                     break;
                 }
                 default:
@@ -240,6 +528,22 @@ void loadNodes(std::vector<uint8_t>& verticesList, std::vector<uint8_t>& indices
                     return;
                 }
             }
+            // Non-indexed primitives get a trivial index list, so all triangle lists are optimized and drawn alike.
+            else
+            {
+                indexCount = vertexCount;
+                indices.resize(indices.size() + vertexCount);
+                std::iota(indices.begin() + firstIndex, indices.end(), vertexStart);
+            }
+
+            // Strips and fans are simplified, reordered and drawn like every other triangle list.
+            PrimitiveTopology topology = getTopology(glTFPrimitive.mode);
+            if(topology == PrimitiveTopology::TRI_STRIP || topology == PrimitiveTopology::TRI_FAN)
+            {
+                convertToTriangleList(topology, indices, firstIndex);
+                indexCount = static_cast<int32_t>(indices.size()) - firstIndex;
+                topology   = PrimitiveTopology::TRI_LIST;
+            }
 
             mesh->m_subsets.push_back(Mesh::Subset{
                 .firstIndex    = firstIndex,
@@ -248,30 +552,10 @@ void loadNodes(std::vector<uint8_t>& verticesList, std::vector<uint8_t>& indices
                 .indexCount    = indexCount,
                 .materialIndex = static_cast<ResourceIndex>(glTFPrimitive.material + materialOffset),
                 .hasIndices    = indexCount > 0,
+                .topology      = topology,
+                .bounds        = bounds,
             });
-        }
-
-        static float indexSizeScaling = 1.0f;
-
-        mesh->m_indexType   = indexType;
-        mesh->m_indexOffset = indicesList.size() * indexSizeScaling;
-        // TODO variable vertex form
-        mesh->m_vertexOffset = verticesList.size() / sizeof(Vertex);
-
-        indicesList.insert(indicesList.cend(), indices.cbegin(), indices.cend());
-        verticesList.insert(verticesList.cend(), vertices.cbegin(), vertices.cend());
-
-        switch(indexType)
-        {
-        case IndexType::UINT16:
-            indexSizeScaling = 0.5f;
-            break;
-        case IndexType::UINT32:
-            indexSizeScaling = 0.25f;
-            break;
-        default:
-            indexSizeScaling = 1.0f;
-            break;
+            mesh->m_bounds.merge(bounds);
         }
     }
 
@@ -280,7 +564,7 @@ void loadNodes(std::vector<uint8_t>& verticesList, std::vector<uint8_t>& indices
     {
         for(const int nodeIdx : inputNode.children)
         {
-            loadNodes(verticesList, indicesList, input.nodes[nodeIdx], input, node, materialOffset);
+            loadNodes(pScene, geometries, input.nodes[nodeIdx], input, node, materialOffset);
         }
     }
 }
@@ -296,7 +580,7 @@ std::unique_ptr<Scene> Scene::Create(SceneType type)
     case SceneType::DEFAULT:
     {
         auto instance{ std::unique_ptr<Scene>(new Scene()) };
-        instance->m_rootNode = std::make_shared<SceneNode>(nullptr);
+        instance->m_rootNode = Object::Create<SceneNode>(nullptr);
         return instance;
     }
     default:
@@ -307,32 +591,134 @@ std::unique_ptr<Scene> Scene::Create(SceneType type)
     }
 }
 
+Scene::~Scene()
+{
+    // Nodes still referenced elsewhere outlive the BVH, their proxies go away with it.
+    std::vector<SceneNode*> stack;
+    if(m_rootNode)
+    {
+        stack.push_back(m_rootNode.get());
+    }
+    while(!stack.empty())
+    {
+        SceneNode* pNode = stack.back();
+        stack.pop_back();
+        pNode->m_pBvh = nullptr;
+        for(const auto& child : pNode->getChildren())
+        {
+            stack.push_back(child.get());
+        }
+    }
+}
+
 std::shared_ptr<Camera> Scene::createCamera(float aspectRatio)
 {
+    AllocationScope allocationScope(AllocationTag::SCENE);
     auto camera = Object::Create<Camera>();
     camera->setAspectRatio(aspectRatio);
-    m_cameras[camera->getId()] = camera;
-    return camera;
+    return addObject(m_cameras, std::move(camera));
 }
 
 std::shared_ptr<Light> Scene::createLight()
 {
-    auto light               = Object::Create<Light>();
-    m_lights[light->getId()] = light;
-    return light;
+    AllocationScope allocationScope(AllocationTag::SCENE);
+    return addObject(m_lights, Object::Create<Light>());
 }
 
 std::shared_ptr<Mesh> Scene::createMesh()
 {
-    auto mesh               = Object::Create<Mesh>();
-    m_meshes[mesh->getId()] = mesh;
-    return mesh;
+    AllocationScope allocationScope(AllocationTag::SCENE);
+    return addObject(m_meshes, Object::Create<Mesh>());
+}
+
+void Scene::updateTransforms()
+{
+    APH_PROFILE_FUNCTION();
+    m_rootNode->updateTransforms();
+    for(SceneNode* pNode : m_rootNode->getChangedNodes())
+    {
+        // New nodes are reported as changed by their first update, and so are nodes an object was attached to since.
+        if(pNode->getAttachType() != ObjectType::MESH)
+        {
+            if(pNode->m_boundsProxy != BVH::INVALID_INDEX)
+            {
+                m_bvh.destroyProxy(pNode->m_boundsProxy);
+                pNode->m_boundsProxy = BVH::INVALID_INDEX;
+                pNode->m_pBvh        = nullptr;
+            }
+            continue;
+        }
+        AABB bounds = pNode->getObject<Mesh>()->m_bounds.transform(pNode->getTransform());
+        if(pNode->m_boundsProxy == BVH::INVALID_INDEX)
+        {
+            pNode->m_boundsProxy = m_bvh.createProxy(bounds, pNode);
+            pNode->m_pBvh        = &m_bvh;
+        }
+        else
+        {
+            m_bvh.moveProxy(pNode->m_boundsProxy, bounds);
+        }
+    }
+    m_bvh.refit();
+}
+
+std::shared_ptr<Light> Scene::getLightWithId(IdType id) const
+{
+    return findObject(m_lights, id);
+}
+
+std::shared_ptr<Camera> Scene::getCameraWithId(IdType id) const
+{
+    return findObject(m_cameras, id);
+}
+
+std::shared_ptr<Mesh> Scene::getMeshWithId(IdType id) const
+{
+    return findObject(m_meshes, id);
+}
+
+bool Scene::destroyLight(IdType id)
+{
+    return removeObject(m_lights, id);
+}
+
+bool Scene::destroyCamera(IdType id)
+{
+    return removeObject(m_cameras, id);
+}
+
+bool Scene::destroyMesh(IdType id)
+{
+    return removeObject(m_meshes, id);
+}
+
+template <typename TObject>
+std::shared_ptr<TObject> Scene::addObject(ObjectMap<TObject>& objects, std::shared_ptr<TObject> object)
+{
+    LockGuard<AdaptiveMutex> lock(m_objectLock);
+    object->_setId(objects.insert(object).pack());
+    return object;
+}
+
+template <typename TObject>
+std::shared_ptr<TObject> Scene::findObject(const ObjectMap<TObject>& objects, IdType id) const
+{
+    const auto* pObject = objects.get(ObjectMap<TObject>::Handle::Unpack(id));
+    return pObject ? *pObject : nullptr;
+}
+
+template <typename TObject>
+bool Scene::removeObject(ObjectMap<TObject>& objects, IdType id)
+{
+    LockGuard<AdaptiveMutex> lock(m_objectLock);
+    return objects.erase(ObjectMap<TObject>::Handle::Unpack(id));
 }
 
 std::shared_ptr<SceneNode> Scene::createMeshesFromFile(const std::string&                path,
                                                        const std::shared_ptr<SceneNode>& parent)
 {
-    auto node = parent ? parent->createChildNode() : m_rootNode->createChildNode();
+    APH_PROFILE_FUNCTION();
+    AllocationScope allocationScope(AllocationTag::IMPORT);
 
     tinygltf::Model    inputModel;
     tinygltf::TinyGLTF gltfContext;
@@ -348,33 +734,65 @@ std::shared_ptr<SceneNode> Scene::createMeshesFromFile(const std::string&
         fileLoaded = gltfContext.LoadASCIIFromFile(&inputModel, &error, &warning, path);
     }
 
-    if(fileLoaded)
-    {
-        const uint32_t                          imageOffset    = m_images.size();
-        const uint32_t                          materialOffset = m_materials.size();
-        std::vector<std::shared_ptr<ImageInfo>> images;
-        std::vector<Material>                   materials;
-        gltf::loadImages(images, inputModel);
-        gltf::loadMaterials(materials, inputModel, imageOffset);
-        m_images.insert(m_images.cend(), std::make_move_iterator(images.cbegin()),
-                        std::make_move_iterator(images.cend()));
-        m_materials.insert(m_materials.cend(), std::make_move_iterator(materials.cbegin()),
-                           std::make_move_iterator(materials.cend()));
-
-        const tinygltf::Scene& scene = inputModel.scenes[0];
-        for(int nodeIdx : scene.nodes)
-        {
-            const tinygltf::Node inputNode = inputModel.nodes[nodeIdx];
-            gltf::loadNodes(m_vertices, m_indices, inputNode, inputModel, node, materialOffset);
-        }
-    }
-    else
+    if(!fileLoaded)
     {
         std::cout << error << std::endl;
         assert("Could not open the glTF file.");
         return {};
     }
 
+    return createMeshesFromModel(inputModel, parent);
+}
+
+Task<std::shared_ptr<tinygltf::Model>> Scene::LoadModelAsync(std::string path)
+{
+    // Resumes on a worker, parsing and image decoding below stay off the calling thread.
+    auto data = co_await readFileAsync(path);
+
+    // Only covers the part of the import running on this worker, the scope must not outlive a suspension.
+    APH_PROFILE_SCOPE("LoadModelAsync");
+    AllocationScope allocationScope(AllocationTag::IMPORT);
+
+    auto model = std::make_shared<tinygltf::Model>();
+    if(data.empty() || !gltf::loadModelFromMemory(*model, path, data))
+    {
+        co_return nullptr;
+    }
+    co_return model;
+}
+
+std::shared_ptr<SceneNode> Scene::createMeshesFromModel(tinygltf::Model&                  inputModel,
+                                                        const std::shared_ptr<SceneNode>& parent)
+{
+    APH_PROFILE_FUNCTION();
+    AllocationScope allocationScope(AllocationTag::IMPORT);
+    auto node = parent ? parent->createChildNode() : m_rootNode->createChildNode();
+
+    const uint32_t                          imageOffset    = m_images.size();
+    const uint32_t                          materialOffset = m_materials.size();
+    std::vector<std::shared_ptr<ImageInfo>> images;
+    std::vector<Material>                   materials;
+    gltf::loadImages(images, inputModel);
+    gltf::loadMaterials(materials, inputModel, imageOffset);
+    m_images.insert(m_images.cend(), std::make_move_iterator(images.cbegin()), std::make_move_iterator(images.cend()));
+    m_materials.insert(m_materials.cend(), std::make_move_iterator(materials.cbegin()),
+                       std::make_move_iterator(materials.cend()));
+
+    const tinygltf::Scene&         scene = inputModel.scenes[0];
+    std::vector<gltf::MeshGeometry> geometries;
+    for(int nodeIdx : scene.nodes)
+    {
+        const tinygltf::Node inputNode = inputModel.nodes[nodeIdx];
+        gltf::loadNodes(this, geometries, inputNode, inputModel, node, materialOffset);
+    }
+
+    // One task per mesh, each one also spreads its subsets over the pool.
+    parallelFor(0, geometries.size(), [&geometries](size_t idx) { gltf::optimizeMesh(geometries[idx]); }, 1);
+    for(const auto& geometry : geometries)
+    {
+        gltf::uploadMesh(geometry, m_vertices, m_indices);
+    }
+
     return node;
 }
 }  // namespace aph
@@ -2,6 +2,14 @@
 #define VKLSCENEMANGER_H_
 
 #include "node.h"
+#include "bvh.h"
+#include "common/slotMap.h"
+#include "common/task.h"
+
+namespace tinygltf
+{
+class Model;
+}
 
 namespace aph
 {
@@ -10,12 +18,6 @@ enum class ShadingModel
     PBR,
 };
 
-struct AABB
-{
-    glm::vec3 min = {};
-    glm::vec3 max = {};
-};
-
 enum class SceneType
 {
     DEFAULT,
@@ -28,12 +30,19 @@ private:
 
 public:
     static std::unique_ptr<Scene> Create(SceneType type);
+    ~Scene();
 
     std::shared_ptr<Mesh>      createMesh();
     std::shared_ptr<Light>     createLight();
     std::shared_ptr<Camera>    createCamera(float aspectRatio);
     std::shared_ptr<SceneNode> createMeshesFromFile(const std::string&                path,
                                                     const std::shared_ptr<SceneNode>& parent = nullptr);
+    // Adds a model parsed by LoadModelAsync(), on the thread that owns the scene.
+    std::shared_ptr<SceneNode> createMeshesFromModel(tinygltf::Model&                  model,
+                                                     const std::shared_ptr<SceneNode>& parent = nullptr);
+
+    // Reads and parses a glTF file on the thread pool without touching any scene, null if it could not be loaded.
+    static Task<std::shared_ptr<tinygltf::Model>> LoadModelAsync(std::string path);
 
     void                    setAmbient(glm::vec3 value) { m_ambient = value; }
     void                    setMainCamera(const std::shared_ptr<Camera>& camera) { m_camera = camera; }
@@ -41,9 +50,27 @@ public:
 
     std::shared_ptr<SceneNode> getRootNode() { return m_rootNode; }
 
-    std::shared_ptr<Light>  getLightWithId(IdType id) { return m_lights[id]; }
-    std::shared_ptr<Camera> getCameraWithId(IdType id) { return m_cameras[id]; }
-    std::shared_ptr<Mesh>   getMeshWithId(IdType id) { return m_meshes[id]; }
+    // Once per frame: updates the world transforms of the node tree, then the world bounds of the mesh nodes that
+    // moved in the BVH.
+    void updateTransforms();
+    // World bounds of the mesh nodes, as of the last updateTransforms(). Query results are SceneNode objects.
+    const BVH& getBVH() const { return m_bvh; }
+    AABB       getBounds() const { return m_bvh.getBounds(); }
+
+    // Objects created by the scene are identified by their handle in it: getId() returns the handle, lookups of a
+    // destroyed object return null. Creating and destroying is thread safe, lookups and iteration must not race with
+    // either.
+    std::shared_ptr<Light>  getLightWithId(IdType id) const;
+    std::shared_ptr<Camera> getCameraWithId(IdType id) const;
+    std::shared_ptr<Mesh>   getMeshWithId(IdType id) const;
+    bool                    destroyLight(IdType id);
+    bool                    destroyCamera(IdType id);
+    bool                    destroyMesh(IdType id);
+
+    // Densely packed, in no particular order.
+    std::span<const std::shared_ptr<Light>>  getLights() const { return m_lights.getValues(); }
+    std::span<const std::shared_ptr<Camera>> getCameras() const { return m_cameras.getValues(); }
+    std::span<const std::shared_ptr<Mesh>>   getMeshes() const { return m_meshes.getValues(); }
 
     std::vector<uint8_t>                    getIndices() const { return m_indices; }
     std::vector<uint8_t>                    getVertices() const { return m_vertices; }
@@ -53,8 +80,19 @@ public:
     glm::vec3 getAmbient() { return m_ambient; }
 
 private:
-    AABB      m_aabb    = {};
+    template <typename TObject>
+    using ObjectMap = SlotMap<std::shared_ptr<TObject>>;
+
+    template <typename TObject>
+    std::shared_ptr<TObject> addObject(ObjectMap<TObject>& objects, std::shared_ptr<TObject> object);
+    template <typename TObject>
+    std::shared_ptr<TObject> findObject(const ObjectMap<TObject>& objects, IdType id) const;
+    template <typename TObject>
+    bool removeObject(ObjectMap<TObject>& objects, IdType id);
+
+private:
     glm::vec3 m_ambient = { 0.02f, 0.02f, 0.02f };
+    BVH       m_bvh     = {};
 
     std::shared_ptr<SceneNode> m_rootNode = {};
     std::shared_ptr<Camera>    m_camera   = {};
@@ -62,9 +100,10 @@ private:
     std::vector<uint8_t> m_indices  = {};
     std::vector<uint8_t> m_vertices = {};
 
-    std::unordered_map<IdType, std::shared_ptr<Camera>> m_cameras = {};
-    std::unordered_map<IdType, std::shared_ptr<Light>>  m_lights  = {};
-    std::unordered_map<IdType, std::shared_ptr<Mesh>>   m_meshes  = {};
+    ObjectMap<Camera> m_cameras    = {};
+    ObjectMap<Light>  m_lights     = {};
+    ObjectMap<Mesh>   m_meshes     = {};
+    AdaptiveMutex     m_objectLock = {};
 
     std::vector<std::shared_ptr<ImageInfo>> m_images    = {};
     std::vector<Material>                   m_materials = {};
@@ -0,0 +1,365 @@
+#include "transformHierarchy.h"
+
+#include "common/parallel.h"
+
+namespace aph
+{
+// Entries per parallel chunk, each one is a local matrix composition and a matrix multiply.
+constexpr size_t TRANSFORM_GRAIN_SIZE = 256;
+// Largest difference, relative to the largest axis, between a matrix passed to add() and its translation, rotation
+// and scale recomposed, above which the matrix is kept as is.
+constexpr float DECOMPOSE_TOLERANCE = 1e-5f;
+
+namespace
+{
+// result = a * b, column by column: every column of the result is a linear combination of the columns of a.
+inline void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& result)
+{
+#if defined(__SSE__) || defined(_M_X64)
+    const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+    const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+    const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+    const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+    for(int col = 0; col < 4; ++col)
+    {
+        __m128 column = _mm_mul_ps(a0, _mm_set1_ps(b[col][0]));
+        column        = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(b[col][1])));
+        column        = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(b[col][2])));
+        column        = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(b[col][3])));
+        _mm_storeu_ps(&result[col][0], column);
+    }
+#else
+    result = a * b;
+#endif
+}
+}  // namespace
+
+TransformHierarchy::Handle TransformHierarchy::add(Handle parent, const glm::mat4& local, Object* pOwner)
+{
+    Handle handle = m_slots.size();
+    if(!m_freeHandles.empty())
+    {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    }
+    else
+    {
+        m_slots.push_back(INVALID_INDEX);
+    }
+
+    // Appending keeps every parent in front of its children, update() only has to re-sort to rebuild the levels.
+    uint32_t slot       = m_parents.size();
+    uint32_t parentSlot = parent == INVALID_INDEX ? INVALID_INDEX : m_slots[parent];
+    m_slots[handle]     = slot;
+    m_handles.push_back(handle);
+    m_parents.push_back(parentSlot);
+    m_depths.push_back(parentSlot == INVALID_INDEX ? 0 : m_depths[parentSlot] + 1);
+
+    glm::vec3 scale{ glm::length(glm::vec3(local[0])), glm::length(glm::vec3(local[1])),
+                     glm::length(glm::vec3(local[2])) };
+    if(glm::determinant(glm::mat3(local)) < 0.0f)
+    {
+        scale.x = -scale.x;
+    }
+    glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+    if(scale.x != 0.0f && scale.y != 0.0f && scale.z != 0.0f)
+    {
+        rotation = glm::quat_cast(
+            glm::mat3(glm::vec3(local[0]) / scale.x, glm::vec3(local[1]) / scale.y, glm::vec3(local[2]) / scale.z));
+    }
+    m_translations.push_back(glm::vec3(local[3]));
+    m_rotations.push_back(rotation);
+    m_scales.push_back(scale);
+    m_matrixIndices.push_back(INVALID_INDEX);
+
+    // Shear, or a degenerate axis, does not survive the decomposition.
+    glm::mat4 recomposed = getLocalMatrix(slot);
+    float     tolerance  = DECOMPOSE_TOLERANCE * std::max({ std::abs(scale.x), std::abs(scale.y), std::abs(scale.z) });
+    for(int col = 0; col < 3; ++col)
+    {
+        if(glm::any(glm::greaterThan(glm::abs(glm::vec3(recomposed[col]) - glm::vec3(local[col])),
+                                     glm::vec3(tolerance))))
+        {
+            setLocalMatrix(slot, local);
+            break;
+        }
+    }
+
+    m_worlds.push_back(glm::mat4(1.0f));
+    m_dirty.push_back(0);
+    m_removed.push_back(0);
+    m_owners.push_back(pOwner);
+    setDirty(slot);
+    m_unsorted = true;
+    return handle;
+}
+
+void TransformHierarchy::remove(Handle handle)
+{
+    // The slot is dropped and its children detached by the next sort().
+    uint32_t slot   = m_slots[handle];
+    if(m_matrixIndices[slot] != INVALID_INDEX)
+    {
+        m_freeMatrices.push_back(m_matrixIndices[slot]);
+        m_matrixIndices[slot] = INVALID_INDEX;
+    }
+    m_removed[slot] = 1;
+    m_owners[slot]  = nullptr;
+    m_slots[handle] = INVALID_INDEX;
+    m_unsorted      = true;
+    m_freeHandles.push_back(handle);
+}
+
+glm::mat4 TransformHierarchy::getLocal(Handle handle) const
+{
+    return getLocalMatrix(m_slots[handle]);
+}
+
+void TransformHierarchy::translate(Handle handle, glm::vec3 value)
+{
+    uint32_t slot = m_slots[handle];
+    if(m_matrixIndices[slot] != INVALID_INDEX)
+    {
+        glm::mat4& matrix = m_matrices[m_matrixIndices[slot]];
+        matrix            = glm::translate(matrix, value);
+    }
+    else
+    {
+        m_translations[slot] += m_rotations[slot] * (m_scales[slot] * value);
+    }
+    setDirty(slot);
+}
+
+void TransformHierarchy::rotate(Handle handle, float angle, glm::vec3 axis)
+{
+    uint32_t         slot  = m_slots[handle];
+    const glm::vec3& scale = m_scales[slot];
+    if(m_matrixIndices[slot] != INVALID_INDEX)
+    {
+        glm::mat4& matrix = m_matrices[m_matrixIndices[slot]];
+        matrix            = glm::rotate(matrix, angle, axis);
+    }
+    else if(scale.x == scale.y && scale.y == scale.z)
+    {
+        // A uniform scale commutes with the rotation, so composing the quaternions is exact.
+        m_rotations[slot] = glm::normalize(m_rotations[slot] * glm::angleAxis(angle, glm::normalize(axis)));
+    }
+    else
+    {
+        // Rotated after a non-uniform scale the local transform gets shear, it becomes a plain matrix from here on.
+        setLocalMatrix(slot, glm::rotate(getLocalMatrix(slot), angle, axis));
+    }
+    setDirty(slot);
+}
+
+void TransformHierarchy::scale(Handle handle, glm::vec3 value)
+{
+    uint32_t slot = m_slots[handle];
+    if(m_matrixIndices[slot] != INVALID_INDEX)
+    {
+        glm::mat4& matrix = m_matrices[m_matrixIndices[slot]];
+        matrix            = glm::scale(matrix, value);
+    }
+    else
+    {
+        m_scales[slot] *= value;
+    }
+    setDirty(slot);
+}
+
+glm::mat4 TransformHierarchy::getWorld(Handle handle) const
+{
+    uint32_t slot = m_slots[handle];
+    if(m_dirtyCount == 0 && !m_unsorted)
+    {
+        return m_worlds[slot];
+    }
+
+    // A removed parent is not detached before the next sort(), the chain ends there already.
+    glm::mat4 world = getLocalMatrix(slot);
+    for(uint32_t parent = m_parents[slot]; parent != INVALID_INDEX && !m_removed[parent]; parent = m_parents[parent])
+    {
+        world = getLocalMatrix(parent) * world;
+    }
+    return world;
+}
+
+void TransformHierarchy::update()
+{
+    if(m_unsorted)
+    {
+        sort();
+    }
+
+    m_changed.clear();
+    if(m_dirtyCount == 0)
+    {
+        return;
+    }
+
+    // Parents are one level up and final by the time a level runs, entries of the same level are independent.
+    for(size_t level = 0; level + 1 < m_levelOffsets.size(); ++level)
+    {
+        parallelForRange(
+            m_levelOffsets[level], m_levelOffsets[level + 1],
+            [this](size_t begin, size_t end) {
+                for(size_t slot = begin; slot < end; ++slot)
+                {
+                    uint32_t parent = m_parents[slot];
+                    if(!m_dirty[slot] && (parent == INVALID_INDEX || !m_dirty[parent]))
+                    {
+                        continue;
+                    }
+                    m_dirty[slot] = 1;
+                    if(parent == INVALID_INDEX)
+                    {
+                        m_worlds[slot] = getLocalMatrix(slot);
+                    }
+                    else
+                    {
+                        multiply(m_worlds[parent], getLocalMatrix(slot), m_worlds[slot]);
+                    }
+                }
+            },
+            TRANSFORM_GRAIN_SIZE);
+    }
+
+    for(uint32_t slot = 0; slot < m_dirty.size(); ++slot)
+    {
+        if(m_dirty[slot])
+        {
+            m_changed.push_back(m_owners[slot]);
+            m_dirty[slot] = 0;
+        }
+    }
+    m_dirtyCount = 0;
+}
+
+void TransformHierarchy::setDirty(uint32_t slot)
+{
+    if(!m_dirty[slot])
+    {
+        m_dirty[slot] = 1;
+        ++m_dirtyCount;
+    }
+}
+
+void TransformHierarchy::setLocalMatrix(uint32_t slot, const glm::mat4& local)
+{
+    if(m_matrixIndices[slot] == INVALID_INDEX)
+    {
+        if(m_freeMatrices.empty())
+        {
+            m_matrixIndices[slot] = m_matrices.size();
+            m_matrices.emplace_back();
+        }
+        else
+        {
+            m_matrixIndices[slot] = m_freeMatrices.back();
+            m_freeMatrices.pop_back();
+        }
+    }
+    m_matrices[m_matrixIndices[slot]] = local;
+}
+
+glm::mat4 TransformHierarchy::getLocalMatrix(uint32_t slot) const
+{
+    if(m_matrixIndices[slot] != INVALID_INDEX)
+    {
+        return m_matrices[m_matrixIndices[slot]];
+    }
+    glm::mat4 matrix = glm::mat4_cast(m_rotations[slot]);
+    matrix[0] *= m_scales[slot].x;
+    matrix[1] *= m_scales[slot].y;
+    matrix[2] *= m_scales[slot].z;
+    matrix[3] = glm::vec4(m_translations[slot], 1.0f);
+    return matrix;
+}
+
+void TransformHierarchy::sort()
+{
+    const uint32_t count = m_parents.size();
+
+    // Parents sit in front of their children, one pass settles every depth. Children of removed entries become
+    // roots, which moves them.
+    uint32_t maxDepth = 0;
+    for(uint32_t slot = 0; slot < count; ++slot)
+    {
+        if(m_removed[slot])
+        {
+            continue;
+        }
+        uint32_t parent = m_parents[slot];
+        if(parent != INVALID_INDEX && m_removed[parent])
+        {
+            m_parents[slot] = parent = INVALID_INDEX;
+            m_dirty[slot]            = 1;
+        }
+        m_depths[slot] = parent == INVALID_INDEX ? 0 : m_depths[parent] + 1;
+        maxDepth       = std::max(maxDepth, m_depths[slot]);
+    }
+
+    // Stable counting sort by depth.
+    m_levelOffsets.assign(maxDepth + 2, 0);
+    for(uint32_t slot = 0; slot < count; ++slot)
+    {
+        if(!m_removed[slot])
+        {
+            ++m_levelOffsets[m_depths[slot] + 1];
+        }
+    }
+    for(uint32_t level = 1; level < m_levelOffsets.size(); ++level)
+    {
+        m_levelOffsets[level] += m_levelOffsets[level - 1];
+    }
+
+    std::vector<uint32_t> cursors(m_levelOffsets.begin(), m_levelOffsets.end() - 1);
+    std::vector<uint32_t> newSlots(count, INVALID_INDEX);
+    for(uint32_t slot = 0; slot < count; ++slot)
+    {
+        if(!m_removed[slot])
+        {
+            newSlots[slot] = cursors[m_depths[slot]]++;
+        }
+    }
+    for(uint32_t slot = 0; slot < count; ++slot)
+    {
+        if(!m_removed[slot] && m_parents[slot] != INVALID_INDEX)
+        {
+            m_parents[slot] = newSlots[m_parents[slot]];
+        }
+    }
+
+    const uint32_t newCount = m_levelOffsets.back();
+    auto           permute  = [&](auto& values) {
+        std::remove_reference_t<decltype(values)> sorted(newCount);
+        for(uint32_t slot = 0; slot < count; ++slot)
+        {
+            if(newSlots[slot] != INVALID_INDEX)
+            {
+                sorted[newSlots[slot]] = values[slot];
+            }
+        }
+        values.swap(sorted);
+    };
+    permute(m_handles);
+    permute(m_parents);
+    permute(m_depths);
+    permute(m_translations);
+    permute(m_rotations);
+    permute(m_scales);
+    permute(m_matrixIndices);
+    permute(m_worlds);
+    permute(m_dirty);
+    permute(m_owners);
+    m_removed.assign(newCount, 0);
+
+    m_dirtyCount = 0;
+    for(uint32_t slot = 0; slot < newCount; ++slot)
+    {
+        m_slots[m_handles[slot]] = slot;
+        m_dirtyCount += m_dirty[slot];
+    }
+    m_unsorted = false;
+}
+}  // namespace aph
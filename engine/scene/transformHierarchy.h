@@ -0,0 +1,86 @@
+#ifndef TRANSFORM_HIERARCHY_H_
+#define TRANSFORM_HIERARCHY_H_
+
+#include "common/common.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+namespace aph
+{
+class Object;
+
+// Transforms of a node tree as flat arrays: parent slot, local translation, rotation and scale, and world matrix.
+// Entries are sorted by depth, so a parent always sits in a lower slot than its children and update() computes the
+// world matrices one level at a time, each level split across the thread pool.
+// Nodes keep a handle to their entry, slots move when update() re-sorts after an add() or remove().
+class TransformHierarchy
+{
+public:
+    using Handle                            = uint32_t;
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    // parent is INVALID_INDEX for a root.
+    Handle add(Handle parent, const glm::mat4& local, Object* pOwner);
+    // Children of the removed entry become roots.
+    void   remove(Handle handle);
+
+    // The local transform is stored as translation, rotation and scale. Entries that cannot be, a matrix with shear
+    // passed to add() or a rotation after a non-uniform scale, keep a full matrix instead. Either way the operations
+    // below give the same result as glm::translate(), glm::rotate() and glm::scale() on the local matrix.
+    glm::mat4 getLocal(Handle handle) const;
+    void      translate(Handle handle, glm::vec3 value);
+    void      rotate(Handle handle, float angle, glm::vec3 axis);
+    void      scale(Handle handle, glm::vec3 value);
+    // Reports the entry, and its descendants, as changed by the next update() without moving it.
+    void      markDirty(Handle handle) { setDirty(m_slots[handle]); }
+
+    // Cached once update() ran, walks the parent chain while anything is dirty.
+    glm::mat4 getWorld(Handle handle) const;
+
+    // Recomputes the world matrices of the entries that moved since the last call and of their descendants.
+    void update();
+    // Owners of the entries whose world matrix changed in the last update(), parents before children.
+    const std::vector<Object*>& getChanged() const { return m_changed; }
+
+    // Index of an entry in getWorldMatrices(), stable from one update() to the next add() or remove().
+    uint32_t                   getSlot(Handle handle) const { return m_slots[handle]; }
+    std::span<const glm::mat4> getWorldMatrices() const { return m_worlds; }
+    uint32_t                   getCount() const { return m_parents.size(); }
+
+private:
+    void      setDirty(uint32_t slot);
+    void      setLocalMatrix(uint32_t slot, const glm::mat4& local);
+    glm::mat4 getLocalMatrix(uint32_t slot) const;
+    void      sort();
+
+    // Per handle.
+    std::vector<uint32_t> m_slots;
+    std::vector<Handle>   m_freeHandles;
+
+    // Per slot.
+    std::vector<Handle>    m_handles;
+    std::vector<uint32_t>  m_parents;
+    std::vector<uint32_t>  m_depths;
+    std::vector<glm::vec3> m_translations;
+    std::vector<glm::quat> m_rotations;
+    std::vector<glm::vec3> m_scales;
+    // Into m_matrices, INVALID_INDEX for entries stored as translation, rotation and scale.
+    std::vector<uint32_t>  m_matrixIndices;
+    std::vector<glm::mat4> m_worlds;
+    std::vector<uint8_t>   m_dirty;
+    std::vector<uint8_t>   m_removed;
+    std::vector<Object*>   m_owners;
+
+    // Local matrices of the entries that do not decompose, not moved by sort().
+    std::vector<glm::mat4> m_matrices;
+    std::vector<uint32_t>  m_freeMatrices;
+
+    // First slot of every depth, plus one past the last slot.
+    std::vector<uint32_t> m_levelOffsets;
+    std::vector<Object*>  m_changed;
+    uint32_t              m_dirtyCount = {};
+    bool                  m_unsorted   = {};
+};
+}  // namespace aph
+
+#endif  // TRANSFORM_HIERARCHY_H_
@@ -0,0 +1,410 @@
+#include "scene_bench.h"
+#include "common/allocationTracker.h"
+
+#include <tinygltf/json.hpp>
+
+#include <sys/resource.h>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+using Json  = nlohmann::json;
+
+// Bumped whenever the layout of the results changes, results of different versions are not compared.
+constexpr int RESULTS_VERSION = 1;
+
+// Timings that moved less than this are noise, whatever the relative change.
+constexpr double MIN_REGRESSION_MS = 0.05;
+
+constexpr float FIXED_DELTA_TIME = 1.0f / 60.0f;
+
+constexpr const char* STAGE_NAMES[] = {
+    "updateTransforms", "updateCameras", "updateLights", "cullDraws", "beginFrame", "recordDrawSceneCommands",
+    "endFrame",
+};
+
+struct ModelPreset
+{
+    const char* name;
+    // Relative to the model directory.
+    const char* file;
+    glm::vec3   pathCenter;
+    glm::vec2   pathRadius;
+};
+
+// The helmets are orbited, Sponza is circled inside the atrium.
+const ModelPreset MODEL_PRESETS[] = {
+    {"DamagedHelmet", "DamagedHelmet.glb", {0.0f, 0.0f, 0.0f}, {3.0f, 3.0f}},
+    {"FlightHelmet", "FlightHelmet/glTF/FlightHelmet.gltf", {0.0f, 0.3f, 0.0f}, {1.2f, 1.2f}},
+    {"Sponza", "Sponza/glTF/Sponza.gltf", {0.0f, 2.0f, 0.0f}, {9.0f, 2.5f}},
+};
+
+double elapsedMs(Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+Json summarize(std::vector<double> samples)
+{
+    if(samples.empty())
+    {
+        return Json{{"samples", 0}};
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) { return samples[static_cast<size_t>(p * (samples.size() - 1) + 0.5)]; };
+    double total = 0.0;
+    for(double sample : samples)
+    {
+        total += sample;
+    }
+    return Json{
+        {"samples", samples.size()},
+        {"avgMs", total / samples.size()},
+        {"p50Ms", percentile(0.50)},
+        {"p95Ms", percentile(0.95)},
+        {"p99Ms", percentile(0.99)},
+        {"maxMs", samples.back()},
+    };
+}
+
+// Numeric leaves as "section.key.key", sample counts left out.
+void flatten(const Json& node, const std::string& path, std::map<std::string, double>& out)
+{
+    if(node.is_object())
+    {
+        for(auto it = node.begin(); it != node.end(); ++it)
+        {
+            if(it.key() != "samples") { flatten(it.value(), path.empty() ? it.key() : path + "." + it.key(), out); }
+        }
+    }
+    else if(node.is_number())
+    {
+        out[path] = node.get<double>();
+    }
+}
+
+// Lower is better for every metric. Returns the number of regressions.
+uint32_t compareResults(const Json& baseline, const Json& current, double tolerance)
+{
+    std::map<std::string, double> baselineMetrics;
+    std::map<std::string, double> currentMetrics;
+    for(const char* section : {"load", "frameTime", "cpuStages", "gpuPasses", "memory"})
+    {
+        if(baseline.count(section)) { flatten(baseline[section], section, baselineMetrics); }
+        if(current.count(section)) { flatten(current[section], section, currentMetrics); }
+    }
+
+    uint32_t regressions = 0;
+    std::printf("%-48s %14s %14s %9s\n", "metric", "baseline", "current", "delta");
+    for(const auto& [metric, current] : currentMetrics)
+    {
+        auto it = baselineMetrics.find(metric);
+        if(it == baselineMetrics.end())
+        {
+            std::printf("%-48s %14s %14.3f %9s\n", metric.c_str(), "-", current, "new");
+            continue;
+        }
+
+        double base       = it->second;
+        double delta      = base > 0.0 ? (current - base) / base : 0.0;
+        bool   isTime     = metric.ends_with("Ms");
+        bool   regression = current > base * (1.0 + tolerance) && (!isTime || current - base > MIN_REGRESSION_MS);
+        regressions += regression;
+        std::printf("%-48s %14.3f %14.3f %+8.1f%%%s\n", metric.c_str(), base, current, delta * 100.0,
+                    regression ? "  REGRESSION" : "");
+    }
+    for(const auto& [metric, base] : baselineMetrics)
+    {
+        if(!currentMetrics.contains(metric))
+        {
+            std::printf("%-48s %14.3f %14s %9s\n", metric.c_str(), base, "-", "gone");
+        }
+    }
+    return regressions;
+}
+
+uint64_t getPeakResidentBytes()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // Kilobytes on Linux.
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
+}  // namespace
+
+scene_bench::scene_bench(Options options) : aph::BaseApp("scene_bench"), m_options(std::move(options)) {}
+
+void scene_bench::init()
+{
+    m_window = aph::Window::Create(m_options.width, m_options.height, true);
+    setupRenderer();
+    setupScene();
+}
+
+void scene_bench::run()
+{
+    auto* pGpuProfiler = m_sceneRenderer->getGpuProfiler();
+
+    uint64_t resolvedFrames = pGpuProfiler->getResolvedFrameCount();
+    uint32_t frameCount     = m_options.warmupFrames + m_options.frames;
+    for(uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        bool measured = frame >= m_options.warmupFrames;
+        auto timeStage = [this, measured](Stage stage, auto&& func) {
+            auto start = Clock::now();
+            func();
+            if(measured) { m_stageMs[stage].push_back(elapsedMs(start, Clock::now())); }
+        };
+
+        auto frameStart = Clock::now();
+        updateCameraPath(frame);
+
+        // Same stages as the scene_manager frame graph, without the UI.
+        timeStage(STAGE_TRANSFORMS, [this]() { m_sceneRenderer->updateTransforms(); });
+        timeStage(STAGE_CAMERAS, [this]() { m_sceneRenderer->updateCameras(FIXED_DELTA_TIME); });
+        timeStage(STAGE_LIGHTS, [this]() { m_sceneRenderer->updateLights(); });
+        timeStage(STAGE_CULL, [this]() { m_sceneRenderer->cullDraws(); });
+        timeStage(STAGE_BEGIN_FRAME, [this]() { m_sceneRenderer->beginFrame(); });
+        timeStage(STAGE_RECORD, [this]() { m_sceneRenderer->recordDrawSceneCommands(); });
+        timeStage(STAGE_END_FRAME, [this]() { m_sceneRenderer->endFrame(); });
+
+        if(!measured)
+        {
+            resolvedFrames = pGpuProfiler->getResolvedFrameCount();
+            continue;
+        }
+
+        m_cpuFrameMs.push_back(elapsedMs(frameStart, Clock::now()));
+        m_visibleDraws.push_back(m_sceneRenderer->getDrawStats().visible);
+        m_occludedDraws.push_back(m_sceneRenderer->getDrawStats().occluded);
+        m_drawnTriangles.push_back(m_sceneRenderer->getDrawStats().triangles);
+        m_fullTriangles.push_back(m_sceneRenderer->getDrawStats().fullDetailTriangles);
+        // GPU results arrive a few frames late, the last ones of the run are never resolved.
+        if(pGpuProfiler->getResolvedFrameCount() != resolvedFrames)
+        {
+            resolvedFrames = pGpuProfiler->getResolvedFrameCount();
+            m_gpuFrameMs.push_back(pGpuProfiler->getLastFrameTimeMs());
+            for(const auto& zone : pGpuProfiler->getLastFrameZones())
+            {
+                m_gpuPassMs[zone.name].push_back(zone.durationMs);
+            }
+        }
+    }
+}
+
+void scene_bench::finish()
+{
+    m_sceneRenderer->idleDevice();
+
+    auto* pDevice = m_sceneRenderer->getDevice();
+
+    Json results{
+        {"version", RESULTS_VERSION},
+        {"model", m_options.model},
+        {"device", pDevice->getPhysicalDevice()->getProperties().deviceName},
+        {"width", m_options.width},
+        {"height", m_options.height},
+        {"frames", m_options.frames},
+        {"warmupFrames", m_options.warmupFrames},
+        {"load", {{"importMs", m_importMs}, {"uploadMs", m_uploadMs}}},
+        {"frameTime", {{"cpu", summarize(m_cpuFrameMs)}, {"gpu", summarize(m_gpuFrameMs)}}},
+        {"draws",
+         {{"tested", m_sceneRenderer->getDrawStats().tested},
+          {"visible", summarize(m_visibleDraws)},
+          {"occluded", summarize(m_occludedDraws)},
+          {"triangles", summarize(m_drawnTriangles)},
+          {"fullDetailTriangles", summarize(m_fullTriangles)}}},
+    };
+    for(uint32_t stage = 0; stage < STAGE_MAX; stage++)
+    {
+        results["cpuStages"][STAGE_NAMES[stage]] = summarize(m_stageMs[stage]);
+    }
+    for(const auto& [name, samples] : m_gpuPassMs)
+    {
+        results["gpuPasses"][name] = summarize(samples);
+    }
+
+    Json memory{
+        {"deviceBytes", pDevice->getAllocatedMemorySize()},
+        {"devicePeakBytes", pDevice->getPeakMemorySize()},
+        {"hostPeakResidentBytes", getPeakResidentBytes()},
+    };
+    if(aph::AllocationTracker::IsEnabled())
+    {
+        int64_t liveBytes = 0;
+        for(uint32_t tag = 0; tag < static_cast<uint32_t>(aph::AllocationTag::COUNT); tag++)
+        {
+            liveBytes += aph::AllocationTracker::GetStats(static_cast<aph::AllocationTag>(tag)).liveBytes;
+        }
+        memory["hostLiveBytes"] = liveBytes;
+    }
+    results["memory"] = memory;
+
+    // Parsed before the results are written, in case both name the same file.
+    if(!m_options.baseline.empty())
+    {
+        std::ifstream baselineFile(m_options.baseline, std::ios::binary);
+        Json          baseline = Json::parse(baselineFile, nullptr, false);
+        if(!baselineFile || baseline.is_discarded() || baseline.value("version", 0) != RESULTS_VERSION)
+        {
+            std::fprintf(stderr, "could not read baseline %s\n", m_options.baseline.c_str());
+            m_exitCode = 2;
+        }
+        else if(uint32_t regressions = compareResults(baseline, results, m_options.tolerance); regressions)
+        {
+            std::printf("%u metrics regressed by more than %.0f%%\n", regressions, m_options.tolerance * 100.0);
+            m_exitCode = 1;
+        }
+    }
+
+    std::ofstream file(m_options.output, std::ios::binary);
+    file << results.dump(2) << std::endl;
+    if(file)
+    {
+        std::printf("results written to %s\n", m_options.output.c_str());
+    }
+    else
+    {
+        std::fprintf(stderr, "could not write results to %s\n", m_options.output.c_str());
+        m_exitCode = 2;
+    }
+
+    m_sceneRenderer->cleanupResources();
+    m_sceneRenderer->cleanup();
+}
+
+void scene_bench::setupRenderer()
+{
+    // No validation layers or UI, both would dominate the timings.
+    aph::RenderConfig config{
+        .enableDebug = false,
+        .enableUI    = false,
+        .maxFrames   = 2,
+        .sampleCount = aph::SAMPLE_COUNT_4_BIT,
+        .headless    = true,
+    };
+
+    m_sceneRenderer = aph::IRenderer::Create<aph::VulkanSceneRenderer>(m_window, config);
+}
+
+void scene_bench::setupScene()
+{
+    m_scene = aph::Scene::Create(aph::SceneType::DEFAULT);
+    m_scene->setAmbient(glm::vec4(0.2f));
+
+    {
+        auto camera = m_scene->createCamera(m_window->getAspectRatio());
+        camera->setType(aph::CameraType::FIRST_PERSON);
+        camera->setFlipY(true);
+        camera->setPerspective(60.0f, m_window->getAspectRatio(), 0.01f, 96.0f);
+
+        m_cameraNode = m_scene->getRootNode()->createChildNode();
+        m_cameraNode->attachObject<aph::Camera>(camera);
+        m_scene->setMainCamera(camera);
+    }
+
+    {
+        auto dirLight = m_scene->createLight();
+        dirLight->setColor({1.0f, 1.0f, 1.0f});
+        dirLight->setDirection({0.2f, 1.0f, 0.3f});
+        dirLight->setType(aph::LightType::DIRECTIONAL);
+        m_scene->getRootNode()->createChildNode()->attachObject<aph::Light>(dirLight);
+    }
+
+    // A known model name, or a path to any other glTF file.
+    std::filesystem::path modelPath = m_options.model;
+    m_pathCenter                    = {0.0f, 0.0f, 0.0f};
+    m_pathRadius                    = {3.0f, 3.0f};
+    for(const auto& preset : MODEL_PRESETS)
+    {
+        if(m_options.model == preset.name)
+        {
+            modelPath    = aph::AssetManager::GetModelDir() / preset.file;
+            m_pathCenter = preset.pathCenter;
+            m_pathRadius = preset.pathRadius;
+        }
+    }
+
+    auto importStart = Clock::now();
+    m_scene->createMeshesFromFile(modelPath.string());
+    auto uploadStart = Clock::now();
+    m_sceneRenderer->setScene(m_scene);
+    m_sceneRenderer->setShadingModel(aph::ShadingModel::PBR);
+    m_sceneRenderer->loadResources();
+    auto uploadEnd = Clock::now();
+
+    m_importMs = elapsedMs(importStart, uploadStart);
+    m_uploadMs = elapsedMs(uploadStart, uploadEnd);
+}
+
+void scene_bench::updateCameraPath(uint32_t frame)
+{
+    // Depends on the frame index only, so every run renders the same images. Warmup frames start the lap early.
+    float angle = glm::two_pi<float>() * static_cast<float>(frame) / static_cast<float>(m_options.frames);
+
+    // Facing the center from the point of a circle, the ellipse keeps that yaw. The flipped-Y camera takes its
+    // height negated.
+    auto camera = m_cameraNode->getObject<aph::Camera>();
+    camera->setPosition({m_pathCenter.x - std::sin(angle) * m_pathRadius.x, -m_pathCenter.y,
+                         m_pathCenter.z + std::cos(angle) * m_pathRadius.y});
+    camera->setRotation({0.0f, glm::degrees(angle), 0.0f});
+}
+
+// usage: scene_bench [--model <name|path>] [--frames N] [--warmup N] [--size WxH] [--output results.json]
+//                    [--baseline baseline.json] [--tolerance 0.1]
+// Models: DamagedHelmet, FlightHelmet, Sponza. Exits with 1 if a metric regressed against the baseline.
+int main(int argc, char** argv)
+{
+    scene_bench::Options options;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view arg   = argv[i];
+        const char*      value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(!value)
+        {
+            std::fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 2;
+        }
+        ++i;
+
+        if(arg == "--model")
+            options.model = value;
+        else if(arg == "--frames")
+            options.frames = std::max(std::atoi(value), 1);
+        else if(arg == "--warmup")
+            // At least one frame in flight must have been resolved before measuring.
+            options.warmupFrames = std::max(std::atoi(value), 4);
+        else if(arg == "--size")
+            std::sscanf(value, "%ux%u", &options.width, &options.height);
+        else if(arg == "--output")
+            options.output = value;
+        else if(arg == "--baseline")
+            options.baseline = value;
+        else if(arg == "--tolerance")
+            options.tolerance = std::atof(value);
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i - 1]);
+            return 2;
+        }
+    }
+
+    if(options.output.empty())
+    {
+        options.output = "scene_bench_" + std::filesystem::path(options.model).stem().string() + ".json";
+    }
+    // Writing the results over the baseline would compare the next run against itself.
+    std::error_code error;
+    if(!options.baseline.empty() && std::filesystem::equivalent(options.output, options.baseline, error))
+    {
+        std::fprintf(stderr, "output %s is the baseline, pass another --output\n", options.output.c_str());
+        return 2;
+    }
+
+    scene_bench app(options);
+    app.init();
+    app.run();
+    app.finish();
+    return app.getExitCode();
+}
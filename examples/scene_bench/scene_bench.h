@@ -0,0 +1,80 @@
+#ifndef SCENE_BENCH_H_
+#define SCENE_BENCH_H_
+
+#include "aph_core.hpp"
+#include "aph_renderer.hpp"
+
+#include <map>
+
+// Renders a glTF model headless along a scripted camera path and reports load time, per-stage CPU time, GPU pass
+// time, memory usage and frame-time percentiles as JSON, optionally compared against a baseline result.
+class scene_bench : public aph::BaseApp
+{
+public:
+    struct Options
+    {
+        std::string model        = "DamagedHelmet";
+        uint32_t    frames       = 600;
+        uint32_t    warmupFrames = 60;
+        uint32_t    width        = 1280;
+        uint32_t    height       = 720;
+        // scene_bench_<model file name without extension>.json if empty, must not be the baseline.
+        std::string output       = {};
+        std::string baseline     = {};
+        // Relative slowdown (or memory growth) over the baseline that counts as a regression.
+        double      tolerance    = 0.1;
+    };
+
+    explicit scene_bench(Options options);
+
+    void init() override;
+    void run() override;
+    void finish() override;
+
+    // Non-zero if the baseline could not be read or a metric regressed against it.
+    int getExitCode() const { return m_exitCode; }
+
+private:
+    enum Stage
+    {
+        STAGE_TRANSFORMS,
+        STAGE_CAMERAS,
+        STAGE_LIGHTS,
+        STAGE_CULL,
+        STAGE_BEGIN_FRAME,
+        STAGE_RECORD,
+        STAGE_END_FRAME,
+        STAGE_MAX,
+    };
+
+    void setupRenderer();
+    void setupScene();
+    void updateCameraPath(uint32_t frame);
+
+private:
+    Options m_options  = {};
+    int     m_exitCode = {};
+
+    std::shared_ptr<aph::SceneNode>           m_cameraNode    = {};
+    std::unique_ptr<aph::VulkanSceneRenderer> m_sceneRenderer = {};
+    std::shared_ptr<aph::Scene>               m_scene         = {};
+    std::shared_ptr<aph::Window>              m_window        = {};
+
+    // Camera path: an ellipse around m_pathCenter with radii m_pathRadius, one lap over the measured frames.
+    glm::vec3 m_pathCenter = {};
+    glm::vec2 m_pathRadius = {};
+
+    double m_importMs = {};
+    double m_uploadMs = {};
+
+    std::array<std::vector<double>, STAGE_MAX> m_stageMs        = {};
+    std::vector<double>                        m_cpuFrameMs     = {};
+    std::vector<double>                        m_gpuFrameMs     = {};
+    std::map<std::string, std::vector<double>> m_gpuPassMs      = {};
+    std::vector<double>                        m_visibleDraws   = {};
+    std::vector<double>                        m_occludedDraws  = {};
+    std::vector<double>                        m_drawnTriangles = {};
+    std::vector<double>                        m_fullTriangles  = {};
+};
+
+#endif  // SCENE_BENCH_H_
@@ -6,33 +6,76 @@ scene_manager::scene_manager() : aph::BaseApp("scene_manager") {}
 
 void scene_manager::init()
 {
+    if(const char* pFrames = std::getenv("APH_HEADLESS"); pFrames)
+    {
+        m_headlessFrames = std::max(std::atoi(pFrames), 1);
+    }
+
     setupWindow();
     setupRenderer();
     setupScene();
+    setupFrameGraph();
 }
 
 void scene_manager::run()
 {
     while(!m_window->shouldClose())
     {
-        static float deltaTime = {};
-        auto         timer     = aph::Timer(deltaTime);
-        m_window->pollEvents();
+        auto timer = aph::Timer(m_deltaTime);
 
-        // update scene object
-        m_modelNode->rotate(1.0f * deltaTime, {0.0f, 1.0f, 0.0f});
+        // window events have to be handled on the main thread
+        m_window->pollEvents();
+        m_sceneRenderer->updateUIInput();
 
-        // update resource data
-        m_sceneRenderer->update(deltaTime);
-        m_uiRenderer->update(deltaTime);
+        m_frameGraph->execute();
 
-        // draw and submit
-        m_sceneRenderer->beginFrame();
-        m_sceneRenderer->recordDrawSceneCommands();
-        m_sceneRenderer->endFrame();
+        if(m_headlessFrames && m_sceneRenderer->getFrameStats().getFrameCount() >= m_headlessFrames)
+        {
+            m_window->close();
+        }
     }
 }
 
+void scene_manager::setupFrameGraph()
+{
+    m_frameGraph = std::make_unique<aph::TaskGraph>();
+
+    // begin frame waits for the frame in flight and opens the profiler and allocation frames, everything else
+    // succeeds it so no zone or allocation of this frame lands in the previous one.
+    auto* beginFrame = m_frameGraph->addTask("begin frame", [this]() { m_sceneRenderer->beginFrame(); });
+
+    // update scene object
+    auto* sceneUpdate = m_frameGraph->addTask("scene update", [this]() {
+        aph::AllocationScope allocationScope(aph::AllocationTag::SCENE);
+        m_modelNode->rotate(1.0f * m_deltaTime, {0.0f, 1.0f, 0.0f});
+    });
+
+    // update resource data
+    auto* transformUpload =
+        m_frameGraph->addTask("transform upload", [this]() { m_sceneRenderer->updateTransforms(); });
+    auto* cameraUpload =
+        m_frameGraph->addTask("camera upload", [this]() { m_sceneRenderer->updateCameras(m_deltaTime); });
+    auto* lightUpload = m_frameGraph->addTask("light upload", [this]() { m_sceneRenderer->updateLights(); });
+    auto* cull        = m_frameGraph->addTask("cull", [this]() { m_sceneRenderer->cullDraws(); });
+    auto* uiBuild     = m_frameGraph->addTask("ui build", [this]() {
+        aph::AllocationScope allocationScope(aph::AllocationTag::UI);
+        m_sceneRenderer->updateUI(m_deltaTime);
+        m_uiRenderer->update(m_deltaTime);
+    });
+
+    // draw and submit
+    auto* record   = m_frameGraph->addTask("record", [this]() { m_sceneRenderer->recordDrawSceneCommands(); });
+    auto* endFrame = m_frameGraph->addTask("end frame", [this]() { m_sceneRenderer->endFrame(); });
+
+    beginFrame->precede(sceneUpdate)->precede(cameraUpload)->precede(lightUpload);
+    sceneUpdate->precede(transformUpload);
+    cull->succeed(transformUpload)->succeed(cameraUpload);
+    uiBuild->succeed(cameraUpload)->succeed(lightUpload)->succeed(cull);
+
+    record->succeed(cull)->succeed(uiBuild);
+    record->precede(endFrame);
+}
+
 void scene_manager::finish()
 {
     m_sceneRenderer->idleDevice();
@@ -43,7 +86,7 @@ void scene_manager::finish()
 
 void scene_manager::setupWindow()
 {
-    m_window = aph::Window::Create(1440, 768);
+    m_window = aph::Window::Create(1440, 768, m_headlessFrames != 0);
 
     m_window->setCursorPosCallback([=](double xposIn, double yposIn) { this->mouseHandleDerive(xposIn, yposIn); });
 
@@ -107,13 +150,23 @@ void scene_manager::setupScene()
 
     // load from gltf file
     {
-        if(modelPath) { m_modelNode = m_scene->createMeshesFromFile(modelPath); }
-        else { m_modelNode = m_scene->createMeshesFromFile(aph::AssetManager::GetModelDir() / "DamagedHelmet.glb"); }
+        // Both files are read and parsed on the thread pool at once, the scene is only modified from this thread.
+        std::string defaultPath = (aph::AssetManager::GetModelDir() / "DamagedHelmet.glb").string();
+        auto        modelTask   = aph::Scene::LoadModelAsync(modelPath ? modelPath : defaultPath);
+        auto        model2Task  = aph::Scene::LoadModelAsync(defaultPath);
+        modelTask.start();
+        model2Task.start();
+
+        auto model = aph::syncWait(modelTask);
+        assert(model && "Could not open the glTF file.");
+        m_modelNode = m_scene->createMeshesFromModel(*model);
         m_modelNode->rotate(180.0f, {0.0f, 1.0f, 0.0f});
 
-        auto model2 = m_scene->createMeshesFromFile(aph::AssetManager::GetModelDir() / "DamagedHelmet.glb");
-        model2->rotate(180.0f, {0.0f, 1.0f, 0.0f});
-        model2->translate({3.0, 1.0, 1.0});
+        auto model2 = aph::syncWait(model2Task);
+        assert(model2 && "Could not open the glTF file.");
+        auto model2Node = m_scene->createMeshesFromModel(*model2);
+        model2Node->rotate(180.0f, {0.0f, 1.0f, 0.0f});
+        model2Node->translate({3.0, 1.0, 1.0});
     }
 
     {
@@ -131,6 +184,7 @@ void scene_manager::setupRenderer()
         .enableUI    = true,
         .maxFrames   = 2,
         .sampleCount = aph::SAMPLE_COUNT_4_BIT,
+        .headless    = m_headlessFrames != 0,
     };
 
     m_sceneRenderer = aph::IRenderer::Create<aph::VulkanSceneRenderer>(m_window, config);
@@ -21,6 +21,7 @@ private:
     void mouseHandleDerive(double xposIn, double yposIn);
 
     void setupScene();
+    void setupFrameGraph();
 
 private:
     std::shared_ptr<aph::SceneNode> m_modelNode            = {};
@@ -33,6 +34,12 @@ private:
 
     std::shared_ptr<aph::Scene>  m_scene  = {};
     std::shared_ptr<aph::Window> m_window = {};
+
+    std::unique_ptr<aph::TaskGraph> m_frameGraph = {};
+    float                           m_deltaTime  = {};
+
+    // Frames to render offscreen before quitting when APH_HEADLESS is set, 0 runs in a window.
+    uint32_t m_headlessFrames = {};
 };
 
 #endif  // SCENE_MANAGER_H_
@@ -0,0 +1,226 @@
+// Turns a binary AsyncLogger file back into text lines, or into JSON lines with --json.
+//   log_decoder [--json] <file>
+
+#include "common/logger.h"
+
+#include <fstream>
+#include <unordered_map>
+
+namespace
+{
+struct FormatInfo
+{
+    std::string                  fmt;
+    std::vector<aph::LogArgType> types;
+};
+
+const char* getLevelName(unsigned level)
+{
+    switch(level)
+    {
+    case LOG_ERR:
+        return "ERROR";
+    case LOG_WARN:
+        return "WARNING";
+    case LOG_INFO:
+        return "INFO";
+    case LOG_TIME:
+        return "TIME";
+    case LOG_DEBUG:
+        return "DEBUG";
+    default:
+        return "";
+    }
+}
+
+std::string formatTime(int64_t timeNs)
+{
+    time_t    seconds = timeNs / 1000000000;
+    struct tm t;
+    localtime_r(&seconds, &t);
+    char   buffer[48];
+    size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &t);
+    std::snprintf(buffer + length, sizeof(buffer) - length, ".%06lld",
+                  static_cast<long long>(timeNs % 1000000000 / 1000));
+    return buffer;
+}
+
+void appendJsonString(std::string& out, std::string_view value)
+{
+    out.push_back('"');
+    for(char c : value)
+    {
+        switch(c)
+        {
+        case '"':
+            out.append("\\\"");
+            break;
+        case '\\':
+            out.append("\\\\");
+            break;
+        case '\n':
+            out.append("\\n");
+            break;
+        case '\t':
+            out.append("\\t");
+            break;
+        default:
+            if(static_cast<unsigned char>(c) < 0x20)
+            {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                out.append(buffer);
+            }
+            else
+            {
+                out.push_back(c);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+// Typed arguments stay typed: numbers and booleans as JSON values, everything else as strings.
+void appendJsonArgs(std::string& out, const FormatInfo& format, const uint8_t* pArgs)
+{
+    out.append("[");
+    std::string value;
+    for(size_t i = 0; i < format.types.size(); ++i)
+    {
+        value.clear();
+        aph::LogArgType type = format.types[i];
+        pArgs                = aph::appendLogArg(type, pArgs, value);
+        if(i > 0)
+            out.push_back(',');
+        bool isString = type == aph::LogArgType::CHAR || type == aph::LogArgType::POINTER ||
+                        type == aph::LogArgType::STRING || value == "inf" || value == "-inf" || value == "nan";
+        if(isString)
+            appendJsonString(out, value);
+        else
+            out.append(value);
+    }
+    out.append("]");
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    bool        json = false;
+    const char* path = nullptr;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::string_view(argv[i]) == "--json")
+            json = true;
+        else
+            path = argv[i];
+    }
+    if(!path)
+    {
+        std::fprintf(stderr, "usage: %s [--json] <file>\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if(!file)
+    {
+        std::fprintf(stderr, "could not open %s\n", path);
+        return 1;
+    }
+
+    aph::binlog::LogFileHeader fileHeader;
+    if(!file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader)) ||
+       std::memcmp(fileHeader.magic, aph::binlog::MAGIC, sizeof(fileHeader.magic)) != 0)
+    {
+        std::fprintf(stderr, "%s is not a binary log\n", path);
+        return 1;
+    }
+    if(fileHeader.version != aph::binlog::VERSION)
+    {
+        std::fprintf(stderr, "unsupported binary log version %u\n", fileHeader.version);
+        return 1;
+    }
+
+    std::unordered_map<uint32_t, FormatInfo> formats;
+    std::vector<uint8_t>                     payload;
+    std::string                              line;
+    aph::binlog::LogRecordHeader             header;
+    while(file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        payload.resize(header.size);
+        if(!file.read(reinterpret_cast<char*>(payload.data()), header.size))
+        {
+            std::fprintf(stderr, "truncated record, stopping\n");
+            break;
+        }
+
+        if(header.type == aph::binlog::RecordType::FORMAT)
+        {
+            FormatInfo& format = formats[header.formatId];
+            uint32_t    length, count;
+            std::memcpy(&length, payload.data(), sizeof(length));
+            format.fmt.assign(reinterpret_cast<const char*>(payload.data() + sizeof(length)), length);
+            std::memcpy(&count, payload.data() + sizeof(length) + length, sizeof(count));
+            const auto* pTypes =
+                reinterpret_cast<const aph::LogArgType*>(payload.data() + 2 * sizeof(uint32_t) + length);
+            format.types.assign(pTypes, pTypes + count);
+            continue;
+        }
+
+        std::string time = formatTime(fileHeader.startTimeNs + static_cast<int64_t>(header.timestampNs));
+        line.clear();
+        if(header.type == aph::binlog::RecordType::DROPPED)
+        {
+            uint64_t count;
+            std::memcpy(&count, payload.data(), sizeof(count));
+            if(json)
+            {
+                line.append("{\"time\":\"").append(time).append("\",\"level\":\"WARNING\",\"dropped\":");
+                line.append(std::to_string(count)).append("}");
+            }
+            else
+            {
+                line.append("[ WARNING ][ ").append(time).append(" ][ AsyncLogger ]: ");
+                line.append(std::to_string(count)).append(" messages dropped");
+            }
+        }
+        else if(header.type == aph::binlog::RecordType::MESSAGE)
+        {
+            auto it = formats.find(header.formatId);
+            if(it == formats.end())
+            {
+                std::fprintf(stderr, "message refers to unknown format %u, skipped\n", header.formatId);
+                continue;
+            }
+            const FormatInfo& format = it->second;
+            aph::LogSignature signature{ format.types.data(), static_cast<uint32_t>(format.types.size()) };
+            std::string       message;
+            aph::formatLogMessage(format.fmt, signature, payload.data(), message);
+            if(json)
+            {
+                line.append("{\"time\":\"").append(time).append("\",\"level\":\"");
+                line.append(getLevelName(header.level)).append("\",\"thread\":");
+                line.append(std::to_string(header.threadIndex)).append(",\"format\":");
+                appendJsonString(line, format.fmt);
+                line.append(",\"args\":");
+                appendJsonArgs(line, format, payload.data());
+                line.append(",\"message\":");
+                appendJsonString(line, message);
+                line.append("}");
+            }
+            else
+            {
+                char level[16];
+                std::snprintf(level, sizeof(level), "[ %-7s ]", getLevelName(header.level));
+                line.append(level).append("[ ").append(time).append(" ][ T");
+                line.append(std::to_string(header.threadIndex)).append(" ]: ").append(message);
+            }
+        }
+        else
+        {
+            continue;
+        }
+        line.push_back('\n');
+        std::fwrite(line.data(), 1, line.size(), stdout);
+    }
+    return 0;
+}